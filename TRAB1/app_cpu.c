@@ -20,23 +20,7 @@
 #include <sys/types.h>
 #include <time.h>
 
-/**
- * @struct shm_data
- * @brief  Estrutura de dados compartilhada entre kernel e apps.
- * @details Armazena informações sobre todos os processos, seus estados e pedidos de I/O.
- */
-struct shm_data {
-  int  nprocs;              /**< Número total de processos ativos */
-  pid_t app_pid[6];         /**< PIDs dos processos de aplicação */
-  int  pc[6];               /**< Contadores de programa individuais */
-  int  want_io[6];          /**< Flags de solicitação de I/O */
-  int  io_type[6];          /**< Tipo de I/O solicitado */
-  int  done;                /**< Flag de término global */
-  int  d1_busy;             /**< Flag de ocupação do dispositivo 1 */
-  pid_t io_inflight_pid;    /**< PID do processo atualmente em I/O */
-  pid_t io_done_pid;        /**< PID do processo que concluiu I/O */
-  int   io_done_type;       /**< Tipo de I/O finalizado */
-};
+#include "ks_shm.h"
 
 /**
  * @brief  Manipulador de sinal SIGCONT.
@@ -100,7 +84,8 @@ int main(int argc, char **argv) {
   sigaction(SIGCONT,&sa,NULL);
 
   // Estado local
-  int i = 0, total_iters = 20, resumes = 0;
+  // pc inicial vem da SHM: zero numa tarefa nova, o ponto de parada numa migrada
+  int i = shm->pc[idx], total_iters = 20, resumes = 0;
 
   printf("[APP pid=%d idx=%d] INÍCIO (Apenas CPU)\n", (int)me, idx);
   fflush(stdout);
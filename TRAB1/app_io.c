@@ -0,0 +1,158 @@
+/**
+ * @file    app_io.c
+ * @brief   Aplicativo de teste do cache de blocos (I/O com localidade).
+ * @details Processo que executa 24 instruções de 1 segundo e pede um I/O a cada 2.
+ *          O bloco segue uma carga com conjunto quente: 70% dos pedidos vão a um dos
+ *          4 blocos quentes (0..3, os mesmos em todas as APPs) e 30% a um bloco frio
+ *          (16..63); 3 de cada 4 pedidos são READ. O bloco vai na SHM (io_blk) junto
+ *          com o pedido.
+ *
+ *          Sem cache todo pedido bloqueia a APP no dispositivo; com -K os acertos e
+ *          as escritas terminam sem bloquear, e a vazão (operações/s) no fim mostra
+ *          o ganho.
+ *
+ * @note    Usado para testar o cache de blocos e o flusher no trabalho INF1316 - SO.
+ * @author  Miguel Mendes (2111705)
+ * @author  Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "ks_shm.h"
+
+#define TOTAL_INSTR  24   /**< Instruções executadas */
+#define IO_EVERY     2    /**< Um pedido de I/O a cada IO_EVERY instruções */
+#define HOT_BLOCKS   4    /**< Blocos quentes (0..HOT_BLOCKS-1) */
+#define HOT_PCT      70   /**< Pedidos que vão ao conjunto quente (%) */
+#define COLD_FIRST   16   /**< Blocos frios: COLD_FIRST..COLD_LAST */
+#define COLD_LAST    63
+
+/**
+ * @brief  Manipulador de sinal SIGCONT.
+ * @param  sig Número do sinal recebido (ignorado).
+ * @note   Define a flag global `got_sigcont` para indicar retomada do processo.
+ */
+static volatile sig_atomic_t got_sigcont = 0;
+static void on_sigcont(int sig){ (void)sig; got_sigcont = 1; }
+
+/**
+ * @brief  Relógio monotônico em ms.
+ */
+static double mono_ms(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief  Processo principal de execução (I/O com conjunto quente).
+ * @param  argc Número de argumentos (espera 2: executável + shm_id).
+ * @param  argv Argumentos passados pela linha de comando.
+ * @return 0 em sucesso, >0 em falha.
+ * @details Anexa à SHM, identifica seu índice, registra handler de sinal e executa
+ *          as instruções, pedindo um I/O a cada IO_EVERY.
+ * @note   O pc é o número de instruções executadas; a sequência de blocos depende
+ *         só do idx, então duas execuções com e sem cache pedem os mesmos blocos.
+ */
+int main(int argc, char **argv) {
+  pid_t me = getpid();
+
+  if (argc < 2) {
+    fprintf(stderr, "[APP pid=%d] uso: ./app <shm_id>\n", (int)me);
+    return 2;
+  }
+
+  int shm_id = atoi(argv[1]);
+  struct shm_data *shm = (struct shm_data*)shmat(shm_id, NULL, 0);
+  if (shm == (void*)-1) {
+    perror("[APP] shmat");
+    return 1;
+  }
+
+  // Localiza o índice correspondente a este processo na SHM
+  int idx = -1;
+  for (int tries = 0; tries < 100 && idx < 0; tries++) {
+    for (int i = 0; i < shm->nprocs; i++) {
+      if (shm->app_pid[i] == me) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx < 0) {
+      struct timespec ts = {0, 50 * 1000 * 1000}; // 50ms
+      nanosleep(&ts, NULL);
+    }
+  }
+
+  if (idx < 0){
+    fprintf(stderr, "[APP pid=%d] FAIL: não achei meu idx na SHM\n",(int)me);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  // Registra handler de SIGCONT para retomada após preempção
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=on_sigcont;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags=SA_RESTART;
+  sigaction(SIGCONT,&sa,NULL);
+
+  // Estado local
+  // pc inicial vem da SHM: zero numa tarefa nova, o ponto de parada numa migrada
+  int i = shm->pc[idx], resumes = 0, ops = 0, reads = 0;
+  unsigned seed = 1000u + (unsigned)idx;
+  double start = mono_ms();
+
+  printf("[APP pid=%d idx=%d] INÍCIO (%d instruções, I/O a cada %d, %d%% em %d blocos quentes)\n",
+         (int)me, idx, TOTAL_INSTR, IO_EVERY, HOT_PCT, HOT_BLOCKS);
+  fflush(stdout);
+
+  while (i < TOTAL_INSTR) {
+    if (got_sigcont) {
+      got_sigcont = 0;
+      resumes++;
+      i = shm->pc[idx];
+      printf("[APP pid=%d idx=%d] RETORNO (SIGCONT) -> restaura pc=%d\n",(int)me,idx,i);
+      fflush(stdout);
+    }
+
+    shm->pc[idx] = i;
+
+    if (i % IO_EVERY == 1) {
+      int blk = (rand_r(&seed) % 100 < HOT_PCT)
+              ? rand_r(&seed) % HOT_BLOCKS
+              : COLD_FIRST + rand_r(&seed) % (COLD_LAST - COLD_FIRST + 1);
+      int type = (rand_r(&seed) % 4 == 3) ? 1 : 0;
+      shm->io_blk[idx] = blk;
+      shm->io_type[idx] = type;
+      shm->want_io[idx] = 1;
+      printf("[APP pid=%d idx=%d] SYSCALL I/O %s bloco=%d em pc=%d\n",
+             (int)me, idx, type==0?"READ":"WRITE", blk, i);
+      fflush(stdout);
+      ops++;
+      if (type == 0) reads++;
+    }
+
+    sleep(1);  // Simula tempo de execução (1 segundo por instrução)
+
+    i++;
+    shm->pc[idx] = i;
+  }
+
+  double secs = (mono_ms() - start) / 1e3;
+  printf("[APP pid=%d idx=%d] FIM (ops=%d READ=%d WRITE=%d, %.1fs, vazão=%.2f ops/s, resumes=%d)\n",
+         (int)me, idx, ops, reads, ops - reads, secs, secs > 0 ? ops / secs : 0.0, resumes);
+  fflush(stdout);
+
+  shmdt((void*)shm);
+
+  return 0;
+}
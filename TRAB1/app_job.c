@@ -0,0 +1,187 @@
+/**
+ * @file    app_job.c
+ * @brief   Aplicativo de teste do modelo de energia (jobs periódicos com DVFS).
+ * @details Processo que executa 6 jobs de 2 instruções de CPU, com uma pausa de
+ *          3 ticks (SYS_SLEEP) entre eles, como um serviço que atende pedidos. Cada
+ *          instrução é feita em 10 fatias; a duração de cada fatia é 100ms na frequência
+ *          máxima e cresce quando o kernel baixa a frequência (SHM cpu_freq), então
+ *          uma CPU mais lenta alonga o job.
+ *
+ *          Ao fim de cada job a APP soma o job e sua duração (ms) na SHM, para o
+ *          relatório de energia por job do kernel.
+ *
+ * @note    Usado para testar C-states, DVFS e governadores no trabalho INF1316 - SO.
+ * @author  Miguel Mendes (2111705)
+ * @author  Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "ks_shm.h"
+
+/**
+ * @brief  Números das chamadas de sistema (mesmos valores do kernel).
+ */
+enum { SYS_NONE=0, SYS_SLEEP=1 };
+
+#define TOTAL_JOBS  6   /**< Jobs executados */
+#define JOB_INSTR   2   /**< Instruções por job */
+#define THINK_TICKS 3   /**< Pausa entre jobs (ticks) */
+
+/**
+ * @brief  Manipulador de sinal SIGCONT.
+ * @param  sig Número do sinal recebido (ignorado).
+ * @note   Define a flag global `got_sigcont` para indicar retomada do processo.
+ */
+static volatile sig_atomic_t got_sigcont = 0;
+static void on_sigcont(int sig){ (void)sig; got_sigcont = 1; }
+
+/**
+ * @brief  Relógio monotônico em ms.
+ */
+static double mono_ms(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief  Faz uma chamada de sistema via SHM e aguarda o kernel atendê-la.
+ * @param  shm SHM anexada.
+ * @param  idx Índice desta APP.
+ * @param  num Número da chamada (SYS_*).
+ * @param  arg0 Primeiro argumento.
+ * @return Valor de retorno deixado pelo kernel em sys_ret.
+ */
+static int do_syscall(struct shm_data *shm, int idx, int num, int arg0){
+  shm->sys_num[idx] = num;
+  shm->sys_arg[idx][0] = arg0;
+  shm->want_sys[idx] = 1;
+  while (shm->want_sys[idx]) {
+    struct timespec ts = {0, 10 * 1000 * 1000}; // 10ms
+    nanosleep(&ts, NULL);
+  }
+  return shm->sys_ret[idx];
+}
+
+/**
+ * @brief  Executa uma instrução na frequência corrente da CPU.
+ * @details A frequência é relida a cada fatia: uma troca de nível no meio da
+ *          instrução vale para o restante dela.
+ */
+static void run_instruction(const struct shm_data *shm){
+  for (int k = 0; k < 10; k++) {
+    int f = shm->cpu_freq;
+    if (f <= 0 || f > 100) f = 100;
+    long ns = 100L * 1000 * 1000 * 100 / f;   // 100ms na máxima
+    struct timespec ts = { ns / 1000000000L, ns % 1000000000L };
+    nanosleep(&ts, NULL);
+  }
+}
+
+/**
+ * @brief  Processo principal de execução (jobs periódicos).
+ * @param  argc Número de argumentos (espera 2: executável + shm_id).
+ * @param  argv Argumentos passados pela linha de comando.
+ * @return 0 em sucesso, >0 em falha.
+ * @details Anexa à SHM, identifica seu índice, registra handler de sinal e executa
+ *          os jobs, dormindo THINK_TICKS ticks entre eles.
+ * @note   O pc é o número de instruções executadas.
+ */
+int main(int argc, char **argv) {
+  pid_t me = getpid();
+
+  if (argc < 2) {
+    fprintf(stderr, "[APP pid=%d] uso: ./app <shm_id>\n", (int)me);
+    return 2;
+  }
+
+  int shm_id = atoi(argv[1]);
+  struct shm_data *shm = (struct shm_data*)shmat(shm_id, NULL, 0);
+  if (shm == (void*)-1) {
+    perror("[APP] shmat");
+    return 1;
+  }
+
+  // Localiza o índice correspondente a este processo na SHM
+  int idx = -1;
+  for (int tries = 0; tries < 100 && idx < 0; tries++) {
+    for (int i = 0; i < shm->nprocs; i++) {
+      if (shm->app_pid[i] == me) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx < 0) {
+      struct timespec ts = {0, 50 * 1000 * 1000}; // 50ms
+      nanosleep(&ts, NULL);
+    }
+  }
+
+  if (idx < 0){
+    fprintf(stderr, "[APP pid=%d] FAIL: não achei meu idx na SHM\n",(int)me);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  // Registra handler de SIGCONT para retomada após preempção
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=on_sigcont;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags=SA_RESTART;
+  sigaction(SIGCONT,&sa,NULL);
+
+  // Estado local
+  // pc inicial vem da SHM: zero numa tarefa nova, o ponto de parada numa migrada
+  int i = shm->pc[idx], total = TOTAL_JOBS * JOB_INSTR, resumes = 0;
+  double job_start = mono_ms(), job_total = 0;
+  int jobs = 0;
+
+  printf("[APP pid=%d idx=%d] INÍCIO (%d jobs de %d instruções, pausa de %d ticks)\n",
+         (int)me, idx, TOTAL_JOBS, JOB_INSTR, THINK_TICKS);
+  fflush(stdout);
+
+  while (i < total) {
+    if (got_sigcont) {
+      got_sigcont = 0;
+      resumes++;
+      i = shm->pc[idx];
+      printf("[APP pid=%d idx=%d] RETORNO (SIGCONT) -> restaura pc=%d\n",(int)me,idx,i);
+      fflush(stdout);
+    }
+
+    shm->pc[idx] = i;
+    run_instruction(shm);
+    i++;
+    shm->pc[idx] = i;
+
+    if (i % JOB_INSTR == 0) {
+      double ms = mono_ms() - job_start;
+      jobs++;
+      job_total += ms;
+      shm->job_ms[idx] += (int)ms;
+      shm->jobs[idx]++;
+      printf("[APP pid=%d idx=%d] JOB %d concluído em %.0fms (frequência=%d%%)\n",
+             (int)me, idx, jobs, ms, shm->cpu_freq ? shm->cpu_freq : 100);
+      fflush(stdout);
+      if (i < total) do_syscall(shm, idx, SYS_SLEEP, THINK_TICKS);
+      job_start = mono_ms();
+    }
+  }
+
+  printf("[APP pid=%d idx=%d] FIM (jobs=%d, job médio=%.0fms, resumes=%d)\n",
+         (int)me, idx, jobs, jobs ? job_total / jobs : 0.0, resumes);
+  fflush(stdout);
+
+  shmdt((void*)shm);
+
+  return 0;
+}
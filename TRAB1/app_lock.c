@@ -0,0 +1,156 @@
+/**
+ * @file    app_lock.c
+ * @brief   Aplicativo de teste de contenção em mutex do kernel (SYS_MUTEX_LOCK/UNLOCK).
+ * @details Processo CPU-bound que entra numa seção crítica protegida pelo mutex 0
+ *          a cada 6 instruções (lock em `pc%6==1`, unlock em `pc%6==4`), segurando-o por
+ *          3 instruções. Várias instâncias disputam o mesmo mutex, o que permite medir
+ *          contenção, comboio e o efeito do quantum sobre quem está com o lock.
+ * 
+ * @note    Usado para testar os objetos de sincronização do kernel no trabalho INF1316 - SO.
+ * @author  Miguel Mendes (2111705)
+ * @author  Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "ks_shm.h"
+
+/**
+ * @brief  Números das chamadas de sistema (mesmos valores do kernel).
+ */
+enum { SYS_NONE=0, SYS_SLEEP=1, SYS_MUTEX_LOCK=2, SYS_MUTEX_UNLOCK=3 };
+
+/**
+ * @brief  Manipulador de sinal SIGCONT.
+ * @param  sig Número do sinal recebido (ignorado).
+ * @note   Define a flag global `got_sigcont` para indicar retomada do processo.
+ */
+static volatile sig_atomic_t got_sigcont = 0;
+static void on_sigcont(int sig){ (void)sig; got_sigcont = 1; }
+
+/**
+ * @brief  Faz uma chamada de sistema via SHM e aguarda o kernel atendê-la.
+ * @param  shm SHM anexada.
+ * @param  idx Índice desta APP.
+ * @param  num Número da chamada (SYS_*).
+ * @param  arg0 Primeiro argumento.
+ * @return Valor de retorno deixado pelo kernel em sys_ret.
+ */
+static int do_syscall(struct shm_data *shm, int idx, int num, int arg0){
+  shm->sys_num[idx] = num;
+  shm->sys_arg[idx][0] = arg0;
+  shm->want_sys[idx] = 1;
+  while (shm->want_sys[idx]) {
+    struct timespec ts = {0, 10 * 1000 * 1000}; // 10ms
+    nanosleep(&ts, NULL);
+  }
+  return shm->sys_ret[idx];
+}
+
+/**
+ * @brief  Processo principal de execução (CPU-bound com seção crítica).
+ * @param  argc Número de argumentos (espera 2: executável + shm_id).
+ * @param  argv Argumentos passados pela linha de comando.
+ * @return 0 em sucesso, >0 em falha.
+ * @details Anexa à SHM, identifica seu índice, registra handler de sinal e
+ *          executa laço de CPU com seções críticas periódicas no mutex 0.
+ * @note   Atualiza o contador `pc` na SHM a cada iteração e imprime logs de retomada.
+ */
+int main(int argc, char **argv) {
+  pid_t me = getpid();
+
+  if (argc < 2) {
+    fprintf(stderr, "[APP pid=%d] uso: ./app <shm_id>\n", (int)me);
+    return 2;
+  }
+
+  int shm_id = atoi(argv[1]);
+  struct shm_data *shm = (struct shm_data*)shmat(shm_id, NULL, 0);
+  if (shm == (void*)-1) { 
+    perror("[APP] shmat"); 
+    return 1; 
+  }
+
+  // Localiza o índice correspondente a este processo na SHM
+  int idx = -1;
+  for (int tries = 0; tries < 100 && idx < 0; tries++) {
+    for (int i = 0; i < shm->nprocs; i++) {
+      if (shm->app_pid[i] == me) { 
+        idx = i; 
+        break; 
+      }
+    }
+    if (idx < 0) {
+      struct timespec ts = {0, 50 * 1000 * 1000}; // 50ms
+      nanosleep(&ts, NULL);
+    }
+  }
+
+  if (idx < 0){
+    fprintf(stderr, "[APP pid=%d] FAIL: não achei meu idx na SHM\n",(int)me);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  // Registra handler de SIGCONT para retomada após preempção
+  struct sigaction sa; 
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=on_sigcont; 
+  sigemptyset(&sa.sa_mask); 
+  sa.sa_flags=SA_RESTART;
+  sigaction(SIGCONT,&sa,NULL);
+
+  // Estado local
+  // pc inicial vem da SHM: zero numa tarefa nova, o ponto de parada numa migrada
+  int i = shm->pc[idx], total_iters = 20, resumes = 0, locks = 0;
+  const int mutex_id = 0;
+
+  printf("[APP pid=%d idx=%d] INÍCIO (CPU + MUTEX %d)\n", (int)me, idx, mutex_id);
+  fflush(stdout);
+
+  // Loop principal de CPU com seção crítica em pc%6 = 1..3
+  while (i < total_iters) {
+    if (got_sigcont) {
+      got_sigcont = 0;
+      resumes++;
+      i = shm->pc[idx];
+      printf("[APP pid=%d idx=%d] RETORNO (SIGCONT) -> restaura pc=%d\n",(int)me,idx,i);
+      fflush(stdout);
+    }
+
+    shm->pc[idx] = i;
+
+    if (i % 6 == 1) {
+      printf("[APP pid=%d idx=%d] SYSCALL LOCK m=%d em pc=%d\n", (int)me, idx, mutex_id, i);
+      fflush(stdout);
+      do_syscall(shm, idx, SYS_MUTEX_LOCK, mutex_id);
+      printf("[APP pid=%d idx=%d] LOCK m=%d adquirido\n", (int)me, idx, mutex_id);
+      fflush(stdout);
+      locks++;
+    } else if (i % 6 == 4) {
+      printf("[APP pid=%d idx=%d] SYSCALL UNLOCK m=%d em pc=%d\n", (int)me, idx, mutex_id, i);
+      fflush(stdout);
+      do_syscall(shm, idx, SYS_MUTEX_UNLOCK, mutex_id);
+    }
+
+    sleep(1);   // Simula carga de CPU
+    i++;
+    shm->pc[idx] = i;
+  }
+
+  printf("[APP pid=%d idx=%d] FIM (iters=%d, locks=%d, resumes=%d)\n",
+         (int)me, idx, total_iters, locks, resumes);
+  fflush(stdout);
+
+  shmdt((void*)shm);
+
+  return 0;
+}
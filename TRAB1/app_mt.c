@@ -0,0 +1,215 @@
+/**
+ * @file    app_mt.c
+ * @brief   Aplicativo de teste de tarefa com várias threads (escalonamento em gangue).
+ * @details O número de threads vem do atributo `thr=<n>` da tarefa (SHM thr_n). Cada
+ *          thread executa 8 instruções de CPU e, a cada 2, espera as outras numa
+ *          barreira (futex privado do processo), como um serviço que divide o trabalho
+ *          em fases.
+ *
+ *          Uma instrução é feita em 10 fatias de 100ms; antes de cada fatia a thread
+ *          confere sua palavra `thr_run` na SHM e, se o kernel lhe tirou a CPU, para num
+ *          futex compartilhado até ser acordada. Enquanto espera na barreira, a thread
+ *          marca o estado KS_THR_FUTEX para o kernel dar a CPU a outra thread.
+ *
+ * @note    Usado para testar o escalonamento em gangue do kernel no trabalho INF1316 - SO.
+ * @author  Miguel Mendes (2111705)
+ * @author  Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <linux/futex.h>
+#include <time.h>
+
+#include "ks_shm.h"
+
+/**
+ * @brief  Estados de uma thread (mesmos valores do kernel, KS_THR_*).
+ */
+enum { THR_READY=0, THR_FUTEX=1, THR_DONE=2 };
+
+#define TOTAL_INSTR   8   /**< Instruções por thread */
+#define BARRIER_EVERY 2   /**< Instruções entre barreiras */
+
+/**
+ * @brief  Manipulador de sinal SIGCONT.
+ * @param  sig Número do sinal recebido (ignorado).
+ * @note   Define a flag global `got_sigcont` para indicar retomada do processo.
+ */
+static volatile sig_atomic_t got_sigcont = 0;
+static void on_sigcont(int sig){ (void)sig; got_sigcont = 1; }
+
+static struct shm_data *shm;
+static int idx = -1, nthr = 0;
+static int bar_count = 0, bar_gen = 0;   /**< Barreira das threads (futex privado) */
+static double bar_wait_ms[8];           /**< Espera acumulada de cada thread na barreira */
+
+/**
+ * @brief  Relógio monotônico em ms.
+ */
+static double mono_ms(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static long futex(int *addr, int op, int val, const struct timespec *to){
+  return syscall(SYS_futex, addr, op, val, to, NULL, 0);
+}
+
+/**
+ * @brief  Para a thread `t` enquanto o kernel não lhe der uma CPU.
+ * @note   A palavra fica na SHM e é acordada pelo kernel (outro processo), então o
+ *         futex não pode ser privado. O prazo cobre um acordar perdido.
+ */
+static void wait_cpu(int t){
+  while (__atomic_load_n(&shm->thr_run[idx][t], __ATOMIC_ACQUIRE) == 0) {
+    struct timespec to = {0, 100 * 1000 * 1000}; // 100ms
+    futex(&shm->thr_run[idx][t], FUTEX_WAIT, 0, &to);
+  }
+}
+
+/**
+ * @brief  Barreira entre as threads da tarefa.
+ * @details A última a chegar abre a barreira; as demais dormem no futex da geração
+ *          com o estado THR_FUTEX, sem ocupar CPU simulada.
+ */
+static void barrier(int t){
+  double t0 = mono_ms();
+  int gen = __atomic_load_n(&bar_gen, __ATOMIC_ACQUIRE);
+  if (__atomic_add_fetch(&bar_count, 1, __ATOMIC_ACQ_REL) == nthr) {
+    __atomic_store_n(&bar_count, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&bar_gen, 1, __ATOMIC_ACQ_REL);
+    futex(&bar_gen, FUTEX_WAKE_PRIVATE, INT_MAX, NULL);
+    return;
+  }
+  shm->thr_state[idx][t] = THR_FUTEX;
+  while (__atomic_load_n(&bar_gen, __ATOMIC_ACQUIRE) == gen)
+    futex(&bar_gen, FUTEX_WAIT_PRIVATE, gen, NULL);
+  shm->thr_state[idx][t] = THR_READY;
+  bar_wait_ms[t] += mono_ms() - t0;
+}
+
+/**
+ * @brief  Corpo de uma thread: TOTAL_INSTR instruções com barreira a cada BARRIER_EVERY.
+ * @param  arg Índice da thread na tarefa.
+ */
+static void *worker(void *arg){
+  int t = (int)(intptr_t)arg;
+  int i = shm->thr_pc[idx][t];
+  while (i < TOTAL_INSTR) {
+    for (int k = 0; k < 10; k++) {
+      wait_cpu(t);
+      struct timespec ts = {0, 100 * 1000 * 1000}; // 100ms: fatia da instrução
+      nanosleep(&ts, NULL);
+    }
+    i++;
+    shm->thr_pc[idx][t] = i;
+    __atomic_add_fetch(&shm->pc[idx], 1, __ATOMIC_RELAXED);
+    if (i % BARRIER_EVERY == 0 && i < TOTAL_INSTR) barrier(t);
+  }
+  shm->thr_state[idx][t] = THR_DONE;
+  return NULL;
+}
+
+/**
+ * @brief  Processo principal de execução (grupo de threads).
+ * @param  argc Número de argumentos (espera 2: executável + shm_id).
+ * @param  argv Argumentos passados pela linha de comando.
+ * @return 0 em sucesso, >0 em falha.
+ * @details Anexa à SHM, identifica seu índice, cria as threads e aguarda o fim delas.
+ * @note   O pc da tarefa é a soma das instruções das threads.
+ */
+int main(int argc, char **argv) {
+  pid_t me = getpid();
+
+  if (argc < 2) {
+    fprintf(stderr, "[APP pid=%d] uso: ./app <shm_id>\n", (int)me);
+    return 2;
+  }
+
+  int shm_id = atoi(argv[1]);
+  shm = (struct shm_data*)shmat(shm_id, NULL, 0);
+  if (shm == (void*)-1) {
+    perror("[APP] shmat");
+    return 1;
+  }
+
+  // Localiza o índice correspondente a este processo na SHM
+  for (int tries = 0; tries < 100 && idx < 0; tries++) {
+    for (int i = 0; i < shm->nprocs; i++) {
+      if (shm->app_pid[i] == me) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx < 0) {
+      struct timespec ts = {0, 50 * 1000 * 1000}; // 50ms
+      nanosleep(&ts, NULL);
+    }
+  }
+
+  if (idx < 0){
+    fprintf(stderr, "[APP pid=%d] FAIL: não achei meu idx na SHM\n",(int)me);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  nthr = shm->thr_n[idx];
+  if (nthr < 2 || nthr > 8) {
+    fprintf(stderr, "[APP pid=%d idx=%d] FAIL: sem threads (use o atributo thr=<n>)\n", (int)me, idx);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  // Registra handler de SIGCONT para retomada após preempção
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=on_sigcont;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags=SA_RESTART;
+  sigaction(SIGCONT,&sa,NULL);
+
+  printf("[APP pid=%d idx=%d] INÍCIO (%d threads, %d instruções cada, barreira a cada %d)\n",
+         (int)me, idx, nthr, TOTAL_INSTR, BARRIER_EVERY);
+  fflush(stdout);
+
+  double t_start = mono_ms();
+  pthread_t th[8];
+  for (int t = 0; t < nthr; t++) pthread_create(&th[t], NULL, worker, (void*)(intptr_t)t);
+
+  // A thread principal só acompanha as retomadas do grupo
+  int resumes = 0, left = nthr;
+  while (left > 0) {
+    struct timespec ts = {0, 100 * 1000 * 1000}; // 100ms
+    nanosleep(&ts, NULL);
+    if (got_sigcont) {
+      got_sigcont = 0;
+      resumes++;
+      printf("[APP pid=%d idx=%d] RETORNO (SIGCONT) -> pc=%d\n", (int)me, idx, shm->pc[idx]);
+      fflush(stdout);
+    }
+    left = 0;
+    for (int t = 0; t < nthr; t++) left += (shm->thr_state[idx][t] != THR_DONE);
+  }
+  for (int t = 0; t < nthr; t++) pthread_join(th[t], NULL);
+
+  printf("[APP pid=%d idx=%d] FIM (threads=%d, pc=%d, tempo=%.1fs, resumes=%d) | espera na barreira (s):",
+         (int)me, idx, nthr, shm->pc[idx], (mono_ms() - t_start) / 1e3, resumes);
+  for (int t = 0; t < nthr; t++) printf(" t%d=%.1f", t, bar_wait_ms[t] / 1e3);
+  printf("\n");
+  fflush(stdout);
+
+  shmdt((void*)shm);
+
+  return 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file    app_pipe.c
+ * @brief   Aplicativo de teste dos canais de mensagens sem cópia (SYS_CHAN_*).
+ * @details Um estágio de pipeline. O papel vem do atributo `ch=<entrada>:<saída>` da
+ *          tarefa (SHM chan_in/chan_out):
+ *          - produtor (`ch=:N`): gera 8 itens, 1 instrução de CPU cada, escrevendo
+ *            cada um direto num buffer do canal N (alloc + send);
+ *          - filtro (`ch=M:N`): recebe de M, processa por 1 instrução, escreve o
+ *            resultado num buffer de N e devolve o de M;
+ *          - consumidor (`ch=M:`): recebe de M, consome por 1 instrução e mede a
+ *            latência fim a fim (criação no produtor -> consumo).
+ *          O fim do fluxo é uma mensagem vazia, repassada por todos os estágios.
+ *
+ * @note    Usado para testar os canais do kernel no trabalho INF1316 - SO.
+ * @author  Miguel Mendes (2111705)
+ * @author  Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/types.h>
+#include <time.h>
+
+#define KS_CHAN_LAYOUT_ONLY
+#include "ks_chan.h"
+#include "ks_shm.h"
+
+/**
+ * @brief  Números das chamadas de sistema (mesmos valores do kernel).
+ */
+enum { SYS_NONE=0, SYS_CHAN_ALLOC=10, SYS_CHAN_SEND=11, SYS_CHAN_RECV=12, SYS_CHAN_FREE=13 };
+
+/**
+ * @brief  Manipulador de sinal SIGCONT.
+ * @param  sig Número do sinal recebido (ignorado).
+ * @note   Define a flag global `got_sigcont` para indicar retomada do processo.
+ */
+static volatile sig_atomic_t got_sigcont = 0;
+static void on_sigcont(int sig){ (void)sig; got_sigcont = 1; }
+
+/**
+ * @brief  Relógio monotônico em ms (mesma base em todos os processos).
+ */
+static double mono_ms(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief  Faz uma chamada de sistema via SHM e aguarda o kernel atendê-la.
+ * @param  shm SHM anexada.
+ * @param  idx Índice desta APP.
+ * @param  num Número da chamada (SYS_*).
+ * @param  a0,a1,a2 Argumentos.
+ * @return Valor de retorno deixado pelo kernel em sys_ret.
+ * @note   Se a chamada bloqueou, sys_ret vale -2 até o kernel entregar o buffer.
+ */
+static int do_syscall(struct shm_data *shm, int idx, int num, int a0, int a1, int a2){
+  shm->sys_num[idx] = num;
+  shm->sys_arg[idx][0] = a0;
+  shm->sys_arg[idx][1] = a1;
+  shm->sys_arg[idx][2] = a2;
+  shm->want_sys[idx] = 1;
+  while (shm->want_sys[idx] || shm->sys_ret[idx] == -2) {
+    struct timespec ts = {0, 10 * 1000 * 1000}; // 10ms
+    nanosleep(&ts, NULL);
+  }
+  return shm->sys_ret[idx];
+}
+
+/**
+ * @brief  Reserva um buffer em `ch`, formata a mensagem direto nele e envia o descritor.
+ * @param  fmt Formato (NULL = mensagem vazia, fim do fluxo).
+ * @return 0 em sucesso, -1 em falha.
+ */
+static int put(struct shm_data *shm, void *seg, int idx, int ch, double born, const char *fmt, ...){
+  int b = do_syscall(shm, idx, SYS_CHAN_ALLOC, ch, 0, 0);
+  if (b < 0) return -1;
+  ks_chan_buf *m = ks_chan_slot(seg, ch, b);
+  int len = 0;
+  if (fmt) {
+    va_list ap;
+    va_start(ap, fmt);
+    len = vsnprintf(m->data, sizeof(m->data), fmt, ap);
+    va_end(ap);
+  }
+  if (len >= (int)sizeof(m->data)) len = (int)sizeof(m->data) - 1;
+  m->len = len;
+  m->sent_ns = (long long)(born * 1e6);
+  return do_syscall(shm, idx, SYS_CHAN_SEND, ch, b, len);
+}
+
+/**
+ * @brief  Processo principal de execução (estágio do pipeline).
+ * @param  argc Número de argumentos (espera 2: executável + shm_id).
+ * @param  argv Argumentos passados pela linha de comando.
+ * @return 0 em sucesso, >0 em falha.
+ * @details Anexa à SHM e ao segmento dos canais, identifica seu índice e papel e
+ *          executa o laço do estágio.
+ * @note   O pc é o número de itens tratados pelo estágio.
+ */
+int main(int argc, char **argv) {
+  pid_t me = getpid();
+
+  if (argc < 2) {
+    fprintf(stderr, "[APP pid=%d] uso: ./app <shm_id>\n", (int)me);
+    return 2;
+  }
+
+  int shm_id = atoi(argv[1]);
+  struct shm_data *shm = (struct shm_data*)shmat(shm_id, NULL, 0);
+  if (shm == (void*)-1) {
+    perror("[APP] shmat");
+    return 1;
+  }
+  void *seg = shmat(shm->chan_shmid, NULL, 0);
+  if (seg == (void*)-1) {
+    perror("[APP] shmat canais");
+    shmdt((void*)shm);
+    return 1;
+  }
+
+  // Localiza o índice correspondente a este processo na SHM
+  int idx = -1;
+  for (int tries = 0; tries < 100 && idx < 0; tries++) {
+    for (int i = 0; i < shm->nprocs; i++) {
+      if (shm->app_pid[i] == me) {
+        idx = i;
+        break;
+      }
+    }
+    if (idx < 0) {
+      struct timespec ts = {0, 50 * 1000 * 1000}; // 50ms
+      nanosleep(&ts, NULL);
+    }
+  }
+
+  if (idx < 0){
+    fprintf(stderr, "[APP pid=%d] FAIL: não achei meu idx na SHM\n",(int)me);
+    shmdt(seg);
+    shmdt((void*)shm);
+    return 2;
+  }
+
+  int in = shm->chan_in[idx], out = shm->chan_out[idx];
+  if (in < 0 && out < 0) {
+    fprintf(stderr, "[APP pid=%d idx=%d] FAIL: sem canais (use o atributo ch=<entrada>:<saída>)\n",
+            (int)me, idx);
+    shmdt(seg);
+    shmdt((void*)shm);
+    return 2;
+  }
+  const char *role = (in < 0) ? "PRODUTOR" : (out < 0) ? "CONSUMIDOR" : "FILTRO";
+
+  // Registra handler de SIGCONT para retomada após preempção
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=on_sigcont;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags=SA_RESTART;
+  sigaction(SIGCONT,&sa,NULL);
+
+  // Estado local
+  int i = shm->pc[idx], total_items = 8, resumes = 0;
+  double lat_total = 0, lat_max = 0, t_first = 0, t_last = 0;
+
+  printf("[APP pid=%d idx=%d] INÍCIO (%s entrada=%d saída=%d)\n", (int)me, idx, role, in, out);
+  fflush(stdout);
+
+  for (;;) {
+    if (got_sigcont) {
+      got_sigcont = 0;
+      resumes++;
+      i = shm->pc[idx];
+      printf("[APP pid=%d idx=%d] RETORNO (SIGCONT) -> restaura pc=%d\n",(int)me,idx,i);
+      fflush(stdout);
+    }
+    shm->pc[idx] = i;
+
+    if (in < 0) {
+      // Produtor: a mensagem nasce direto no buffer do canal
+      if (i >= total_items) { put(shm, seg, idx, out, 0, NULL); break; }
+      sleep(1);   // Simula a produção do item
+      put(shm, seg, idx, out, mono_ms(), "item %d de idx %d", i, idx);
+      printf("[APP pid=%d idx=%d] ENVIO ch=%d item %d\n", (int)me, idx, out, i);
+      fflush(stdout);
+    } else {
+      int b = do_syscall(shm, idx, SYS_CHAN_RECV, in, 0, 0);
+      if (b < 0) break;
+      ks_chan_buf *m = ks_chan_slot(seg, in, b);
+      if (m->len == 0) {
+        // Fim do fluxo: repassa adiante
+        do_syscall(shm, idx, SYS_CHAN_FREE, in, b, 0);
+        if (out >= 0) put(shm, seg, idx, out, 0, NULL);
+        break;
+      }
+      double born = m->sent_ns / 1e6;
+      printf("[APP pid=%d idx=%d] RECEBE ch=%d seq=%d \"%s\"\n", (int)me, idx, in, m->seq, m->data);
+      fflush(stdout);
+      sleep(1);   // Simula o processamento do item
+      if (out >= 0) {
+        // Lê a entrada no lugar e escreve o resultado direto no buffer de saída
+        put(shm, seg, idx, out, born, "%.200s > idx %d", m->data, idx);
+        do_syscall(shm, idx, SYS_CHAN_FREE, in, b, 0);
+      } else {
+        do_syscall(shm, idx, SYS_CHAN_FREE, in, b, 0);
+        double now = mono_ms(), lat = now - born;
+        lat_total += lat;
+        if (lat > lat_max) lat_max = lat;
+        if (i == 0) t_first = now;
+        t_last = now;
+      }
+    }
+    i++;
+    shm->pc[idx] = i;
+  }
+
+  if (in >= 0 && out < 0 && i > 0) {
+    printf("[APP pid=%d idx=%d] FIM (%s itens=%d, latência média=%.0fms máx=%.0fms, vazão=%.2f itens/s, resumes=%d)\n",
+           (int)me, idx, role, i, lat_total / i, lat_max,
+           (i > 1 && t_last > t_first) ? (i - 1) * 1e3 / (t_last - t_first) : 0.0, resumes);
+  } else {
+    printf("[APP pid=%d idx=%d] FIM (%s itens=%d, resumes=%d)\n", (int)me, idx, role, i, resumes);
+  }
+  fflush(stdout);
+
+  shmdt(seg);
+  shmdt((void*)shm);
+
+  return 0;
+}
@@ -24,23 +24,7 @@
 #include <sys/types.h>
 #include <time.h>
 
-/**
- * @struct shm_data
- * @brief  Estrutura compartilhada entre Kernel, InterController e APPs.
- * @details Contém o estado de todos os processos, controle de I/O e variáveis de sincronização.
- */
-struct shm_data {
-  int  nprocs;              /**< Número total de processos ativos */
-  pid_t app_pid[6];         /**< PIDs das aplicações */
-  int  pc[6];               /**< Contadores de programa (PC) */
-  int  want_io[6];          /**< Flags de solicitação de I/O */
-  int  io_type[6];          /**< Tipo de I/O solicitado (0=READ, 1=WRITE) */
-  int  done;                /**< Flag global de término */
-  int  d1_busy;             /**< Indica se o dispositivo de I/O está ocupado */
-  pid_t io_inflight_pid;    /**< PID do processo atualmente em atendimento de I/O */
-  pid_t io_done_pid;        /**< PID do processo cujo I/O terminou */
-  int   io_done_type;       /**< Tipo do I/O concluído (0=READ, 1=WRITE) */
-};
+#include "ks_shm.h"
 
 /**
  * @brief  Flag global que indica retomada do processo via SIGCONT.
@@ -108,7 +92,7 @@ int main(int argc, char **argv) {
   sigaction(SIGCONT,&sa,NULL);
 
   // Estado local do processo
-  int i = 0;                     /**< contador de instruções (PC) */
+  int i = shm->pc[idx];          /**< contador de instruções (PC); != 0 em tarefa migrada */
   int total_iters = 20;          /**< número total de iterações */
   int io_feitos = 0;             /**< total de pedidos de I/O feitos */
   int resumes = 0;               /**< contador de retomadas via SIGCONT */
@@ -0,0 +1,616 @@
+/**
+ * @file    bench_ks.c
+ * @brief   Microbenchmarks do núcleo libkernelsim, executados no próprio processo.
+ * @details Usa callbacks vazios (sem fork/kill) para medir o custo puro de cada caminho
+ *          do escalonador e reporta ns/op:
+ *          - tick (rodízio): IRQ0 com quantum de 1 tick (preempção + escolha + despacho);
+ *          - tick (sem troca): IRQ0 que apenas decrementa o quantum;
+ *          - enqueue: bloqueio da corrente por I/O + despacho da próxima pronta;
+ *          - complete: IRQ1 com desbloqueio prioritário (preempção + despacho);
+ *          - pick (esparso): busca da próxima pronta com uma única tarefa pronta;
+ *          - timer arm+cancel: armar e cancelar um temporizador na roda hierárquica;
+ *          - timer expire: temporizadores que se rearmam com prazos aleatórios
+ *            (custo por tick e por expiração);
+ *          - tick (N dormindo): IRQ0 com todas as tarefas em SLEEPING;
+ *          - mutex livre: lock+unlock sem contenção;
+ *          - mutex handoff: unlock com entrega ao próximo da fila + lock que bloqueia
+ *            + despacho do novo dono (comboio entre todas as tarefas);
+ *          - canal: alloc + send + recv + free de um descritor (sem bloqueio e sem cópia:
+ *            o custo independe do tamanho da mensagem);
+ *          - quantum: simulação de carga mista (metade CPU-bound, metade interativa com
+ *            rajadas de 1-2 ticks e sono de 3) comparando quantum fixo e automático em
+ *            despachos por tick e espera média das interativas após acordar;
+ *          - edf: todas as tarefas de tempo real (WCET 1-2, períodos aleatórios, U <= 0,5)
+ *            com o heap de prazos cheio; custo por tick, jobs e prazos perdidos;
+ *          - irq1: 1/4 CPU-bound (quantum 4), 3/4 com rajadas de 1 tick e I/O que
+ *            termina em rajadas a cada 8 ticks; compara tratar cada IRQ1 na hora com a
+ *            política de desbloqueio (-U) e a coalescência (-I) em trocas por I/O e
+ *            latência do I/O (término -> despacho);
+ *          - gangue: 2 CPUs, uma tarefa de 4 threads (uma delas em futex a cada 4 ticks)
+ *            e 3 de uma thread; custo por tick e CPU por thread do grupo em relação a
+ *            uma tarefa comum, com justiça por grupo e por thread;
+ *          - cgroup: 6 tarefas CPU-bound, 2 num grupo de peso 300 e 4 num grupo "barulhento"
+ *            de peso 100, sem cota e com cota de 3 ticks a cada 10; custo por tick,
+ *            fração da CPU de cada grupo e limitações;
+ *          - bcache: cache de 64 blocos com metade dos pedidos em 48 blocos quentes e
+ *            metade numa varredura, 1/4 de WRITEs e um lote do flusher a cada 32; compara
+ *            LRU e ARC em ns/op e taxa de acerto dos READs;
+ *          - pic: 16 linhas com prioridades invertidas; a cada rodada 4 linhas aleatórias
+ *            são levantadas e reconhecidas em ordem de prioridade (custo por interrupção);
+ *          - cluster: dois nós no mesmo processo (sockets em /tmp): resumo de carga
+ *            publicado e absorvido, e ciclo MIGRATE -> ACK -> COMMIT completo (sem criar
+ *            processo); o benchmark falha se algum ciclo não se completar.
+ *
+ *          Uso:
+ *          ./bench_ks [ntarefas] [iterações]
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ks_sched.h"
+#include "ks_timer.h"
+#include "ks_sync.h"
+#include "ks_chan.h"
+#include "ks_cluster.h"
+#include "ks_irq.h"
+#include "ks_gang.h"
+#include "ks_cgroup.h"
+#include "ks_bcache.h"
+#include "ks_pic.h"
+
+/**
+ * @brief  Contador de callbacks, impede que o compilador elimine as chamadas.
+ */
+static volatile long sink = 0;
+
+static void nop_dispatch(void *ctx, int idx)          { (void)ctx; sink += idx; }
+static void nop_preempt(void *ctx, int idx)           { (void)ctx; sink += idx; }
+static void nop_block(void *ctx, int idx, int t)      { (void)ctx; sink += idx + t; }
+static void nop_unblock(void *ctx, int idx, int t)    { (void)ctx; sink += idx + t; }
+
+static const ks_ops bench_ops = {
+  .dispatch = nop_dispatch,
+  .preempt  = nop_preempt,
+  .block    = nop_block,
+  .unblock  = nop_unblock,
+};
+
+/**
+ * @brief  Retorna o tempo atual em nanossegundos.
+ */
+static double now_ns(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief  Imprime uma linha de resultado.
+ */
+static void report(const char *name, double ns, long ops) {
+  double per = ns / (double)ops;
+  printf("[BENCH] %-20s %10.2f ns/op  %8.2f Mops/s  (%ld ops)\n", name, per, 1e3 / per, ops);
+}
+
+/**
+ * @brief  Cria um escalonador com todas as tarefas prontas.
+ */
+static void setup_all_ready(ks_sched *s, int n, int slice) {
+  if (ks_init(s, n, slice, &bench_ops, NULL) != 0) { perror("ks_init"); exit(1); }
+  for (int i = 0; i < n; i++) ks_set_state(s, i, ST_READY);
+  ks_start(s);
+}
+
+static void bench_tick_rotate(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1);
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) ks_tick(&s);
+  report("tick (rodízio)", now_ns() - t, iters);
+  ks_destroy(&s);
+}
+
+static void bench_tick_idle_slice(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1 << 30);
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) ks_tick(&s);
+  report("tick (sem troca)", now_ns() - t, iters);
+  ks_destroy(&s);
+}
+
+/**
+ * @brief  Alterna rodadas de bloqueio (enqueue) e conclusão (complete) sobre n tarefas.
+ * @details Cada rodada bloqueia todas as tarefas, uma após a outra, e depois conclui o
+ *          I/O de todas; cada fase é cronometrada em lote para diluir o custo do relógio.
+ */
+static void bench_enqueue_complete(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 4);
+  double t_enq = 0, t_cpl = 0;
+  long ops = 0;
+  while (ops < iters) {
+    double t = now_ns();
+    for (int k = 0; k < n; k++) {
+      ks_block_running(&s, k & 1);
+      ks_dispatch(&s, ks_pick_next(&s));
+    }
+    t_enq += now_ns() - t;
+
+    t = now_ns();
+    for (int k = 0; k < n; k++) ks_io_complete(&s, k, k & 1);
+    t_cpl += now_ns() - t;
+    ops += n;
+  }
+  report("enqueue (bloqueio)", t_enq, ops);
+  report("complete (IRQ1)", t_cpl, ops);
+  ks_destroy(&s);
+}
+
+static void bench_pick_sparse(int n, long iters) {
+  ks_sched s;
+  if (ks_init(&s, n, 1, &bench_ops, NULL) != 0) { perror("ks_init"); exit(1); }
+  ks_set_state(&s, n - 1, ST_READY);
+  long acc = 0;
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) acc += ks_pick_after(&s, (int)(k % n));
+  report("pick (esparso)", now_ns() - t, iters);
+  sink += acc;
+  ks_destroy(&s);
+}
+
+static void bench_timer_arm_cancel(int n, long iters) {
+  ks_wheel *w = (ks_wheel*)malloc(sizeof(*w));
+  ks_timer *t = (ks_timer*)calloc((size_t)n, sizeof(ks_timer));
+  if (!w || !t) { perror("malloc"); exit(1); }
+  ks_wheel_init(w, 0);
+  for (int i = 0; i < n; i++) ks_timer_init(&t[i], NULL, NULL);
+  unsigned r = 12345;
+  double tt = now_ns();
+  for (long k = 0; k < iters; k++) {
+    ks_timer *x = &t[k % n];
+    r = r * 1103515245u + 12345u;
+    ks_timer_arm(w, x, (uint64_t)(1 + (r >> 8) % 100000));
+    if (k & 1) ks_timer_cancel(w, x);
+  }
+  report("timer arm(+cancel)", now_ns() - tt, iters);
+  free(t); free(w);
+}
+
+/** Gerador simples compartilhado pelo benchmark de expiração. */
+static unsigned bench_rng = 777;
+
+/**
+ * @brief  Callback que rearma o temporizador com um prazo aleatório em [1, 4096].
+ */
+static void rearm_fn(void *arg, ks_timer *t) {
+  ks_wheel *w = (ks_wheel*)arg;
+  bench_rng = bench_rng * 1103515245u + 12345u;
+  ks_timer_arm(w, t, w->now + (bench_rng >> 8) % 4096);
+}
+
+static void bench_timer_expire(int n, long iters) {
+  ks_wheel *w = (ks_wheel*)malloc(sizeof(*w));
+  ks_timer *t = (ks_timer*)calloc((size_t)n, sizeof(ks_timer));
+  if (!w || !t) { perror("malloc"); exit(1); }
+  ks_wheel_init(w, 0);
+  for (int i = 0; i < n; i++) { ks_timer_init(&t[i], rearm_fn, w); rearm_fn(w, &t[i]); }
+
+  long ticks = iters / (n / 2048 + 1);
+  if (ticks < 4096) ticks = 4096;
+  long fired = 0;
+  double tt = now_ns();
+  for (long k = 0; k < ticks; k++) fired += ks_wheel_advance(w, w->now);
+  double el = now_ns() - tt;
+  report("timer tick", el, ticks);
+  report("timer expire", el, fired > 0 ? fired : 1);
+  free(t); free(w);
+}
+
+static void bench_tick_sleeping(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1);
+  // Todas dormem mais do que a duração do benchmark
+  for (int i = 0; i < n; i++) {
+    ks_dispatch(&s, i);
+    ks_sleep_running(&s, iters + 1 + (i % 1000));
+  }
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) ks_tick(&s);
+  report("tick (N dormindo)", now_ns() - t, iters);
+  ks_destroy(&s);
+}
+
+static void bench_mutex_free(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1);
+  ks_sync sy;
+  if (ks_sync_init(&sy, &s, 1) != 0) { perror("ks_sync_init"); exit(1); }
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) { ks_mutex_lock(&sy, 0); ks_mutex_unlock(&sy, 0); }
+  report("mutex livre", now_ns() - t, iters);
+  ks_sync_destroy(&sy);
+  ks_destroy(&s);
+}
+
+static void bench_mutex_handoff(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1);
+  ks_sync sy;
+  if (ks_sync_init(&sy, &s, 1) != 0) { perror("ks_sync_init"); exit(1); }
+  // A tarefa 0 fica com o mutex; todas as outras entram na fila
+  ks_mutex_lock(&sy, 0);
+  int owner = s.current;
+  for (int k = 0; k < n; k++) {
+    if (k == owner) continue;
+    ks_preempt(&s);
+    ks_dispatch(&s, k);
+    ks_mutex_lock(&sy, 0);
+  }
+  ks_dispatch(&s, owner);
+
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) {
+    ks_mutex_unlock(&sy, 0);          // entrega ao primeiro da fila
+    ks_mutex_lock(&sy, 0);            // o antigo dono volta para o fim da fila
+    int nxt = ks_pick_next(&s);
+    ks_dispatch(&s, nxt);
+    ks_sync_on_dispatch(&sy, nxt);
+  }
+  report("mutex handoff", now_ns() - t, iters);
+  ks_sync_destroy(&sy);
+  ks_destroy(&s);
+}
+
+static void bench_chan(int n, long iters) {
+  ks_sched s; setup_all_ready(&s, n, 1);
+  ks_chan c;
+  if (ks_chan_init(&c, &s, 1, NULL) != 0) { perror("ks_chan_init"); exit(1); }
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) {
+    int b = ks_chan_alloc(&c, 0);
+    ks_chan_send(&c, 0, b, KS_CHAN_PAYLOAD);
+    ks_chan_free(&c, 0, ks_chan_recv(&c, 0));
+  }
+  report("canal", now_ns() - t, iters);
+  if (c.ch[0].st.received != iters) fprintf(stderr, "bench_chan: %ld de %ld mensagens\n", c.ch[0].st.received, iters);
+  ks_chan_destroy(&c);
+  ks_destroy(&s);
+}
+
+/**
+ * @brief  Roda a carga mista por `ticks` ticks com o quantum dado.
+ * @param  mode KS_Q_FIXED, KS_Q_GLOBAL ou KS_Q_TASK.
+ */
+static void sim_quantum_mix(const char *name, int n, long ticks, int mode, int q0) {
+  ks_sched s; setup_all_ready(&s, n, q0);
+  ks_qtune qt;
+  if (mode != KS_Q_FIXED) {
+    if (ks_qtune_init(&qt, n, mode, 1, 8, 90, q0) != 0) { perror("ks_qtune_init"); exit(1); }
+    ks_set_qtune(&s, &qt);
+  }
+  int *left = (int*)calloc((size_t)n, sizeof(int));
+  if (!left) { perror("calloc"); exit(1); }
+  // Tarefas ímpares são interativas: rajada de 1 ou 2 ticks e depois dormem 3
+  for (int i = 1; i < n; i += 2) left[i] = 1 + (i & 2) / 2;
+
+  double t = now_ns();
+  for (long k = 0; k < ticks; k++) {
+    ks_clock_tick(&s);
+    int c = s.current;
+    if (c >= 0 && (c & 1) && --left[c] <= 0) {
+      left[c] = 1 + (int)((k + c) & 1);
+      ks_sleep_running(&s, 3);
+    }
+    ks_slice_tick(&s);
+  }
+  double el = now_ns() - t;
+  printf("[BENCH] %-20s %10.2f ns/tick  despachos/tick=%.3f  espera interativas=%.2f ticks\n",
+         name, el / (double)ticks, (double)s.stats.dispatches / (double)ticks,
+         s.stats.wake_n ? (double)s.stats.wake_lat / s.stats.wake_n : 0.0);
+  free(left);
+  if (mode != KS_Q_FIXED) ks_qtune_destroy(&qt);
+  ks_destroy(&s);
+}
+
+static void bench_quantum(int n, long iters) {
+  int m = (n < 8) ? n : 8;   // fila curta o bastante para a latência ser legível
+  sim_quantum_mix("quantum fixo=1", m, iters, KS_Q_FIXED, 1);
+  sim_quantum_mix("quantum fixo=8", m, iters, KS_Q_FIXED, 8);
+  sim_quantum_mix("quantum auto global", m, iters, KS_Q_GLOBAL, 1);
+  sim_quantum_mix("quantum auto tarefa", m, iters, KS_Q_TASK, 1);
+}
+
+/**
+ * @brief  Roda a carga de I/O em rajadas por `ticks` ticks.
+ * @param  window  Janela de coalescência (0 = cada IRQ1 na hora).
+ * @param  min_run Tempo mínimo da corrente antes da preempção por desbloqueio.
+ * @param  cap     Impulsos seguidos por tarefa (0 = sem limite).
+ */
+static void sim_io_burst(const char *name, int n, long ticks, int window, int min_run, int cap) {
+  ks_sched s; ks_irqq q;
+  setup_all_ready(&s, n, 4);
+  ks_set_unblock_policy(&s, min_run, cap);
+  int *idx = (int*)calloc((size_t)n, sizeof(int));
+  int *typ = (int*)calloc((size_t)n, sizeof(int));
+  long *done_at = (long*)calloc((size_t)n, sizeof(long));
+  long lat = 0, nlat = 0;
+  if (!idx || !typ || !done_at || ks_irq_init(&q, n, window, 0) != 0) { perror("init"); exit(1); }
+
+  double t = now_ns();
+  for (long k = 0; k < ticks; k++) {
+    ks_clock_tick(&s);
+    // Interativas (índice não múltiplo de 4) pedem I/O depois de 1 tick de CPU
+    int c = s.current;
+    if (c >= 0 && (c & 3) && s.now - s.run_start[c] >= 1) {
+      // Latência do I/O anterior: término -> início do tick que acabou de rodar
+      if (done_at[c] > 0) { lat += s.now - 1 - done_at[c]; nlat++; }
+      ks_block_running(&s, 0);
+    }
+    if (ks_irq_due(&q, s.now)) ks_io_complete_batch(&s, idx, typ, ks_irq_drain(&q, idx, typ, n, s.now));
+    ks_slice_tick(&s);
+    // Dispositivo: os términos chegam juntos, entre dois ticks
+    if (s.now % 8 != 0) continue;
+    for (int i = 0; i < n; i++) {
+      if (s.state[i] != ST_WAITING) continue;
+      done_at[i] = s.now;
+      if (window == 0 || ks_irq_push(&q, i, 0, s.now) != 0) ks_io_complete(&s, i, 0);
+    }
+  }
+  double el = now_ns() - t;
+  double io = s.stats.unblocks ? (double)s.stats.unblocks : 1.0;
+  printf("[BENCH] %-20s %10.2f ns/tick  preempções/I-O=%.2f despachos/I-O=%.2f latência I/O=%.2f ticks\n",
+         name, el / (double)ticks, (double)s.stats.io_preempts / io, (double)s.stats.dispatches / io, nlat ? (double)lat / nlat : 0.0);
+  free(idx); free(typ); free(done_at);
+  ks_irq_destroy(&q);
+  ks_destroy(&s);
+}
+
+static void bench_irq(int n, long iters) {
+  int m = (n < 8) ? n : 8;
+  sim_io_burst("irq1 na hora", m, iters, 0, 0, 0);
+  sim_io_burst("irq1 -U 1", m, iters, 0, 1, 0);
+  sim_io_burst("irq1 -U 2:1", m, iters, 0, 2, 1);
+  sim_io_burst("irq1 -I 1", m, iters, 1, 0, 0);
+  sim_io_burst("irq1 -I 1 -U 1", m, iters, 1, 1, 0);
+}
+
+/**
+ * @brief  Simula uma tarefa de 4 threads e 3 comuns em 2 CPUs por `ticks` ticks.
+ * @details Reporta a razão entre a CPU de cada thread do grupo e a de uma tarefa comum
+ *          (1,00 = justiça por thread; 0,50 = cada grupo recebe o mesmo tempo).
+ */
+static void sim_gang(const char *name, int fair, long ticks) {
+  ks_sched s; setup_all_ready(&s, 4, 1);
+  ks_gang g;
+  if (ks_gang_init(&g, 4, 2, fair) != 0) { perror("ks_gang_init"); exit(1); }
+  ks_gang_set_threads(&g, 0, 4);
+  ks_set_gang(&s, &g);
+  int state[KS_GANG_MAXTHR] = {0}, run[KS_GANG_MAXTHR];
+  double t = now_ns();
+  for (long k = 0; k < ticks; k++) {
+    ks_gang_account(&g, s.current, state);
+    ks_tick(&s);
+    for (int th = 0; th < 4; th++) state[th] = ((s.now + th) % 4 == 0) ? KS_THR_FUTEX : KS_THR_READY;
+    if (s.current == 0) ks_gang_pick(&g, 0, s.now, state, run);
+  }
+  double el = now_ns() - t;
+  double single = (double)(g.grp[1].cpu_ticks + g.grp[2].cpu_ticks + g.grp[3].cpu_ticks) / 3.0;
+  printf("[BENCH] %-20s %10.2f ns/tick  CPU por thread do grupo / tarefa comum=%.2f utilização=%.0f%% futex puladas=%ld\n",
+         name, el / (double)ticks, single > 0 ? g.grp[0].cpu_ticks / 4.0 / single : 0.0,
+         100.0 * g.st.busy / (double)(g.st.ticks * g.ncpu), g.st.futex_skips);
+  ks_gang_destroy(&g);
+  ks_destroy(&s);
+}
+
+static void bench_gang(long iters) {
+  long ticks = (iters < 1000000L) ? iters : 1000000L;
+  sim_gang("gangue justiça grupo", KS_GANG_FAIR_GROUP, ticks);
+  sim_gang("gangue justiça thread", KS_GANG_FAIR_THREAD, ticks);
+}
+
+/**
+ * @brief  Simula 6 tarefas CPU-bound em dois grupos (pesos 300 e 100, cota opcional no segundo).
+ */
+static void sim_cgroup(const char *name, int quota, long ticks) {
+  ks_sched s;
+  if (ks_init(&s, 6, 1, &bench_ops, NULL) != 0) { perror("ks_init"); exit(1); }
+  ks_cgroups c;
+  if (ks_cg_init(&c, 6) != 0) { perror("ks_cg_init"); exit(1); }
+  int crit = ks_cg_add(&c, "crit", 0, 300, 0, 0);
+  int noisy = ks_cg_add(&c, "noisy", 0, 100, quota, 10);
+  for (int i = 0; i < 6; i++) ks_cg_assign(&c, i, i < 2 ? crit : noisy);
+  ks_set_cgroups(&s, &c);
+  for (int i = 0; i < 6; i++) ks_set_state(&s, i, ST_READY);
+  ks_start(&s);
+  double t = now_ns();
+  for (long k = 0; k < ticks; k++) ks_tick(&s);
+  double el = now_ns() - t;
+  printf("[BENCH] %-20s %10.2f ns/tick  CPU crit=%.0f%% noisy=%.0f%% ociosa retida=%.0f%% limitações=%ld\n",
+         name, el / (double)ticks, 100.0 * c.g[crit].usage / ticks, 100.0 * c.g[noisy].usage / ticks,
+         100.0 * s.stats.cg_idle / ticks, c.g[noisy].nr_throttled);
+  ks_cg_destroy(&c);
+  ks_destroy(&s);
+}
+
+static void bench_cgroup(long iters) {
+  long ticks = (iters < 1000000L) ? iters : 1000000L;
+  sim_cgroup("cgroup sem cota", 0, ticks);
+  sim_cgroup("cgroup cota 3/10", 3, ticks);
+}
+
+/**
+ * @brief  Passa a mesma carga (conjunto quente + varredura, 1/4 de WRITEs) por um cache
+ *         de 64 blocos com a política dada; um lote do flusher a cada 32 operações.
+ */
+static void sim_bcache(const char *name, int policy, long ops) {
+  const int cap = 64, hot = 48;
+  ks_bcache b;
+  if (ks_bc_init(&b, cap, policy) != 0) { perror("ks_bc_init"); exit(1); }
+  unsigned rng = 4242;
+  int scan = 0;
+  double t = now_ns();
+  for (long k = 0; k < ops; k++) {
+    rng = rng * 1103515245u + 12345u;
+    unsigned r = rng >> 8;
+    // Metade dos pedidos no conjunto quente, metade numa varredura de blocos novos
+    int blk = (r % 2) ? (int)((r >> 1) % hot) : 1000 + (scan++ % 100000);
+    if ((r >> 10) % 4 == 0) ks_bc_write(&b, blk, k);
+    else if (!ks_bc_read(&b, blk)) ks_bc_fill(&b, blk, k);
+    if (k % 32 == 31) { ks_bc_flush_begin(&b, k, cap); ks_bc_flush_end(&b, k); }
+  }
+  double el = now_ns() - t;
+  const ks_bcache_stats *st = &b.st;
+  printf("[BENCH] %-20s %10.2f ns/op  READ acertos=%.1f%% WRITEs sem vaga=%ld fantasmas=%ld blocos/lote=%.1f\n",
+         name, el / (double)ops, st->reads ? 100.0 * st->read_hits / st->reads : 0.0, st->write_through,
+         st->ghost_hits, st->flushes ? (double)st->flushed / st->flushes : 0.0);
+  ks_bc_destroy(&b);
+}
+
+static void bench_bcache(long iters) {
+  long ops = (iters < 1000000L) ? iters : 1000000L;
+  sim_bcache("bcache LRU", KS_BC_LRU, ops);
+  sim_bcache("bcache ARC", KS_BC_ARC, ops);
+}
+
+static void bench_pic(long iters) {
+  ks_pic p;
+  ks_pic_init(&p, KS_PIC_LINES);
+  for (int l = 0; l < KS_PIC_LINES; l++) ks_pic_set_prio(&p, l, KS_PIC_LINES - 1 - l);
+  unsigned rng = 99;
+  long irqs = 0, misorder = 0;
+  double t = now_ns();
+  for (long k = 0; k < iters / 4; k++) {
+    for (int r = 0; r < 4; r++) {
+      rng = rng * 1103515245u + 12345u;
+      ks_pic_raise(&p, (int)((rng >> 8) % KS_PIC_LINES), k);
+    }
+    int line, last = -1;
+    while ((line = ks_pic_ack(&p, k)) >= 0) {
+      if (last >= 0 && p.line[line].prio < p.line[last].prio) misorder++;
+      last = line;
+      irqs++;
+    }
+  }
+  report("pic raise+ack", now_ns() - t, irqs);
+  if (misorder) fprintf(stderr, "bench_pic: %ld entregas fora de ordem\n", misorder);
+}
+
+/**
+ * @brief  Simula n tarefas periódicas EDF que usam exatamente o WCET a cada job.
+ */
+static void bench_edf(int n, long iters) {
+  ks_sched s; ks_rt rt;
+  if (ks_init(&s, n, 1, &bench_ops, NULL) != 0 || ks_rt_init(&rt, n, 100) != 0) {
+    perror("init"); exit(1);
+  }
+  ks_set_rt(&s, &rt);
+  for (int i = 0; i < n; i++) {
+    bench_rng = bench_rng * 1103515245u + 12345u;
+    long period = 4L * n + (long)((bench_rng >> 8) % (4U * (unsigned)n));
+    if (ks_rt_admit(&rt, i, period, 1 + (i & 1), 0) != 0) {
+      fprintf(stderr, "bench_edf: admissão recusada\n"); exit(1);
+    }
+    ks_set_state(&s, i, ST_READY);
+  }
+  long *ran = (long*)calloc((size_t)n, sizeof(long));
+  if (!ran) { perror("calloc"); exit(1); }
+  ks_start(&s);
+
+  double t = now_ns();
+  for (long k = 0; k < iters; k++) {
+    ks_clock_tick(&s);
+    int c = s.current;
+    if (c >= 0 && ++ran[c] >= rt.t[c].wcet) { ran[c] = 0; ks_job_done(&s, NULL); }
+    ks_slice_tick(&s);
+  }
+  double el = now_ns() - t;
+  printf("[BENCH] %-20s %10.2f ns/tick  jobs=%ld perdas=%ld preempções=%ld\n", "edf (heap cheio)",
+         el / (double)iters, rt.st.completions, rt.st.misses, rt.st.preemptions);
+  free(ran);
+  ks_rt_destroy(&rt);
+  ks_destroy(&s);
+}
+
+/**
+ * @brief  Custo do transporte do cluster entre dois nós no mesmo processo.
+ */
+static void bench_cluster(long iters) {
+  char prefix[48];
+  snprintf(prefix, sizeof(prefix), "/tmp/ks_bench%d", (int)getpid());
+  ks_cluster a, b;
+  if (ks_cluster_open(&a, prefix, 0, 2, KS_CL_PUSH, 1) != 0 ||
+      ks_cluster_open(&b, prefix, 1, 2, KS_CL_PUSH, 1) != 0) {
+    perror("ks_cluster_open"); exit(1);
+  }
+  long ops = iters / 100;
+  if (ops > 100000) ops = 100000;
+  if (ops < 1000) ops = 1000;
+  ks_load load = { 0, 4, 1, 0, 2 };
+  ks_task_image img = { "./app_cpu", 0, 0, 0, 0, 0, { 0, 0, 0 }, 0 };
+  ks_clmsg m;
+
+  double t = now_ns();
+  for (long k = 0; k < ops; k++) {
+    load.tick = k;
+    ks_cluster_publish(&a, &load);
+    ks_cluster_poll(&b, &m);
+  }
+  report("cluster carga", now_ns() - t, ops);
+
+  // Uma operação = MIGRATE -> ACK -> COMMIT, com a reserva fechada no destino
+  long acks = 0;
+  t = now_ns();
+  for (long k = 0; k < ops; k++) {
+    img.pc = (int)(k & 15);
+    if (ks_cluster_migrate(&a, 1, 0, &img) != 0) break;
+    if (!ks_cluster_poll(&b, &m) || m.type != KS_MSG_MIGRATE) break;
+    ks_cluster_reply(&b, &m, 1);
+    if (!ks_cluster_poll(&a, &m) || m.type != KS_MSG_ACK) break;
+    if (!ks_cluster_poll(&b, &m) || m.type != KS_MSG_COMMIT) break;
+    acks++;
+  }
+  double el = now_ns() - t;
+  ks_cluster_close(&a);
+  ks_cluster_close(&b);
+  if (acks != ops) {
+    fprintf(stderr, "bench_cluster: só %ld de %ld migrações concluídas\n", acks, ops);
+    exit(1);
+  }
+  report("cluster migrate+ack", el, acks);
+}
+
+/**
+ * @brief  Executa todos os microbenchmarks.
+ * @param  argc Número de argumentos.
+ * @param  argv [ntarefas] [iterações].
+ * @return 0 em sucesso.
+ */
+int main(int argc, char **argv) {
+  int  n     = (argc > 1) ? atoi(argv[1]) : 1024;
+  long iters = (argc > 2) ? atol(argv[2]) : 10000000L;
+  if (n < 1) n = 1;
+  if (iters < n) iters = n;
+
+  printf("[BENCH] libkernelsim | tarefas=%d | iterações=%ld\n", n, iters);
+  bench_tick_rotate(n, iters);
+  bench_tick_idle_slice(n, iters);
+  bench_enqueue_complete(n, iters);
+  bench_pick_sparse(n, iters);
+  bench_timer_arm_cancel(n, iters);
+  bench_timer_expire(n, iters);
+  bench_tick_sleeping(n, iters);
+  bench_mutex_free(n, iters);
+  bench_mutex_handoff(n, iters);
+  bench_chan(n, iters);
+  bench_quantum(n, iters);
+  bench_edf(n, iters);
+  bench_irq(n, iters);
+  bench_gang(iters);
+  bench_cgroup(iters);
+  bench_bcache(iters);
+  bench_pic(iters);
+  bench_cluster(iters);
+  return 0;
+}
@@ -1,12 +1,16 @@
 /**
  * @file    inter_controller.c
  * @brief   Simula o controlador de interrupções do sistema.
- * @details Este processo envia sinais de interrupção (IRQ0 e IRQ1) ao kernel:
- *          - IRQ0 (SIGUSR1) a cada 1s, simulando o clock (time-slice).
- *          - IRQ1 (SIGUSR2) após 3s de um pedido de I/O recebido via FIFO.
+ * @details Este processo gera as interrupções do kernel pelo PIC na SHM (ks_pic.c):
+ *          - IRQ0 (linha KS_IRQ_TIMER) a cada 1s, simulando o clock (time-slice).
+ *          - IRQ1 (linha KS_IRQ_DISK) após 3s de um pedido de I/O recebido via FIFO.
+ *          Cada interrupção levanta a linha (bit pendente) e toca a campainha (SIGUSR1);
+ *          uma linha ainda pendente não gera outra campainha.
  * 
  *          Ele lê pedidos de I/O do FIFO, atende um por vez (simulando 3s de serviço),
- *          e sinaliza o kernel quando o I/O termina.
+ *          e sinaliza o kernel quando o I/O termina. Enquanto o IRQ1 anterior não foi
+ *          reconhecido (ex.: linha mascarada), o término seguinte espera no dispositivo,
+ *          pois io_done_pid/io_done_type guardam um só.
  *
  *          Uso:
  *          ./inter_controller <shm_id> <kernel_pid>
@@ -29,6 +33,8 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 
+#include "ks_shm.h"
+
 /**
  * @brief  Retorna o tempo atual em milissegundos desde o boot do sistema.
  * @return Tempo em milissegundos.
@@ -39,6 +45,15 @@ static unsigned long tempo_ms(void){
   return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
 }
 
+/**
+ * @brief  Retorna o tempo atual em nanossegundos (mesma base do kernel).
+ */
+static long long tempo_ns(void){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 /**
  * @brief  Retorna o tempo relativo em milissegundos desde um tempo inicial t0.
  * @param  t0 Tempo inicial em milissegundos.
@@ -49,22 +64,14 @@ static unsigned long rel_ms(unsigned long t0){
 }
 
 /**
- * @struct shm_data
- * @brief  Estrutura compartilhada com o kernel e as aplicações.
- * @details Reflete o estado global da simulação de I/O e processos.
+ * @brief  Levanta a linha no PIC e toca a campainha do kernel, se ela ficou pendente agora.
  */
-struct shm_data {
-  int  nprocs;               /**< Número total de processos */
-  pid_t app_pid[6];          /**< PIDs das aplicações */
-  int  pc[6];                /**< Contadores de programa */
-  int  want_io[6];           /**< Flags de pedido de I/O */
-  int  io_type[6];           /**< Tipo de I/O (0=READ, 1=WRITE) */
-  int  done;                 /**< Flag de término global */
-  int  d1_busy;              /**< Indica se o dispositivo está ocupado */
-  pid_t io_inflight_pid;     /**< PID do processo em atendimento de I/O */
-  pid_t io_done_pid;         /**< PID do processo cujo I/O terminou */
-  int   io_done_type;        /**< Tipo do I/O concluído */
-};
+static void irq_raise(struct shm_data *shm, pid_t kpid, int line){
+  if (ks_pic_raise(&shm->pic, line, tempo_ns()) == 1) {
+    shm->pic.rings++;
+    kill(kpid, SIGUSR1);
+  }
+}
 
 /**
  * @brief  Processo principal do InterController.
@@ -72,14 +79,15 @@ struct shm_data {
  * @param  argv Argumentos passados pela linha de comando (<shm_id> <kernel_pid>).
  * @return 0 em sucesso, >0 em falha.
  * @details 
- *  - Lê pedidos de I/O do FIFO ("/tmp/so_trab1_iofifo").
- *  - Envia SIGUSR1 (IRQ0) ao kernel a cada 1s.
- *  - Envia SIGUSR2 (IRQ1) ao kernel 3s após cada pedido de I/O.
+ *  - Lê pedidos de I/O do FIFO ("/tmp/so_trab1_iofifo", ou o caminho do 3º argumento,
+ *    usado por cada nó do modo cluster).
+ *  - Levanta o IRQ0 (relógio) a cada 1s.
+ *  - Levanta o IRQ1 (disco) 3s após cada pedido de I/O.
  *  - Controla fila de I/O e atualiza o estado na SHM.
  */
 int main(int argc, char **argv){
   if (argc < 3){
-    fprintf(stderr, "Uso: %s <shm_id> <kernel_pid>\n", argv[0]);
+    fprintf(stderr, "Uso: %s <shm_id> <kernel_pid> [fifo]\n", argv[0]);
     return 1;
   }
 
@@ -92,11 +100,9 @@ int main(int argc, char **argv){
     return 1;
   }
 
-  const int IRQ0_SIG = SIGUSR1;
-  const int IRQ1_SIG = SIGUSR2;
   const unsigned long MS_TIMESLICE = 1000;
   const unsigned long MS_IO = 3000;
-  const char *FIFO_CAMINHO = "/tmp/so_trab1_iofifo";
+  const char *FIFO_CAMINHO = (argc > 3) ? argv[3] : "/tmp/so_trab1_iofifo";
 
   int file_fifo = open(FIFO_CAMINHO, O_RDONLY | O_NONBLOCK);
   if (file_fifo < 0){
@@ -125,7 +131,7 @@ int main(int argc, char **argv){
 
     // IRQ0 periódico (clock)
     if (t >= prox_irq0){
-      kill(kpid, IRQ0_SIG);
+      irq_raise(shm, kpid, KS_IRQ_TIMER);
       printf("[IC %ldms] TICK (IRQ0)\n", rel_ms(t0));
       fflush(stdout);
       while (t >= prox_irq0){
@@ -175,8 +181,8 @@ int main(int argc, char **argv){
       fflush(stdout);
     }
 
-    // Conclusão do atendimento e envio de IRQ1
-    if (io_ativo && t >= prazo_irq1){
+    // Conclusão do atendimento e envio de IRQ1 (se o anterior já foi tratado)
+    if (io_ativo && t >= prazo_irq1 && !ks_pic_pending(&shm->pic, KS_IRQ_DISK) && shm->io_done_pid == 0){
       shm->d1_busy = 0;
       shm->io_inflight_pid = 0;
       shm->io_done_pid = cur_pid;
@@ -185,7 +191,7 @@ int main(int argc, char **argv){
       printf("[IC %ldms] ATENDIMENTO CONCLUÍDO (pid=%d I/O=%s) -> IRQ1\n",
              rel_ms(t0), (int)cur_pid, cur_tipo==0?"READ":"WRITE");
       fflush(stdout);
-      kill(kpid, IRQ1_SIG);
+      irq_raise(shm, kpid, KS_IRQ_DISK);
 
       // Avança fila e inicia o próximo atendimento, se houver
       qh = (qh + 1) % 128;
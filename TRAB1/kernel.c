@@ -2,9 +2,34 @@
  * @file    kernel.c
  * @brief   Kernel que implementa escalonamento Round-Robin com suporte a I/O via SHM e FIFO.
  * @details Este processo cria e gerencia os processos de aplicação (APPs) e o InterController.
- *          Ele coordena o uso da CPU entre múltiplos processos, lida com preempções (SIGUSR1)
- *          e interrupções de I/O (SIGUSR2). Também inicializa a memória compartilhada (SHM)
+ *          Ele coordena o uso da CPU entre múltiplos processos, lida com preempções (IRQ0)
+ *          e interrupções de I/O (IRQ1). Também inicializa a memória compartilhada (SHM)
  *          e o canal FIFO para comunicação com o InterController.
+ *          As interrupções chegam por um PIC simulado na SHM (ks_pic.c): o
+ *          InterController levanta a linha (bit pendente) e toca uma campainha única
+ *          (SIGUSR1); o kernel trata as linhas pendentes em ordem de prioridade (-Q).
+ *          A política de escalonamento fica no núcleo libkernelsim (ks_sched.c); aqui
+ *          ficam as ações concretas (SIGSTOP/SIGCONT, FIFO) passadas como callbacks.
+ *          Tarefas declaradas com `rt=T:C[:D]` entram na classe de tempo real EDF, que
+ *          tem precedência sobre o RR.
+ *          Com -I, o IRQ1 só registra o término (metade de cima) e os desbloqueios são
+ *          feitos em lote no IRQ0 (metade de baixo); -U limita a preempção que eles causam.
+ *          Com -C, várias instâncias formam um cluster (ks_cluster.c) e migram tarefas
+ *          de melhor esforço entre si: a origem congela a tarefa e manda pc e pedidos
+ *          pendentes; o destino cria um processo novo do mesmo executável, que retoma
+ *          do pc recebido.
+ *          Tarefas declaradas com `thr=<n>` têm várias threads: o grupo é escalonado como
+ *          uma tarefa e, enquanto tem a CPU, suas threads ocupam juntas as CPUs simuladas
+ *          (-P, ks_gang.c); o kernel liga e desliga cada thread por um futex na SHM.
+ *          Com -F, um modelo de energia (ks_power.c) põe a CPU ociosa num C-state,
+ *          escolhe a frequência por um governador e publica-a na SHM (cpu_freq).
+ *          Com -G/-g, tarefas declaradas com `cg=<grupo>` pertencem a grupos com cota de
+ *          CPU por período e pesos hierárquicos (ks_cgroup.c); um grupo que esgota a cota
+ *          fica sem CPU até a virada do período.
+ *          Com -K, um cache de blocos (ks_bcache.c, LRU ou ARC) fica na frente do
+ *          dispositivo: um READ que acerta e todo WRITE com vaga terminam sem bloquear a
+ *          tarefa; um flusher no IRQ0 grava os blocos sujos em lote, num único pedido
+ *          ao InterController em nome do próprio kernel.
  * 
  * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
  * @authors
@@ -21,35 +46,55 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <time.h>
 #include <stdbool.h>
 
-#define MAXN  6
+#include "ks_sched.h"
+#include "ks_sync.h"
+#include "ks_cluster.h"
+#include "ks_irq.h"
+#include "ks_chan.h"
+#include "ks_power.h"
+#include "ks_cgroup.h"
+#include "ks_bcache.h"
+#include "ks_pic.h"
+#include "ks_shm.h"
+
 #define MINN  3
 #define FIFO_PATH "/tmp/so_trab1_iofifo"
-
-enum { ST_NEW=0, ST_READY, ST_RUNNING, ST_WAITING, ST_DONE };
+#define NSYNC 16   /**< Objetos de sincronização (ids 0..NSYNC-1) */
+#define NCHAN 8    /**< Canais de mensagens (ids 0..NCHAN-1) */
+#define CLUSTER_PREFIX "/tmp/kernelsim"
+#define MIG_COOLDOWN 5   /**< Ticks em que uma tarefa recém-chegada não migra de novo */
+#define FLUSH_EXIT_TICKS 30   /**< Espera máxima pelo último lote do flusher no fim */
 
 /**
- * @struct shm_data
- * @brief  Estrutura compartilhada entre Kernel, APPs e InterController.
- * @details Mantém estado dos processos e dispositivos de I/O em memória compartilhada.
+ * @brief  Números das chamadas de sistema feitas pelas APPs via SHM (want_sys/sys_num).
+ * @details SYS_SLEEP: arg0 = ticks (IRQ0) que a tarefa fica fora da CPU.
+ *          SYS_MUTEX_LOCK/UNLOCK, SYS_SEM_WAIT/POST: arg0 = id do objeto.
+ *          SYS_COND_WAIT: arg0 = id da condição, arg1 = id do mutex (já adquirido).
+ *          SYS_COND_SIGNAL/BROADCAST: arg0 = id da condição.
+ *          SYS_RT_YIELD: fim do job do período (só tarefas de tempo real); a tarefa sai
+ *          da CPU até a próxima liberação.
+ *          SYS_CHAN_ALLOC: arg0 = canal; reserva um buffer para escrever (espera se não
+ *          houver livre). SYS_CHAN_SEND: arg0 = canal, arg1 = buffer, arg2 = bytes; envia
+ *          o descritor. SYS_CHAN_RECV: arg0 = canal; recebe um descritor (espera se o
+ *          canal estiver vazio). SYS_CHAN_FREE: arg0 = canal, arg1 = buffer; devolve.
+ *          sys_ret = 0 em sucesso (mesmo que a tarefa tenha esperado), -1 em uso inválido;
+ *          ALLOC e RECV retornam o índice do buffer no segmento `chan_shmid`; enquanto a
+ *          tarefa espera, sys_ret vale -2.
  */
-struct shm_data {
-  int  nprocs;               /**< Número total de processos */
-  pid_t app_pid[MAXN];       /**< PIDs das aplicações */
-  int  pc[MAXN];             /**< Contadores de programa */
-  int  want_io[MAXN];        /**< Flags de pedido de I/O */
-  int  io_type[MAXN];        /**< Tipo de I/O (0=READ, 1=WRITE) */
-  int  done;                 /**< Flag de término global */
-
-  int  d1_busy;              /**< Estado do dispositivo 1 */
-  pid_t io_inflight_pid;     /**< PID do processo em I/O */
-  pid_t io_done_pid;         /**< PID do processo cujo I/O terminou */
-  int   io_done_type;        /**< Tipo do I/O concluído */
+enum {
+  SYS_NONE=0, SYS_SLEEP=1,
+  SYS_MUTEX_LOCK=2, SYS_MUTEX_UNLOCK=3, SYS_SEM_WAIT=4, SYS_SEM_POST=5,
+  SYS_COND_WAIT=6, SYS_COND_SIGNAL=7, SYS_COND_BROADCAST=8,
+  SYS_RT_YIELD=9,
+  SYS_CHAN_ALLOC=10, SYS_CHAN_SEND=11, SYS_CHAN_RECV=12, SYS_CHAN_FREE=13
 };
 
 // ============================================================================
@@ -65,6 +110,14 @@ static long now_ms(void){
   return (long)ts.tv_sec*1000L + ts.tv_nsec/1000000L;
 }
 
+/**
+ * @brief  Retorna o tempo atual em ns (mesma base do InterController).
+ */
+static long long now_ns(void){
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
 /**
  * @brief  Inicializa o tempo base (t0) se ainda não definido.
  */
@@ -82,19 +135,69 @@ static int shm_id = -1;
 static struct shm_data *shm = NULL;
 static int num_procs = 3;
 static pid_t proc_pids[MAXN];
-static int proc_state[MAXN];
-static int current_idx = -1;
+static ks_sched sched;          /**< Núcleo de escalonamento (estado, fila de prontos, quantum) */
+static ks_sync sync_tab;        /**< Mutexes, semáforos e condições das APPs */
+static ks_chan chans;             /**< Canais de mensagens entre APPs */
+static int chan_seg_id = -1;      /**< Segmento dos buffers dos canais */
+static void *chan_seg = NULL;
+static int chan_attr[MAXN][2];    /**< Canais de entrada/saída declarados com ch=in:out */
+static int sem_init_val[NSYNC]; /**< Valor inicial dos semáforos declarados com -S (-1 = nenhum) */
 static int time_slice_seconds = 1;
-static int time_slice_left = 0;
+static int io_timeout_ticks = 0;  /**< Prazo de espera por I/O (0 = sem prazo) */
+static ks_qtune qtune;            /**< Ajuste automático do quantum (-A) */
+static int qtune_mode = KS_Q_FIXED, qtune_min = 1, qtune_max = 8, qtune_pct = 90;
+static int io_stale[MAXN];        /**< Pedidos de I/O que estouraram o prazo e ainda estão em D1 */
+static ks_rt rt_class;            /**< Classe de tempo real EDF */
+static int rt_bound_pct = 95;     /**< Limite de utilização da classe (-R) */
+static long rt_param[MAXN][3];    /**< T, C, D declarados com rt=T:C[:D] (T = 0: melhor esforço) */
+static ks_irqq irqq;              /**< Términos de I/O pendentes (coalescência, -I) */
+static int irq_window = 0, irq_batch = 0;     /**< Janela (ticks) e lote da coalescência */
+static int unblock_min = 0, unblock_cap = 0;  /**< Política de preempção no desbloqueio (-U) */
+static int idle_dispatch = 0;     /**< CPU livre despacha no próximo IRQ0 (-D) */
+static ks_cluster cluster;        /**< Modo cluster (-C) */
+static int cluster_node = -1;     /**< Id deste nó (-1 = fora de cluster) */
+static int cluster_nodes = 0;
+static int cluster_policy = KS_CL_NONE, cluster_threshold = 2;
+static long long slot_mig_ns[MAXN];  /**< Envio do MIGRATE de quem chegou migrando (0 = nenhum) */
+static long slot_arrived[MAXN];      /**< Tick de chegada por migração (-1 = tarefa nativa) */
+static int slot_moved[MAXN];         /**< Nó para onde a tarefa migrou (-1 = não migrou) */
+static char slot_held[MAXN];         /**< Vaga reservada a uma migração à espera do COMMIT */
+static ks_task_image slot_img[MAXN]; /**< Imagem da tarefa reservada */
+static ks_gang gang;              /**< Threads das tarefas e CPUs simuladas (-P, thr=) */
+static int gang_cpus = 1, gang_fair = KS_GANG_FAIR_GROUP;
+static int thr_attr[MAXN];        /**< Threads declaradas com thr=<n> (0 = uma só) */
+static ks_power power;            /**< Modelo de energia (-F) */
+static int power_gov = -1;        /**< Governador de frequência (-1 = modelo desligado) */
+static int power_cmax = KS_PW_CSTATES - 1;     /**< C-state mais profundo permitido */
+static long task_jobs[MAXN], task_job_ms[MAXN];  /**< Jobs das APPs, lidos da SHM no fim */
+static const char *gov_name[] = { "performance", "powersave", "ondemand", "schedutil" };
+static ks_cgroups cgroups;        /**< Grupos de tarefas com cota e pesos (-G, -g, cg=) */
+static const char *cg_spec[KS_CG_MAX];  /**< Grupos declarados com -G, na ordem */
+static int ncg_spec = 0;
+static const char *cg_file = NULL;      /**< Arquivo de grupos (-g) */
+static const char *cg_attr[MAXN];       /**< Grupo declarado com cg=<nome> (NULL = raiz) */
+static ks_bcache bcache;          /**< Cache de blocos na frente do dispositivo (-K) */
+static int bc_cap = 0;            /**< Blocos do cache (0 = desligado) */
+static int bc_policy = KS_BC_LRU, bc_interval = 3;  /**< Política e intervalo do flusher (ticks) */
+static long bc_last_flush = 0;    /**< Tick do último lote do flusher */
+static int io_pend_blk[MAXN];     /**< Bloco do READ que foi ao dispositivo (-1 = nenhum) */
+static long task_io_cache[MAXN], task_io_dev[MAXN];  /**< I/O atendido pelo cache / pelo dispositivo */
+static int pic_prio[KS_PIC_LINES];   /**< Prioridades dadas com -Q (-1 = padrão, o número da linha) */
+static uint32_t pic_masked = 0;      /**< Linhas mascaradas com -Q */
+static ks_pic pic_view;              /**< Cópia do PIC tirada da SHM no fim, para o relatório */
+static char app_path_buf[MAXN][KS_CL_PATHLEN];  /**< Executáveis de tarefas recebidas */
+static int num_initial = 3;       /**< Tarefas criadas na partida (as demais vagas ficam livres) */
+static char fifo_path[64] = FIFO_PATH;
 static int run_duration_seconds = 15;
 
 static pid_t inter_controller_pid = -1;
 static int fifo_fd = -1;
 static pid_t self_pid;
 
-static volatile sig_atomic_t got_irq0 = 0;
-static volatile sig_atomic_t got_irq1 = 0;
+static volatile sig_atomic_t got_doorbell = 0;
 static volatile sig_atomic_t stop_flag = 0;
+static volatile sig_atomic_t got_net = 0;
+static sigset_t irq_wait_mask;    /**< Máscara de antes do laço: a do sigsuspend e a dos filhos */
 
 /**
  * @brief  Caminho do executável de cada tarefa (A1..A6).
@@ -104,94 +207,406 @@ static volatile sig_atomic_t stop_flag = 0;
 static char *app_path[MAXN] = {0};
 
 // ============================================================================
-// Funções auxiliares de estado e escalonamento
+// Threads das tarefas (escalonamento em gangue)
 // ============================================================================
 
 /**
- * @brief  Define o estado lógico de um processo.
- * @param  i Índice do processo.
- * @param  st Novo estado (ST_READY, ST_RUNNING, etc).
+ * @brief  Acorda a thread que espera no futex `addr` (palavra da SHM, entre processos).
  */
-static void set_state(int i, int st) { proc_state[i] = st; }
+static void futex_wake(int *addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
 
 /**
- * @brief  Escolhe o próximo processo pronto (ST_READY) para execução.
- * @return Índice do processo selecionado, ou -1 se nenhum estiver pronto.
+ * @brief  Aplica às threads da tarefa `idx` a escolha de CPUs deste tick.
+ * @details Liga a palavra de cada thread escolhida e a acorda; as demais param no
+ *          próximo ponto de checagem da APP (entre fatias de uma instrução).
  */
-static int pick_next_ready(void) {
-  if (num_procs <= 0) return -1;
-  int start = (current_idx < 0 ? 0 : (current_idx + 1) % num_procs);
-  int i = start;
-  for (;;) {
-    if (proc_state[i] == ST_READY) return i;
-    i = (i + 1) % num_procs;
-    if (i == start) break;
+static void gang_run(int idx) {
+  if (!sched.gang || idx < 0 || shm->thr_n[idx] <= 1) return;
+  int run[KS_GANG_MAXTHR], n = shm->thr_n[idx], changed = 0;
+  int used = ks_gang_pick(&gang, idx, sched.now, shm->thr_state[idx], run);
+  for (int t = 0; t < n; t++) {
+    if (shm->thr_run[idx][t] == run[t]) continue;
+    changed = 1;
+    shm->thr_run[idx][t] = run[t];
+    if (run[t]) futex_wake(&shm->thr_run[idx][t]);
   }
-  return -1;
+  if (!changed) return;
+  printf("[KRL %ldms] GANGUE -> idx=%d pid=%d | %d/%d CPUs |", rel_ms(), idx, (int)proc_pids[idx], used, gang.ncpu);
+  for (int t = 0; t < n; t++) {
+    int st = shm->thr_state[idx][t];
+    printf(" t%d=%s", t, run[t] ? "CPU" : st == KS_THR_FUTEX ? "futex" : st == KS_THR_DONE ? "fim" : "pronta");
+  }
+  printf("\n");
+  fflush(stdout);
+}
+
+// ============================================================================
+// Energia (C-states e DVFS)
+// ============================================================================
+
+/**
+ * @brief  Ticks até o próximo temporizador armado (sono, prazo de I/O), ou -1.
+ */
+static long next_timer_in(void) {
+  long best = -1;
+  for (int i = 0; i < num_procs; i++) {
+    if (!ks_timer_pending(&sched.timers[i])) continue;
+    long d = (long)sched.timers[i].expires - sched.now;
+    if (d < 0) d = 0;
+    if (best < 0 || d < best) best = d;
+  }
+  return best;
 }
 
+/**
+ * @brief  Contabiliza o tick que terminou e publica a frequência escolhida pelo governador.
+ */
+static void power_tick(void) {
+  if (!ks_power_tick(&power, sched.current, sched.nready)) return;
+  shm->cpu_freq = ks_power_freq(&power);
+  printf("[KRL %ldms] DVFS -> %d%% (%d mW ativa)\n", rel_ms(), shm->cpu_freq, ks_pstates[power.level].power_mw);
+  fflush(stdout);
+}
+
+/**
+ * @brief  CPU sem tarefa: entra no C-state escolhido pelo governador ocioso.
+ */
+static void power_idle(void) {
+  if (power_gov < 0 || sched.current >= 0 || power.idle) return;
+  long nxt = next_timer_in();
+  int c = ks_power_idle_enter(&power, sched.now, nxt);
+  printf("[KRL %ldms] OCIOSO -> %s | previsão=%.1f ticks próximo temporizador=%ld\n",
+         rel_ms(), ks_cstates[c].name, power.idle_ema, nxt);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Uma tarefa vai rodar: a CPU sai do C-state e paga a latência de saída.
+ */
+static void power_wake(void) {
+  if (power_gov < 0 || !power.idle) return;
+  int c = power.cstate;
+  long len = sched.now - power.idle_since;
+  int ms = ks_power_idle_exit(&power, sched.now);
+  printf("[KRL %ldms] CPU ACORDA <- %s após %ld ticks | saída=%dms\n", rel_ms(), ks_cstates[c].name, len, ms);
+  fflush(stdout);
+  struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+  while (ms > 0 && nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+}
+
+// ============================================================================
+// Ações de despacho (callbacks do núcleo libkernelsim)
+// ============================================================================
+
 /**
  * @brief  Despacha um processo para execução (envia SIGCONT).
  * @param  idx Índice do processo.
  */
-static void dispatch_index(int idx) {
-  if (idx < 0) return;
-  current_idx = idx;
-  set_state(idx, ST_RUNNING);
+static void krl_dispatch(void *ctx, int idx) {
+  (void)ctx;
+  ks_sync_on_dispatch(&sync_tab, idx);
+  if (slot_mig_ns[idx]) { ks_cluster_downtime(&cluster, slot_mig_ns[idx]); slot_mig_ns[idx] = 0; }
   printf("[KRL %ldms] DESPACHE -> idx=%d pid=%d\n", rel_ms(), idx, (int)proc_pids[idx]);
   fflush(stdout);
+  power_wake();
+  gang_run(idx);
   kill(proc_pids[idx], SIGCONT);
 }
 
 /**
- * @brief  Preempção: move o processo atual de RUNNING para READY.
+ * @brief  Preempção: tira o processo da CPU (envia SIGSTOP).
+ * @param  idx Índice do processo.
  */
-static void preempt_running_to_ready(void) {
-  if (current_idx < 0) return;
-  int i = current_idx;
-  printf("[KRL %ldms] PREEMPÇÃO -> idx=%d pid=%d (sai da CPU)\n", rel_ms(), i, (int)proc_pids[i]);
+static void krl_preempt(void *ctx, int idx) {
+  (void)ctx;
+  printf("[KRL %ldms] PREEMPÇÃO -> idx=%d pid=%d (sai da CPU)\n", rel_ms(), idx, (int)proc_pids[idx]);
   fflush(stdout);
-  kill(proc_pids[i], SIGSTOP);
-  set_state(i, ST_READY);
-  current_idx = -1;
+  kill(proc_pids[idx], SIGSTOP);
 }
 
 /**
- * @brief  Bloqueia o processo atual por I/O e envia solicitação ao FIFO.
+ * @brief  Bloqueia o processo por I/O e envia solicitação ao FIFO.
+ * @param  idx     Índice do processo.
  * @param  io_type Tipo de operação (0=READ, 1=WRITE).
  */
-static void block_running_for_io(int io_type) {
-  if (current_idx < 0) return;
-  int i = current_idx;
+static void krl_block(void *ctx, int idx, int io_type) {
+  (void)ctx;
   printf("[KRL %ldms] BLOQUEIO (I/O %s) -> idx=%d pid=%d | ENFILEIRA\n",
-         rel_ms(), io_type==0?"READ":"WRITE", i, (int)proc_pids[i]);
+         rel_ms(), io_type==0?"READ":"WRITE", idx, (int)proc_pids[idx]);
   fflush(stdout);
 
-  kill(proc_pids[i], SIGSTOP);
-  set_state(i, ST_WAITING);
-  current_idx = -1;
+  kill(proc_pids[idx], SIGSTOP);
 
   if (fifo_fd >= 0) {
-    dprintf(fifo_fd, "%d %d\n", (int)proc_pids[i], io_type);
+    dprintf(fifo_fd, "%d %d\n", (int)proc_pids[idx], io_type);
+  }
+}
+
+/**
+ * @brief  Registra o desbloqueio de um processo cujo I/O terminou (IRQ1). A decisão de
+ *         preempção vem depois (io_priority_log).
+ * @param  idx     Índice do processo.
+ * @param  io_type Tipo do I/O concluído.
+ */
+static void krl_unblock(void *ctx, int idx, int io_type) {
+  (void)ctx;
+  printf("[KRL %ldms] DESBLOQUEIO (IRQ1 I/O %s) -> idx=%d pid=%d | PRONTO\n",
+         rel_ms(), io_type==0?"READ":"WRITE", idx, (int)proc_pids[idx]);
+  fflush(stdout);
+  // O bloco lido do dispositivo entra no cache para os próximos READs
+  if (bc_cap > 0 && io_type == 0 && io_pend_blk[idx] >= 0) {
+    ks_bc_fill(&bcache, io_pend_blk[idx], sched.now);
+    io_pend_blk[idx] = -1;
   }
 }
 
+/**
+ * @brief  Registra que um processo foi dormir (syscall SLEEP) e o tira da CPU.
+ * @param  idx   Índice do processo.
+ * @param  ticks Duração do sono em ticks.
+ */
+static void krl_sleep(void *ctx, int idx, long ticks) {
+  (void)ctx;
+  printf("[KRL %ldms] DORME (SLEEP %ld ticks) -> idx=%d pid=%d\n",
+         rel_ms(), ticks, idx, (int)proc_pids[idx]);
+  fflush(stdout);
+  kill(proc_pids[idx], SIGSTOP);
+}
+
+/**
+ * @brief  Registra o fim do sono de um processo (volta à fila de prontos).
+ * @param  idx Índice do processo.
+ */
+static void krl_wake(void *ctx, int idx) {
+  (void)ctx;
+  printf("[KRL %ldms] DESPERTA -> idx=%d pid=%d | PRONTO\n", rel_ms(), idx, (int)proc_pids[idx]);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Espera por I/O estourou o prazo: o processo volta a PRONTO e o IRQ1 tardio
+ *         correspondente será descartado.
+ * @param  idx Índice do processo.
+ */
+static void krl_io_timeout(void *ctx, int idx) {
+  (void)ctx;
+  io_stale[idx]++;
+  io_pend_blk[idx] = -1;
+  printf("[KRL %ldms] TIMEOUT (I/O) -> idx=%d pid=%d | PRONTO\n", rel_ms(), idx, (int)proc_pids[idx]);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Processo bloqueou num objeto de sincronização (sai da CPU).
+ * @param  idx Índice do processo.
+ */
+static void krl_park(void *ctx, int idx) {
+  (void)ctx;
+  if (chans.waiting_on && chans.waiting_on[idx] >= 0)
+    printf("[KRL %ldms] ESPERA (CANAL ch=%d) -> idx=%d pid=%d\n",
+           rel_ms(), chans.waiting_on[idx], idx, (int)proc_pids[idx]);
+  else
+    printf("[KRL %ldms] ESPERA (SYNC obj=%d) -> idx=%d pid=%d\n",
+           rel_ms(), sync_tab.waiting_on[idx], idx, (int)proc_pids[idx]);
+  fflush(stdout);
+  kill(proc_pids[idx], SIGSTOP);
+}
+
+/**
+ * @brief  Processo liberado de um objeto de sincronização (volta a PRONTO).
+ * @param  idx Índice do processo.
+ */
+static void krl_unpark(void *ctx, int idx) {
+  (void)ctx;
+  // Canal: o buffer entregue é o retorno do ALLOC/RECV que esperou
+  if (chans.result && chans.result[idx] >= 0) {
+    shm->sys_ret[idx] = chans.result[idx];
+    chans.result[idx] = -1;
+    printf("[KRL %ldms] LIBERADO (CANAL buf=%d) -> idx=%d pid=%d | PRONTO\n",
+           rel_ms(), shm->sys_ret[idx], idx, (int)proc_pids[idx]);
+  } else {
+    printf("[KRL %ldms] LIBERADO (SYNC) -> idx=%d pid=%d | PRONTO\n", rel_ms(), idx, (int)proc_pids[idx]);
+  }
+  fflush(stdout);
+}
+
+/**
+ * @brief  Registra uma mudança de quantum feita pelo ajuste automático.
+ * @param  idx Índice do processo, ou -1 para o quantum global.
+ * @param  q   Novo quantum em ticks.
+ */
+static void krl_quantum(void *ctx, int idx, int q) {
+  (void)ctx;
+  if (idx < 0) printf("[KRL %ldms] QUANTUM (global) -> %d ticks\n", rel_ms(), q);
+  else         printf("[KRL %ldms] QUANTUM -> idx=%d pid=%d | %d ticks\n", rel_ms(), idx, (int)proc_pids[idx], q);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Registra a liberação de um job de tempo real (volta a PRONTO).
+ * @param  idx Índice do processo.
+ */
+static void krl_release(void *ctx, int idx) {
+  (void)ctx;
+  printf("[KRL %ldms] LIBERAÇÃO (RT) -> idx=%d pid=%d | prazo=%ld\n",
+         rel_ms(), idx, (int)proc_pids[idx], rt_class.t[idx].dl);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Job de tempo real concluído (SYS_RT_YIELD): sai da CPU até a próxima liberação.
+ * @param  idx  Índice do processo.
+ * @param  late Atraso em ticks (<= 0 = no prazo).
+ */
+static void krl_job_done(void *ctx, int idx, long late) {
+  (void)ctx;
+  printf("[KRL %ldms] FIM DO JOB (RT) -> idx=%d pid=%d | %s %ld ticks\n",
+         rel_ms(), idx, (int)proc_pids[idx], late > 0 ? "ATRASO" : "folga", late > 0 ? late : -late);
+  fflush(stdout);
+  kill(proc_pids[idx], SIGSTOP);
+}
+
+/**
+ * @brief  Job de tempo real esgotou o WCET declarado: suspenso até a próxima liberação.
+ * @param  idx Índice do processo.
+ */
+static void krl_throttle(void *ctx, int idx) {
+  (void)ctx;
+  printf("[KRL %ldms] ESTOURO DE WCET (RT) -> idx=%d pid=%d | suspenso\n",
+         rel_ms(), idx, (int)proc_pids[idx]);
+  fflush(stdout);
+  kill(proc_pids[idx], SIGSTOP);
+}
+
+/**
+ * @brief  Registra um grupo que esgotou a cota ou foi liberado na virada do período.
+ * @param  gid       Id do grupo.
+ * @param  throttled 1 = limitado, 0 = liberado.
+ */
+static void krl_cgroup(void *ctx, int gid, int throttled) {
+  (void)ctx;
+  const ks_cgroup *g = &cgroups.g[gid];
+  if (throttled)
+    printf("[KRL %ldms] CGROUP %s LIMITADO | cota %d/%d esgotada | sem CPU até o tick %ld\n",
+           rel_ms(), g->name, g->quota, g->period, g->next_refill);
+  else
+    printf("[KRL %ldms] CGROUP %s LIBERADO | novo período\n", rel_ms(), g->name);
+  fflush(stdout);
+}
+
+static const ks_ops krl_ops = {
+  .dispatch   = krl_dispatch,
+  .preempt    = krl_preempt,
+  .block      = krl_block,
+  .unblock    = krl_unblock,
+  .sleep      = krl_sleep,
+  .wake       = krl_wake,
+  .io_timeout = krl_io_timeout,
+  .park       = krl_park,
+  .unpark     = krl_unpark,
+  .quantum    = krl_quantum,
+  .release    = krl_release,
+  .job_done   = krl_job_done,
+  .throttle   = krl_throttle,
+  .cgroup     = krl_cgroup,
+};
+
+/**
+ * @brief  Executa uma syscall de sincronização para o processo corrente.
+ * @return 0 (concluída), 1 (processo bloqueou) ou -1 (uso inválido).
+ */
+static int sync_syscall(int num, int a0, int a1) {
+  switch (num) {
+    case SYS_MUTEX_LOCK:     return ks_mutex_lock(&sync_tab, a0);
+    case SYS_MUTEX_UNLOCK:   return ks_mutex_unlock(&sync_tab, a0);
+    case SYS_SEM_WAIT:       return ks_sem_wait(&sync_tab, a0);
+    case SYS_SEM_POST:       return ks_sem_post(&sync_tab, a0);
+    case SYS_COND_WAIT:      return ks_cond_wait(&sync_tab, a0, a1);
+    case SYS_COND_SIGNAL:    return ks_cond_signal(&sync_tab, a0);
+    case SYS_COND_BROADCAST: return ks_cond_broadcast(&sync_tab, a0);
+  }
+  return -1;
+}
+
+/**
+ * @brief  Executa uma syscall de canal para a tarefa corrente.
+ * @return Retorno de ks_chan_* (buffer, 0, KS_CHAN_BLOCKED ou -1).
+ */
+static int chan_syscall(int num, int a0, int a1, int a2) {
+  switch (num) {
+    case SYS_CHAN_ALLOC: return ks_chan_alloc(&chans, a0);
+    case SYS_CHAN_SEND:  return ks_chan_send(&chans, a0, a1, a2);
+    case SYS_CHAN_RECV:  return ks_chan_recv(&chans, a0);
+    case SYS_CHAN_FREE:  return ks_chan_free(&chans, a0, a1);
+  }
+  return -1;
+}
+
+/**
+ * @brief  Trata a chamada de sistema pendente do processo corrente.
+ * @param  idx Índice do processo (corrente).
+ * @details A flag want_sys só é limpa depois da ação, para que a APP (que aguarda a
+ *          flag) não avance antes de ser tirada da CPU.
+ */
+static void handle_syscall(int idx) {
+  int num = shm->sys_num[idx];
+  int a0 = shm->sys_arg[idx][0], a1 = shm->sys_arg[idx][1], a2 = shm->sys_arg[idx][2];
+  int r = 0;
+  switch (num) {
+    case SYS_SLEEP:
+      shm->sys_ret[idx] = 0;
+      ks_sleep_running(&sched, a0);
+      break;
+    case SYS_MUTEX_LOCK: case SYS_MUTEX_UNLOCK: case SYS_SEM_WAIT: case SYS_SEM_POST:
+    case SYS_COND_WAIT:  case SYS_COND_SIGNAL:  case SYS_COND_BROADCAST:
+      r = sync_syscall(num, a0, a1);
+      if (r < 0) {
+        printf("[KRL %ldms] SYSCALL %d (obj=%d) inválida -> idx=%d\n", rel_ms(), num, a0, idx);
+        fflush(stdout);
+      }
+      shm->sys_ret[idx] = (r < 0) ? -1 : 0;
+      break;
+    case SYS_RT_YIELD:
+      shm->sys_ret[idx] = 0;
+      if (ks_job_done(&sched, NULL) != 0) shm->sys_ret[idx] = -1;
+      break;
+    case SYS_CHAN_ALLOC: case SYS_CHAN_SEND: case SYS_CHAN_RECV: case SYS_CHAN_FREE:
+      r = chan_syscall(num, a0, a1, a2);
+      if (r == -1) {
+        printf("[KRL %ldms] SYSCALL %d (canal=%d) inválida -> idx=%d\n", rel_ms(), num, a0, idx);
+        fflush(stdout);
+      }
+      // Bloqueou: sys_ret fica KS_CHAN_BLOCKED até a liberação (krl_unpark), e a APP
+      // espera o buffer de verdade mesmo se enxergar want_sys=0 antes do SIGSTOP
+      shm->sys_ret[idx] = r;
+      break;
+    default:
+      printf("[KRL %ldms] SYSCALL inválida (%d) -> idx=%d\n", rel_ms(), num, idx);
+      fflush(stdout);
+      shm->sys_ret[idx] = -1;
+      break;
+  }
+  shm->want_sys[idx] = 0;
+}
+
 // ============================================================================
 // Handlers de sinais
 // ============================================================================
 
 /**
- * @brief Handler do IRQ0 (clock/tick).
+ * @brief Handler da campainha do PIC (há linha de IRQ pendente na SHM).
  */
-static void on_irq0(int sig) { (void)sig; got_irq0 = 1; }
+static void on_doorbell(int sig) { (void)sig; got_doorbell = 1; }
 
 /**
- * @brief Handler do IRQ1 (término de I/O).
+ * @brief Handler de mensagem do cluster (SIGIO no socket do nó).
  */
-static void on_irq1(int sig) { (void)sig; got_irq1 = 1; }
+static void on_net(int sig) { (void)sig; got_net = 1; }
 
 /**
- * @brief Handler de parada (SIGINT/SIGTERM).
+ * @brief Handler de parada (SIGINT/SIGTERM) e do prazo de execução (SIGALRM).
  */
 static void on_stop(int sig) { (void)sig; stop_flag = 1; }
 
@@ -201,12 +616,23 @@ static void on_stop(int sig) { (void)sig; stop_flag = 1; }
 static void install_handlers(void) {
   struct sigaction sa;
   memset(&sa, 0, sizeof(sa));
-  sa.sa_handler = on_irq0; sigemptyset(&sa.sa_mask); sa.sa_flags = SA_RESTART;
+  sa.sa_handler = on_doorbell; sigemptyset(&sa.sa_mask); sa.sa_flags = SA_RESTART;
   sigaction(SIGUSR1, &sa, NULL);
 
-  sa.sa_handler = on_irq1; sigaction(SIGUSR2, &sa, NULL);
   sa.sa_handler = on_stop; sigaction(SIGINT, &sa, NULL);
   sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGALRM, &sa, NULL);
+  sa.sa_handler = on_net; sigaction(SIGIO, &sa, NULL);
+}
+
+/**
+ * @brief Dorme até a próxima campainha, SIGIO ou parada, se não houver nada pendente.
+ * @details Chamada com SIGUSR1/SIGIO bloqueados: o teste do IRR e a espera são uma
+ *          operação só, então um toque entre o último ks_pic_ack e a espera não se perde.
+ */
+static void wait_irq(void) {
+  if (got_doorbell || got_net || stop_flag || ks_pic_deliverable(&shm->pic)) return;
+  sigsuspend(&irq_wait_mask);
 }
 
 // ============================================================================
@@ -224,21 +650,41 @@ static void shared_memory_init(int n) {
   if (shm == (void*)-1) { perror("shmat"); exit(1); }
   memset(shm, 0, sizeof(*shm));
   shm->nprocs = n;
+
+  // Buffers dos canais: as APPs escrevem e leem as mensagens direto aqui
+  chan_seg_id = shmget(IPC_PRIVATE, KS_CHAN_SEG_SIZE(NCHAN), IPC_CREAT | IPC_EXCL | 0600);
+  if (chan_seg_id == -1) { perror("shmget canais"); exit(1); }
+  chan_seg = shmat(chan_seg_id, NULL, 0);
+  if (chan_seg == (void*)-1) { perror("shmat canais"); exit(1); }
+  memset(chan_seg, 0, KS_CHAN_SEG_SIZE(NCHAN));
+  shm->chan_shmid = chan_seg_id;
+  for (int i = 0; i < MAXN; i++) {
+    shm->chan_in[i] = (i < n) ? chan_attr[i][0] : -1;
+    shm->chan_out[i] = (i < n) ? chan_attr[i][1] : -1;
+    shm->thr_n[i] = (i < n) ? thr_attr[i] : 0;
+  }
+
+  // PIC: relógio e disco, com as prioridades e máscaras de -Q
+  ks_pic_init(&shm->pic, KS_IRQ_DISK + 1);
+  for (int l = 0; l < shm->pic.nlines; l++) {
+    if (pic_prio[l] >= 0) ks_pic_set_prio(&shm->pic, l, pic_prio[l]);
+    if (pic_masked & (1u << l)) ks_pic_mask(&shm->pic, l, 1);
+  }
 }
 
 /**
  * @brief Cria o FIFO usado para comunicação com o InterController.
  */
 static void fifo_make_only(void) {
-  unlink(FIFO_PATH);
-  if (mkfifo(FIFO_PATH, 0600) == -1) { perror("mkfifo"); exit(1); }
+  unlink(fifo_path);
+  if (mkfifo(fifo_path, 0600) == -1) { perror("mkfifo"); exit(1); }
 }
 
 /**
  * @brief Abre o FIFO no modo de escrita, bloqueando até o leitor abrir.
  */
 static void fifo_open_writer_blocking(void) {
-  fifo_fd = open(FIFO_PATH, O_WRONLY);
+  fifo_fd = open(fifo_path, O_WRONLY);
   if (fifo_fd < 0) { perror("open fifo wr"); exit(1); }
 }
 
@@ -252,34 +698,48 @@ static void spawn_inter_controller(void) {
     char shmid_s[32], kpid_s[32];
     snprintf(shmid_s, sizeof(shmid_s), "%d", shm_id);
     snprintf(kpid_s,  sizeof(kpid_s), "%d", (int)self_pid);
-    execlp("./inter_controller", "./inter_controller", shmid_s, kpid_s, (char*)NULL);
+    sigprocmask(SIG_SETMASK, &irq_wait_mask, NULL);
+    execlp("./inter_controller", "./inter_controller", shmid_s, kpid_s, fifo_path, (char*)NULL);
     _exit(127);
   }
   inter_controller_pid = pid;
 }
 
+/**
+ * @brief Cria o processo da tarefa i (parado, à espera do primeiro despacho).
+ * @details Se app_path[i] for não nulo, usa esse caminho; caso contrário, usa "./app"
+ *          para manter compatibilidade.
+ */
+static void spawn_one(int i) {
+  const char *path = app_path[i] ? app_path[i] : "./app";
+  pid_t p = fork();
+  if (p < 0) { perror("fork app"); exit(1); }
+  if (p == 0) {
+    char shmid_s[32];
+    snprintf(shmid_s, sizeof(shmid_s), "%d", shm_id);
+    // Log opcional para auditoria: qual executável será rodado
+    // fprintf(stderr, "[KRL] spawn #%d -> %s\n", i, path);
+    sigprocmask(SIG_SETMASK, &irq_wait_mask, NULL);
+    execlp(path, path, shmid_s, (char*)NULL);
+    _exit(127);
+  }
+  proc_pids[i] = p;
+  shm->app_pid[i] = p;
+  kill(p, SIGSTOP);
+}
+
 /**
  * @brief Cria os processos de aplicação (APPs) com executável específico por tarefa.
- * @details Para cada tarefa i, se app_path[i] for não nulo, usa esse caminho;
- *          caso contrário, usa "./app" para manter compatibilidade.
+ * @details No modo cluster as vagas além das tarefas iniciais ficam livres (ST_DONE)
+ *          para receber tarefas migradas.
  */
 static void spawn_apps(void) {
   for (int i = 0; i < num_procs; i++) {
-    const char *path = app_path[i] ? app_path[i] : "./app";
-    pid_t p = fork();
-    if (p < 0) { perror("fork app"); exit(1); }
-    if (p == 0) {
-      char shmid_s[32];
-      snprintf(shmid_s, sizeof(shmid_s), "%d", shm_id);
-      // Log opcional para auditoria: qual executável será rodado
-      // fprintf(stderr, "[KRL] spawn #%d -> %s\n", i, path);
-      execlp(path, path, shmid_s, (char*)NULL);
-      _exit(127);
-    }
-    proc_pids[i] = p;
-    shm->app_pid[i] = p;
-    set_state(i, ST_READY);
-    kill(p, SIGSTOP);
+    slot_arrived[i] = -1;
+    slot_moved[i] = -1;
+    if (i >= num_initial) { ks_set_state(&sched, i, ST_DONE); continue; }
+    spawn_one(i);
+    ks_set_state(&sched, i, ST_READY);
   }
 }
 
@@ -289,32 +749,921 @@ static void spawn_apps(void) {
  * @return Índice em [0..num_procs-1] ou -1 se não encontrado.
  */
 static int idx_of_pid(pid_t p) {
-  for (int i = 0; i < num_procs; i++) if (proc_pids[i] == p) return i;
+  for (int i = 0; i < num_procs; i++) if (proc_pids[i] > 0 && proc_pids[i] == p) return i;
   return -1;
 }
 
+// ============================================================================
+// Términos de I/O (IRQ1)
+// ============================================================================
+
+/**
+ * @brief  Informa o que a prioridade do IRQ1 fez com o término (ou lote) recém-tratado.
+ * @param  cur Corrente antes do término.
+ * @param  st  Contadores do escalonador antes do término.
+ */
+static void io_priority_log(int cur, const ks_stats *st) {
+  int now = sched.current;
+  if (now >= 0 && now != cur) {
+    if (cur >= 0) printf("[KRL %ldms] PRIORIDADE IRQ1 -> idx=%d pid=%d | PREEMPTOU idx=%d\n",
+                         rel_ms(), now, (int)proc_pids[now], cur);
+    else printf("[KRL %ldms] PRIORIDADE IRQ1 -> idx=%d pid=%d | CPU LIVRE\n",
+                rel_ms(), now, (int)proc_pids[now]);
+  } else if (sched.stats.io_deferred > st->io_deferred) {
+    printf("[KRL %ldms] PRIORIDADE IRQ1 ADIADA -> idx=%d roda ao menos %d tick(s)\n",
+           rel_ms(), cur, sched.min_run);
+  } else if (sched.stats.io_capped > st->io_capped) {
+    printf("[KRL %ldms] SEM PRIORIDADE IRQ1 -> limite de %d impulso(s) seguidos\n",
+           rel_ms(), sched.boost_cap);
+  } else if (cur >= 0) {
+    printf("[KRL %ldms] SEM PREEMPÇÃO -> idx=%d segue na CPU\n", rel_ms(), cur);
+  } else {
+    printf("[KRL %ldms] SEM PREEMPÇÃO -> CPU segue livre\n", rel_ms());
+  }
+  fflush(stdout);
+}
+
+/**
+ * @brief  Metade de baixo do IRQ1: desbloqueia em lote os términos coalescidos.
+ */
+static void io_bottom_half(void) {
+  int idx[MAXN], typ[MAXN];
+  int n = ks_irq_drain(&irqq, idx, typ, MAXN, sched.now);
+  if (n <= 0) return;
+  printf("[KRL %ldms] IRQ1 LOTE -> %d término(s)\n", rel_ms(), n);
+  fflush(stdout);
+  for (int k = 0; k < n; k++) {
+    // O prazo de I/O venceu enquanto o término esperava no lote: é o IRQ1 tardio dele
+    if (sched.state[idx[k]] != ST_WAITING && io_stale[idx[k]] > 0) {
+      io_stale[idx[k]]--;
+      idx[k] = -1;
+    }
+  }
+  int cur = sched.current;
+  ks_stats st = sched.stats;
+  if (ks_io_complete_batch(&sched, idx, typ, n) > 0) io_priority_log(cur, &st);
+}
+
+// ============================================================================
+// Cache de blocos (-K)
+// ============================================================================
+
+/**
+ * @brief  Pedido de I/O da tarefa corrente: passa pelo cache (se houver) ou bloqueia
+ *         a tarefa no dispositivo.
+ * @param  idx Índice da tarefa.
+ * @param  iot Tipo do I/O (0=READ, 1=WRITE).
+ */
+static void io_request(int idx, int iot) {
+  if (bc_cap > 0) {
+    int blk = shm->io_blk[idx];
+    int hit = (iot == 0) ? ks_bc_read(&bcache, blk) : ks_bc_write(&bcache, blk, sched.now);
+    if (hit) {
+      task_io_cache[idx]++;
+      printf("[KRL %ldms] CACHE (I/O %s) bloco=%d -> idx=%d pid=%d | %s\n",
+             rel_ms(), iot==0?"READ":"WRITE", blk, idx, (int)proc_pids[idx],
+             iot==0 ? "ACERTO, SEGUE NA CPU" : "WRITE-BACK, SEGUE NA CPU");
+      fflush(stdout);
+      return;
+    }
+    io_pend_blk[idx] = (iot == 0) ? blk : -1;
+  }
+  task_io_dev[idx]++;
+  ks_block_running(&sched, iot);
+}
+
+/**
+ * @brief  Manda todos os blocos sujos ao dispositivo num único pedido em nome do kernel.
+ */
+static void flush_send(long now) {
+  int n = ks_bc_flush_begin(&bcache, now, bcache.cap);
+  bc_last_flush = now;
+  printf("[KRL %ldms] FLUSHER -> %d bloco(s) sujo(s) num pedido ao dispositivo\n", rel_ms(), n);
+  fflush(stdout);
+  dprintf(fifo_fd, "%d %d\n", (int)self_pid, 1);
+}
+
+/**
+ * @brief  Flusher: a cada `bc_interval` ticks, ou com metade do cache suja, manda os
+ *         blocos sujos ao dispositivo num único pedido (um lote por vez).
+ * @details O pedido vai pela FIFO com o pid do kernel; o IRQ1 dele chama flush_done().
+ */
+static void flusher_tick(void) {
+  if (bc_cap <= 0 || bcache.nflushing > 0 || bcache.ndirty == 0 || fifo_fd < 0) return;
+  if (sched.now - bc_last_flush < bc_interval && bcache.ndirty * 2 < bcache.cap) return;
+  flush_send(sched.now);
+}
+
+/**
+ * @brief  IRQ1 do lote do flusher: os blocos gravados ficam limpos.
+ */
+static void flush_done(long now) {
+  long lat = now - bcache.flush_at;
+  int n = ks_bc_flush_end(&bcache, now);
+  printf("[KRL %ldms] IRQ1 (FLUSHER) -> %d bloco(s) gravado(s) | latência=%ld ticks | sujos=%d\n",
+         rel_ms(), n, lat, bcache.ndirty);
+  fflush(stdout);
+}
+
+/**
+ * @brief  No fim da execução, grava os blocos ainda sujos antes de desmontar o cache.
+ * @details Chamada com as APPs já mortas e o InterController vivo: espera o lote em
+ *          voo, manda um último com o que sobrou e espera o IRQ1 dele. Os IRQ0 só
+ *          contam ticks e os IRQ1 de pedidos das APPs são descartados. Desiste após
+ *          FLUSH_EXIT_TICKS ticks ou num novo SIGINT/SIGTERM; o que não foi gravado
+ *          aparece no relatório.
+ */
+static void flush_at_exit(void) {
+  if (bc_cap <= 0 || fifo_fd < 0 || bcache.ndirty + bcache.nflushing == 0) return;
+  printf("[KRL %ldms] FLUSHER (fim) -> %d bloco(s) sujo(s), %d em gravação\n",
+         rel_ms(), bcache.ndirty, bcache.nflushing);
+  fflush(stdout);
+  stop_flag = 0;
+  long now = sched.now;
+  while (bcache.ndirty + bcache.nflushing > 0 && now - sched.now < FLUSH_EXIT_TICKS && !stop_flag) {
+    if (bcache.nflushing == 0) flush_send(now);
+    wait_irq();
+    got_doorbell = 0;
+    int line;
+    while ((line = ks_pic_ack(&shm->pic, now_ns())) >= 0) {
+      if (line == KS_IRQ_TIMER) { now++; continue; }
+      if (line != KS_IRQ_DISK) continue;
+      if (shm->io_done_pid == self_pid) flush_done(now);
+      shm->io_done_pid = 0;
+      shm->io_done_type = 0;
+    }
+  }
+}
+
+// ============================================================================
+// Cluster (migração de tarefas entre instâncias)
+// ============================================================================
+
 /**
- * @brief  Lê blocos "-- <app>" da linha de comando e preenche app_path[].
+ * @brief  Retorna 1 se a tarefa é dona de algum mutex (não pode migrar).
+ */
+static int owns_mutex(int idx) {
+  for (int id = 0; id < sync_tab.nobj; id++)
+    if (sync_tab.obj[id].kind == KS_SYNC_MUTEX && sync_tab.obj[id].owner == idx) return 1;
+  return 0;
+}
+
+/**
+ * @brief  Escolhe uma tarefa que pode migrar: pronta, de melhor esforço, sem mutex,
+ *         sem IRQ1 tardio pendente e que não acabou de chegar.
+ * @return Índice da tarefa, ou -1.
+ */
+static int pick_migratable(void) {
+  for (int i = num_procs - 1; i >= 0; i--) {
+    if (sched.state[i] != ST_READY || ks_rt_is(sched.rt, i) || io_stale[i] > 0 || owns_mutex(i)) continue;
+    // Canais são locais ao nó
+    if (shm->chan_in[i] >= 0 || shm->chan_out[i] >= 0 || ks_chan_holds(&chans, i)) continue;
+    // O estado das threads fica na SHM deste nó
+    if (shm->thr_n[i] > 1) continue;
+    // A cota do grupo vale só neste nó
+    if (sched.cg && cgroups.grp[i] != 0) continue;
+    if (slot_arrived[i] >= 0 && sched.now - slot_arrived[i] < MIG_COOLDOWN) continue;
+    return i;
+  }
+  return -1;
+}
+
+/**
+ * @brief  Retorna uma vaga livre para receber uma tarefa, ou -1.
+ */
+static int free_slot(void) {
+  for (int i = 0; i < num_procs; i++)
+    if (sched.state[i] == ST_DONE && !ks_rt_is(sched.rt, i) && !slot_held[i]) return i;
+  return -1;
+}
+
+/**
+ * @brief  Congela uma tarefa pronta e a envia ao nó `to`.
+ * @return 0 se a migração foi iniciada, -1 caso contrário.
+ */
+static int migrate_out(int to) {
+  int idx = pick_migratable();
+  if (idx < 0) return -1;
+  ks_task_image img;
+  memset(&img, 0, sizeof(img));
+  snprintf(img.path, sizeof(img.path), "%s", app_path[idx] ? app_path[idx] : "./app");
+  img.pc = shm->pc[idx];
+  img.want_io = shm->want_io[idx];
+  img.io_type = shm->io_type[idx];
+  img.want_sys = shm->want_sys[idx];
+  img.sys_num = shm->sys_num[idx];
+  memcpy(img.sys_arg, shm->sys_arg[idx], sizeof(img.sys_arg));
+  img.cpu = sched.cpu[idx];
+  if (ks_cluster_migrate(&cluster, to, idx, &img) != 0) return -1;
+  ks_set_state(&sched, idx, ST_MIGRATING);
+  printf("[KRL %ldms] MIGRAÇÃO -> idx=%d pid=%d pc=%d para nó %d | congelada\n",
+         rel_ms(), idx, (int)proc_pids[idx], img.pc, to);
+  fflush(stdout);
+  return 0;
+}
+
+/**
+ * @brief  Recebe um MIGRATE: reserva uma vaga livre e responde, sem rodar a tarefa.
+ */
+static void migrate_in(const ks_clmsg *m) {
+  int slot = free_slot();
+  if (slot < 0) {
+    printf("[KRL %ldms] MIGRAÇÃO RECUSADA (sem vaga) <- nó %d\n", rel_ms(), m->from);
+    fflush(stdout);
+    ks_cluster_reply(&cluster, m, -1);
+    return;
+  }
+  slot_held[slot] = 1;
+  slot_img[slot] = m->img;
+  ks_cluster_reply(&cluster, m, slot);
+  printf("[KRL %ldms] MIGRAÇÃO RESERVADA <- nó %d | vaga idx=%d %s pc=%d | esperando COMMIT\n",
+         rel_ms(), m->from, slot, m->img.path, m->img.pc);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Decisão da origem sobre uma vaga reservada: COMMIT cria o processo, ABORT a libera.
+ */
+static void migrate_decided(const ks_clmsg *m) {
+  int slot = m->idx;
+  if (slot < 0 || slot >= num_procs || !slot_held[slot]) return;
+  slot_held[slot] = 0;
+  if (m->type == KS_MSG_ABORT) {
+    printf("[KRL %ldms] MIGRAÇÃO CANCELADA <- nó %d | vaga idx=%d livre\n", rel_ms(), m->from, slot);
+    fflush(stdout);
+    return;
+  }
+  const ks_task_image *img = &slot_img[slot];
+  snprintf(app_path_buf[slot], sizeof(app_path_buf[slot]), "%s", img->path);
+  app_path[slot] = app_path_buf[slot];
+  shm->pc[slot] = img->pc;
+  shm->want_io[slot] = img->want_io;
+  shm->io_type[slot] = img->io_type;
+  shm->sys_num[slot] = img->sys_num;
+  memcpy(shm->sys_arg[slot], img->sys_arg, sizeof(img->sys_arg));
+  shm->want_sys[slot] = img->want_sys;
+  shm->chan_in[slot] = shm->chan_out[slot] = -1;
+  shm->thr_n[slot] = 0;
+  if (sched.gang) ks_gang_set_threads(&gang, slot, 1);
+  if (sched.cg) ks_cg_assign(&cgroups, slot, 0);
+  io_stale[slot] = 0;
+  shm->io_blk[slot] = 0;
+  io_pend_blk[slot] = -1;
+  spawn_one(slot);
+  ks_spawn(&sched, slot);
+  // ks_spawn zera a CPU: a tarefa continua com o que já consumiu na origem
+  sched.cpu[slot] = img->cpu;
+  slot_mig_ns[slot] = m->sent_ns;
+  slot_arrived[slot] = sched.now;
+  slot_moved[slot] = -1;
+  printf("[KRL %ldms] MIGRAÇÃO RECEBIDA <- nó %d | idx=%d pid=%d %s pc=%d | PRONTO\n",
+         rel_ms(), m->from, slot, (int)proc_pids[slot], img->path, img->pc);
+  fflush(stdout);
+}
+
+/**
+ * @brief  Trata a decisão da migração pendente: ACK (COMMIT enviado) ou NACK (tarefa fica).
+ */
+static void migrate_done(const ks_clmsg *m) {
+  int idx = m->idx;
+  if (idx < 0 || idx >= num_procs || sched.state[idx] != ST_MIGRATING) return;
+  if (m->type == KS_MSG_NACK) {
+    ks_set_state(&sched, idx, ST_READY);
+    printf("[KRL %ldms] MIGRAÇÃO DESFEITA -> idx=%d pid=%d (nó %d recusou ou não respondeu) | PRONTO\n",
+           rel_ms(), idx, (int)proc_pids[idx], m->from);
+    fflush(stdout);
+    return;
+  }
+  printf("[KRL %ldms] MIGRADA -> idx=%d pid=%d agora no nó %d | vaga livre\n",
+         rel_ms(), idx, (int)proc_pids[idx], m->from);
+  fflush(stdout);
+  kill(proc_pids[idx], SIGKILL);
+  slot_moved[idx] = m->from;
+  shm->want_io[idx] = 0;
+  shm->want_sys[idx] = 0;
+  ks_sync_task_exit(&sync_tab, idx);
+  ks_chan_task_exit(&chans, idx);
+  ks_exit(&sched, idx);
+}
+
+/**
+ * @brief  Processa as mensagens pendentes do cluster.
+ */
+static void cluster_drain(void) {
+  ks_clmsg m;
+  while (ks_cluster_poll(&cluster, &m)) {
+    switch (m.type) {
+      case KS_MSG_MIGRATE: migrate_in(&m); break;
+      case KS_MSG_ACK: case KS_MSG_NACK: migrate_done(&m); break;
+      case KS_MSG_COMMIT: case KS_MSG_ABORT: migrate_decided(&m); break;
+      case KS_MSG_STEAL:
+        if (ks_cluster_accepts_steal(&cluster, m.from)) migrate_out(m.from);
+        break;
+    }
+  }
+}
+
+/**
+ * @brief  A cada IRQ0: publica a carga deste nó e aplica a política de balanceamento.
+ */
+static void cluster_tick(void) {
+  ks_load me;
+  memset(&me, 0, sizeof(me));
+  me.tick = sched.now;
+  me.ready = sched.nready + (sched.rt ? rt_class.nheap : 0);
+  me.running = (sched.current >= 0);
+  for (int i = 0; i < num_procs; i++) {
+    if (sched.state[i] == ST_WAITING) me.backlog++;
+    if (sched.state[i] == ST_DONE && !ks_rt_is(sched.rt, i) && !slot_held[i]) me.free++;
+  }
+  ks_cluster_publish(&cluster, &me);
+
+  int peer = ks_cluster_decide(&cluster);
+  if (peer < 0) return;
+  if (cluster_policy == KS_CL_PUSH) {
+    migrate_out(peer);
+  } else if (ks_cluster_steal(&cluster, peer) == 0) {
+    printf("[KRL %ldms] PEDIDO DE TAREFA (STEAL) -> nó %d\n", rel_ms(), peer);
+    fflush(stdout);
+  }
+}
+
+// ============================================================================
+// Grupos de tarefas (cota de CPU e pesos)
+// ============================================================================
+
+/**
+ * @brief  Cria um grupo a partir de "<nome>:<pai>:<peso>[:<cota>/<período>]".
+ * @param  spec  Declaração do grupo.
+ * @param  where Origem, para a mensagem de erro (opção ou arquivo:linha).
+ * @return 0 em sucesso, -1 se a declaração for inválida.
+ */
+static int cg_define(const char *spec, const char *where) {
+  char name[KS_CG_NAMELEN] = {0}, parent[KS_CG_NAMELEN] = {0};
+  int weight = 0, quota = 0, period = 0;
+  int n = sscanf(spec, "%15[^:]:%15[^:]:%d:%d/%d", name, parent, &weight, &quota, &period);
+  int pid = (n >= 2) ? ks_cg_find(&cgroups, parent) : -1;
+  if ((n != 3 && n != 5) || pid < 0 || ks_cg_add(&cgroups, name, pid, weight, quota, period) < 0) {
+    fprintf(stderr, "[KRL] ERRO: grupo inválido em %s: %s (use <nome>:<pai>:<peso>[:<cota>/<período>],"
+                    " com o pai já declarado e 1 <= cota <= período)\n", where, spec);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @brief  Lê os grupos do arquivo de -g: uma declaração por linha, '#' comenta.
+ * @return 0 em sucesso, -1 se o arquivo não abrir ou tiver declaração inválida.
+ */
+static int cg_load_file(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) { perror("[KRL] ERRO: arquivo de grupos"); return -1; }
+  char line[128], where[96];
+  int ln = 0, rc = 0;
+  while (rc == 0 && fgets(line, sizeof(line), f)) {
+    ln++;
+    char *p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    p[strcspn(p, " \t\r\n#")] = 0;
+    if (!*p) continue;
+    snprintf(where, sizeof(where), "%.80s:%d", path, ln);
+    rc = cg_define(p, where);
+  }
+  fclose(f);
+  return rc;
+}
+
+/**
+ * @brief  Monta a árvore de grupos (-g, depois -G) e põe cada tarefa no grupo de cg=.
+ * @return 0 em sucesso (ou sem grupos), -1 em erro.
+ */
+static int cgroups_setup(void) {
+  bool any = (cg_file != NULL || ncg_spec > 0);
+  for (int i = 0; i < num_procs; i++) if (cg_attr[i]) any = true;
+  if (!any) return 0;
+  if (ks_cg_init(&cgroups, num_procs) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar os grupos de tarefas\n");
+    return -1;
+  }
+  if (cg_file && cg_load_file(cg_file) != 0) return -1;
+  for (int k = 0; k < ncg_spec; k++) if (cg_define(cg_spec[k], "-G") != 0) return -1;
+  for (int i = 0; i < num_procs; i++) {
+    if (!cg_attr[i]) continue;
+    int gid = ks_cg_find(&cgroups, cg_attr[i]);
+    if (gid < 0) {
+      fprintf(stderr, "[KRL] ERRO: cg=%s: grupo não declarado\n", cg_attr[i]);
+      return -1;
+    }
+    // Tempo real tem orçamento próprio (WCET) e fica na raiz
+    if (gid != 0 && ks_rt_is(sched.rt, i)) {
+      fprintf(stderr, "[KRL] ERRO: cg=%s na tarefa idx=%d de tempo real (rt=)\n", cg_attr[i], i);
+      return -1;
+    }
+    ks_cg_assign(&cgroups, i, gid);
+  }
+  ks_set_cgroups(&sched, &cgroups);
+  return 0;
+}
+
+/**
+ * @brief  Lê um atributo de tarefa escrito depois do caminho do app.
+ * @param  idx Índice da tarefa.
+ * @param  tok Atributo (ex.: "rt=5:2:4").
+ * @return 0 em sucesso, -1 se o atributo for desconhecido ou inválido.
+ * @details Atributos:
+ *          rt=T:C[:D]  tarefa de tempo real com período T, WCET C e prazo D (padrão T),
+ *                      em ticks.
+ *          ch=in:out   canais de entrada e saída (um lado vazio = nenhum).
+ *          thr=<n>     tarefa com n threads (2..KS_GANG_MAXTHR), escalonadas em gangue.
+ *          cg=<nome>   grupo da tarefa (declarado com -G ou -g).
+ */
+static int parse_task_attr(int idx, const char *tok) {
+  if (strncmp(tok, "rt=", 3) == 0) {
+    long t = 0, c = 0, d = 0;
+    int n = sscanf(tok + 3, "%ld:%ld:%ld", &t, &c, &d);
+    if (n < 2 || t < 1 || c < 1 || (n == 3 && d < c)) {
+      fprintf(stderr, "[KRL] ERRO: rt= espera T:C[:D] com T,C >= 1 e D >= C (recebido %s)\n", tok);
+      return -1;
+    }
+    rt_param[idx][0] = t;
+    rt_param[idx][1] = c;
+    rt_param[idx][2] = (n == 3) ? d : t;
+    return 0;
+  }
+  if (strncmp(tok, "ch=", 3) == 0) {
+    int in = -1, out = -1;
+    char *end;
+    // ch=in:out, com um dos lados vazio: ch=:0 (só envia), ch=0: (só recebe)
+    const char *p = tok + 3;
+    if (*p != ':') { in = (int)strtol(p, &end, 10); p = end; }
+    if (*p == ':') { p++; if (*p) { out = (int)strtol(p, &end, 10); p = end; } }
+    if (*p || in >= NCHAN || out >= NCHAN || in < -1 || out < -1 || (in < 0 && out < 0)) {
+      fprintf(stderr, "[KRL] ERRO: ch= espera <entrada>:<saída> com canais 0..%d (recebido %s)\n",
+              NCHAN - 1, tok);
+      return -1;
+    }
+    chan_attr[idx][0] = in;
+    chan_attr[idx][1] = out;
+    return 0;
+  }
+  if (strncmp(tok, "thr=", 4) == 0) {
+    char *end;
+    long n = strtol(tok + 4, &end, 10);
+    if (*end || n < 2 || n > KS_GANG_MAXTHR) {
+      fprintf(stderr, "[KRL] ERRO: thr= espera de 2 a %d threads (recebido %s)\n", KS_GANG_MAXTHR, tok);
+      return -1;
+    }
+    thr_attr[idx] = (int)n;
+    return 0;
+  }
+  if (strncmp(tok, "cg=", 3) == 0 && tok[3]) {
+    cg_attr[idx] = tok + 3;
+    return 0;
+  }
+  fprintf(stderr, "[KRL] ERRO: atributo de tarefa inválido: %s\n", tok);
+  return -1;
+}
+
+/**
+ * @brief  Lê blocos "-- <app> [atributos]" da linha de comando e preenche app_path[].
  * @param  argc Número de argumentos.
  * @param  argv Argumentos.
- * @return Quantidade de tarefas (blocos) encontrados.
- * @details Cada ocorrência de "--" seguida de um caminho conta como uma tarefa.
- *          Ex.: ./kernel 1 20 -- ./app_cpu -- ./app_rw
+ * @return Quantidade de tarefas (blocos) encontrados, ou -1 se houver atributo inválido.
+ * @details Cada ocorrência de "--" seguida de um caminho conta como uma tarefa; o que
+ *          vier depois do caminho, até o próximo "--", são atributos da tarefa.
+ *          Ex.: ./kernel 1 20 -- ./app_cpu -- ./app_rt rt=5:2 -- ./app_rw
+ *               ./kernel 1 30 -- ./app_pipe ch=:0 -- ./app_pipe ch=0:1 -- ./app_pipe ch=1:
+ *               ./kernel 1 40 -P 2 -- ./app_mt thr=4 -- ./app_cpu -- ./app_mt thr=2
  */
 static int parse_app_blocks_and_paths(int argc, char **argv) {
   int count = 0;
+  for (int i = 0; i < MAXN; i++) chan_attr[i][0] = chan_attr[i][1] = -1;
   for (int i = 3; i < argc; i++) {
     if (strcmp(argv[i], "--") == 0 && (i + 1) < argc) {
-      if (count < MAXN) {
+      int stored = (count < MAXN);
+      if (stored) {
         app_path[count] = argv[i + 1];
         count++;
       }
       i++; // pula o caminho após "--"
+      while ((i + 1) < argc && strcmp(argv[i + 1], "--") != 0) {
+        i++;
+        if (stored && parse_task_attr(count - 1, argv[i]) != 0) return -1;
+      }
     }
   }
   return count;
 }
 
+/**
+ * @brief  Imprime o relatório de fim de execução (escalonador e contenção por objeto).
+ */
+static void print_report(void) {
+  const ks_stats *st = &sched.stats;
+  printf("[KRL] RELATÓRIO | ticks=%ld despachos=%ld preempções=%ld bloqueios_io=%ld esperas_sync=%ld\n",
+         st->ticks, st->dispatches, st->preemptions, st->blocks, st->parks);
+  printf("[KRL] LATÊNCIA | fila de prontos média=%.2f | após espera (interativas) média=%.2f máx=%ld (ticks)\n",
+         st->ready_n ? (double)st->ready_lat / st->ready_n : 0.0,
+         st->wake_n ? (double)st->wake_lat / st->wake_n : 0.0, st->wake_lat_max);
+  printf("[KRL] PIC linhas=%d | campainhas=%ld atendidas=%ld\n", pic_view.nlines, pic_view.rings, pic_view.wakeups);
+  static const char *line_name[] = { "relógio", "disco" };
+  for (int l = 0; l < pic_view.nlines; l++) {
+    const ks_pic_line *ln = &pic_view.line[l];
+    printf("[KRL] IRQ%d %-7s prio=%d%s | levantadas=%ld fundidas=%ld entregues=%ld pendente=%d"
+           " | latência média=%.3fms máx=%.3fms\n",
+           l, line_name[l], ln->prio, (pic_view.imr >> l) & 1u ? " MASCARADA" : "", ln->raised, ln->merged,
+           ln->delivered, (int)((pic_view.irr >> l) & 1u),
+           ln->delivered ? (double)ln->lat_total_ns / ln->delivered / 1e6 : 0.0, (double)ln->lat_max_ns / 1e6);
+  }
+  if (irq_window > 0 || unblock_min > 0 || unblock_cap > 0) {
+    const ks_irq_stats *q = &irqq.st;
+    printf("[KRL] IRQ1 | términos=%ld coalescidos=%ld em %ld lotes (janela=%ld tamanho=%ld) maior=%ld"
+           " | atraso médio=%.2f máx=%ld ticks\n",
+           st->unblocks, q->irqs, q->flushes, q->by_window, q->by_batch, q->max_batch,
+           q->irqs ? (double)q->delay_total / q->irqs : 0.0, q->delay_max);
+    printf("[KRL] DESBLOQUEIO | tempo mínimo=%d impulsos=%d | preempções=%ld (%.2f por I/O) adiadas=%ld"
+           " sem prioridade=%ld\n",
+           unblock_min, unblock_cap, st->io_preempts,
+           st->unblocks ? (double)st->io_preempts / st->unblocks : 0.0, st->io_deferred, st->io_capped);
+  }
+  if (sched.qt) {
+    printf("[KRL] QUANTUM | modo=%s faixa=%d..%d p%d | amostras=%ld (censuradas=%ld) mudanças=%ld",
+           qtune.mode == KS_Q_TASK ? "tarefa" : "global", qtune.qmin, qtune.qmax, qtune.pct,
+           qtune.samples, qtune.censored, qtune.changes);
+    if (qtune.mode == KS_Q_GLOBAL) printf(" | final=%d\n", qtune.global_q);
+    else printf(" | interativas=%d CPU-bound=%d espera-alvo=%d\n", qtune.n_inter, qtune.n_cpu, qtune.lat);
+  }
+  if (sched.rt) {
+    const ks_rt_stats *r = &rt_class.st;
+    printf("[KRL] EDF | admitidas=%d recusadas=%ld utilização=%.2f limite=%d%% | jobs=%ld concluídos=%ld"
+           " perdas=%ld pulados=%ld estouros=%ld preempções=%ld\n",
+           rt_class.nrt, r->rejected, rt_class.util, rt_class.bound_pct, r->releases, r->completions,
+           r->misses, r->skipped, r->overruns, r->preemptions);
+    static const char *range[KS_RT_HBUCKETS] = { "0", "1", "2-3", "4-7", "8-15", "16-31", "32-63", "64+" };
+    printf("[KRL] EDF FOLGA  (ticks) |");
+    for (int b = 0; b < KS_RT_HBUCKETS; b++) printf(" %s:%ld", range[b], r->slack_hist[b]);
+    printf("\n[KRL] EDF ATRASO (ticks) |");
+    for (int b = 1; b < KS_RT_HBUCKETS; b++) printf(" %s:%ld", range[b], r->late_hist[b]);
+    printf("\n");
+  }
+  if (cluster_node >= 0) {
+    const ks_cluster_stats *c = &cluster.st;
+    static const char *pol[] = { "nenhuma", "push", "pull" };
+    printf("[KRL] CLUSTER nó=%d/%d política=%s limiar=%d | mensagens env=%ld rec=%ld falhas=%ld"
+           " | migrações saída=%ld entrada=%ld recusadas=%ld/%ld expiradas=%ld ACKs tardios=%ld"
+           " reservas canceladas=%ld steals=%ld/%ld\n",
+           cluster.self, cluster.nnodes, pol[cluster.policy], cluster.threshold,
+           c->sent, c->received, c->send_errors, c->mig_out, c->mig_in, c->nacks, c->refused,
+           c->timeouts, c->late_acks, c->aborted, c->steals_sent, c->steals_recv);
+    printf("[KRL] CUSTO DE MIGRAÇÃO | ida e volta média=%.3fms máx=%.3fms (%ld) | indisponibilidade média=%.1fms máx=%.1fms (%ld)\n",
+           c->mig_out ? (double)c->rtt_total_ns / c->mig_out / 1e6 : 0.0, (double)c->rtt_max_ns / 1e6, c->mig_out,
+           c->down_n ? (double)c->down_total_ns / c->down_n / 1e6 : 0.0, (double)c->down_max_ns / 1e6, c->down_n);
+  }
+  if (power_gov >= 0) {
+    const ks_power_stats *w = &power.st;
+    long jobs = 0, job_ms = 0;
+    for (int i = 0; i < num_procs; i++) { jobs += task_jobs[i]; job_ms += task_job_ms[i]; }
+    double e = ks_power_energy(&power);
+    printf("[KRL] ENERGIA governador=%s C-state máximo=%s | total=%.0f mJ (ativa=%.0f ociosa=%.0f saídas=%.0f)"
+           " | jobs=%ld energia/job=%.0f mJ\n",
+           gov_name[power.gov], ks_cstates[power.cmax].name, e, w->e_active, w->e_idle, w->e_exit,
+           jobs, jobs ? e / jobs : 0.0);
+    printf("[KRL] CUSTO EM LATÊNCIA | job médio=%.0f ms | saídas de C-state=%ld total=%ld ms"
+           " | previsões de ocioso erradas=%ld | trocas de frequência=%ld\n",
+           jobs ? (double)job_ms / jobs : 0.0, w->exits, w->exit_ms, w->mispredicts, w->transitions);
+    printf("[KRL] DVFS (ticks ocupados) |");
+    for (int l = 0; l < KS_PW_LEVELS; l++) printf(" %d%%:%ld", ks_pstates[l].freq_pct, w->level_ticks[l]);
+    printf(" | OCIOSO (ticks/entradas) |");
+    for (int c = 0; c < KS_PW_CSTATES; c++) printf(" %s:%ld/%ld", ks_cstates[c].name, w->cstate_ticks[c], w->cstate_entries[c]);
+    printf("\n");
+  }
+  if (sched.gang) {
+    const ks_gang_stats *g = &gang.st;
+    long cap = g->ticks * gang.ncpu;
+    printf("[KRL] GANGUE cpus=%d justiça=%s | utilização=%.0f%% | CPU-ticks ocupados=%ld ociosos=%ld"
+           " perdidos em futex/fim=%ld | rodízios=%ld threads em futex puladas=%ld\n",
+           gang.ncpu, gang.fair == KS_GANG_FAIR_THREAD ? "thread" : "grupo",
+           cap ? 100.0 * g->busy / cap : 0.0, g->busy, g->idle, g->parked, g->rotations, g->futex_skips);
+    for (int i = 0; i < num_procs; i++) {
+      if (proc_pids[i] <= 0 || slot_moved[i] >= 0) continue;
+      const ks_group *gp = &gang.grp[i];
+      printf("[KRL] GRUPO idx=%d threads=%d | ticks=%ld CPU-ticks=%ld (%.0f%% do ocupado)",
+             i, gp->nthr, gp->ticks, gp->cpu_ticks, g->busy ? 100.0 * gp->cpu_ticks / g->busy : 0.0);
+      if (gp->nthr > 1) {
+        printf(" | todas juntas=%.0f%% dos ticks | por thread:", gp->ticks ? 100.0 * gp->cosched / gp->ticks : 0.0);
+        for (int t = 0; t < gp->nthr; t++) printf(" t%d=%ld", t, gp->thr_ticks[t]);
+      }
+      printf("\n");
+    }
+  }
+  if (sched.cg) {
+    long limited = 0;
+    for (int id = 1; id < cgroups.ngroups; id++) limited += cgroups.g[id].nr_throttled;
+    printf("[KRL] CGROUPS grupos=%d | limitações=%ld | preempções por cota=%ld"
+           " | CPU ociosa com tarefas prontas retidas=%ld ticks\n",
+           cgroups.ngroups - 1, limited, st->cg_preempts, st->cg_idle);
+    for (int id = 0; id < cgroups.ngroups; id++) {
+      const ks_cgroup *g = &cgroups.g[id];
+      // Limitado até o fim: conta também o trecho ainda aberto
+      long lim = g->throttled_ticks + (g->throttled ? sched.now - g->throttled_at : 0);
+      printf("[KRL] CGROUP %s", g->name);
+      if (g->parent >= 0) printf(" pai=%s peso=%d", cgroups.g[g->parent].name, g->weight);
+      if (g->quota > 0) printf(" cota=%d/%d", g->quota, g->period);
+      printf(" | uso=%ld ticks (%.0f%% da CPU)", g->usage, st->ticks ? 100.0 * g->usage / st->ticks : 0.0);
+      if (g->quota > 0)
+        printf(" | períodos=%ld limitados=%ld (%.0f%%) ticks limitado=%ld", g->periods, g->nr_throttled,
+               g->periods ? 100.0 * g->nr_throttled / g->periods : 0.0, lim);
+      printf(" | tarefas:");
+      for (int i = 0; i < num_procs; i++) if (proc_pids[i] > 0 && cgroups.grp[i] == id) printf(" %d", i);
+      printf("\n");
+    }
+  }
+  if (bc_cap > 0) {
+    const ks_bcache_stats *b = &bcache.st;
+    long dev = b->flushes;
+    for (int i = 0; i < num_procs; i++) dev += task_io_dev[i];
+    long buffered = b->writes - b->write_through;
+    printf("[KRL] CACHE política=%s blocos=%d | READ acertos=%ld/%ld (%.0f%%) | WRITE no cache=%ld/%ld"
+           " (sobre bloco já sujo=%ld) write-through=%ld | descartes=%ld acertos fantasmas=%ld",
+           bcache.policy == KS_BC_ARC ? "ARC" : "LRU", bcache.cap, b->read_hits, b->reads,
+           b->reads ? 100.0 * b->read_hits / b->reads : 0.0, buffered, b->writes, b->write_absorbed,
+           b->write_through, b->evictions, b->ghost_hits);
+    if (bcache.policy == KS_BC_ARC) printf(" p=%d", bcache.p);
+    printf("\n");
+    printf("[KRL] FLUSHER lotes=%ld blocos=%ld (%.1f por lote) | latência média=%.2f máx=%ld ticks"
+            " | sujo até gravar média=%.2f máx=%ld ticks | não gravados no fim=%d\n",
+           b->flushes, b->flushed, b->flushes ? (double)b->flushed / b->flushes : 0.0,
+           b->flushes ? (double)b->flush_lat / b->flushes : 0.0, b->flush_lat_max,
+           b->flushed ? (double)b->dirty_age / b->flushed : 0.0, b->dirty_age_max,
+           bcache.ndirty + bcache.nflushing);
+    printf("[KRL] DISPOSITIVO pedidos=%ld (tarefas=%ld flusher=%ld) | evitados pelo cache=%ld\n",
+           dev, dev - b->flushes, b->flushes, b->read_hits + buffered - b->flushes);
+  }
+  for (int i = 0; i < num_procs; i++) {
+    if (proc_pids[i] <= 0) continue;   // vaga nunca usada (cluster)
+    printf("[KRL] TAREFA idx=%d pid=%d | cpu=%ld ticks", i, (int)proc_pids[i], sched.cpu[i]);
+    if (power_gov >= 0) {
+      printf(" | energia=%.0f mJ", power.task_mj[i]);
+      if (task_jobs[i] > 0) printf(" jobs=%ld (%.0f mJ/job, %.0f ms/job)", task_jobs[i],
+                                   power.task_mj[i] / task_jobs[i], (double)task_job_ms[i] / task_jobs[i]);
+    }
+    if (bc_cap > 0) printf(" | I/O cache=%ld dispositivo=%ld", task_io_cache[i], task_io_dev[i]);
+    if (ks_rt_is(sched.rt, i)) {
+      const ks_rt_task *t = &rt_class.t[i];
+      printf(" | RT T=%ld C=%ld D=%ld | jobs=%ld perdas=%ld estouros=%ld atraso máx=%ld"
+             " | resposta média=%.2f máx=%ld\n",
+             t->period, t->wcet, t->deadline, t->jobs, t->misses, t->overruns, t->late_max,
+             t->jobs ? (double)t->resp_total / t->jobs : 0.0, t->resp_max);
+      continue;
+    }
+    if (slot_moved[i] >= 0) { printf(" | migrou para o nó %d\n", slot_moved[i]); continue; }
+    printf(" | quantum=%d", ks_slice_for(&sched, i));
+    if (sched.qt && qtune.mode == KS_Q_TASK) printf(" | rajada EMA=%.2f desvio=%.2f", qtune.ema[i], qtune.dev[i]);
+    printf("\n");
+  }
+  static const char *kind_name[] = { "-", "MUTEX", "SEM", "COND" };
+  for (int id = 0; id < sync_tab.nobj; id++) {
+    const ks_syncobj *o = &sync_tab.obj[id];
+    if (o->kind == KS_SYNC_FREE) continue;
+    const ks_lock_stats *l = &o->st;
+    printf("[KRL] SYNC obj=%d %-5s | aquisições=%ld contenção=%ld max_fila=%d"
+           " | posse média=%.2f máx=%ld | espera média=%.2f | handoff n=%ld média=%.2f máx=%ld (ticks)\n",
+           id, kind_name[o->kind], l->acquires, l->contended, l->max_waiters,
+           l->releases ? (double)l->hold_total / l->releases : 0.0, l->hold_max,
+           l->handoffs ? (double)l->wait_total / l->handoffs : 0.0,
+           l->handoff_samples,
+           l->handoff_samples ? (double)l->handoff_total / l->handoff_samples : 0.0, l->handoff_max);
+  }
+  for (int ch = 0; ch < chans.nchan; ch++) {
+    const ks_chan_stats *c = &chans.ch[ch].st;
+    if (c->sent == 0 && c->recv_blocks == 0) continue;
+    printf("[KRL] CANAL ch=%d | msgs=%ld recebidas=%ld bytes=%ld vazão=%.2f msgs/tick"
+           " | latência média=%.2f máx=%ld ticks | maior fila=%d | esperas recv=%ld buffer=%ld entregas diretas=%ld\n",
+           ch, c->sent, c->received, c->bytes, st->ticks ? (double)c->received / st->ticks : 0.0,
+           c->received ? (double)c->lat_total / c->received : 0.0, c->lat_max, c->max_depth,
+           c->recv_blocks, c->alloc_blocks, c->handoffs);
+  }
+  fflush(stdout);
+}
+
+/**
+ * @brief  Lê as opções entre <duracao_s> e o primeiro bloco "--".
+ * @param  argc Número de argumentos.
+ * @param  argv Argumentos.
+ * @return 0 em sucesso, -1 se houver opção inválida.
+ * @details Opções:
+ *          -t <ticks>      prazo de espera por I/O (timed-wait); 0 desativa.
+ *          -S <id>:<valor> cria o semáforo `id` com valor inicial (padrão: 1 no primeiro uso).
+ *          -A <g|t>:<qmin>:<qmax>:<pct>  quantum automático global (g) ou por tarefa (t),
+ *                          em [qmin, qmax], mirando pct% das rajadas dentro de um quantum.
+ *          -R <pct>        limite de utilização da classe de tempo real (padrão 95).
+ *          -I <janela>[:<lote>]  coalescência de IRQ1: desbloqueios em lote a cada `janela`
+ *                          ticks ou ao juntar `lote` términos (padrão 0 = na hora).
+ *          -U <mínimo>[:<impulsos>]  preempção no desbloqueio só depois de a corrente rodar
+ *                          `mínimo` ticks; no máximo `impulsos` seguidos por tarefa (0 = livre).
+ *          -D              quando a corrente bloqueia, dorme ou termina, o próximo IRQ0 já
+ *                          despacha outra pronta (padrão: a CPU espera o fim do quantum).
+ *          -P <cpus>[:<g|t>]  CPUs simuladas para as threads das tarefas (thr=) e
+ *                          justiça entre grupos: g = mesmo quantum por tarefa (padrão),
+ *                          t = quantum proporcional às threads.
+ *          -F <governador>[:<cmax>]  modelo de energia: governador de frequência
+ *                          (performance, powersave, ondemand, schedutil) e C-state mais
+ *                          profundo permitido (0..3, padrão 3).
+ *          -G <nome>:<pai>:<peso>[:<cota>/<período>]  grupo de tarefas filho de `pai`
+ *                          ("root" = raiz), com peso entre os irmãos e, opcionalmente,
+ *                          `cota` ticks de CPU a cada `período` ticks. Pode repetir.
+ *          -g <arquivo>    grupos lidos de um arquivo (uma declaração como a de -G por
+ *                          linha, '#' comenta), criados antes dos de -G.
+ *          -K <blocos>[:<lru|arc>][:<intervalo>]  cache de `blocos` blocos na frente do
+ *                          dispositivo, com substituição LRU (padrão) ou ARC; o flusher
+ *                          grava os sujos a cada `intervalo` ticks (padrão 3) ou quando
+ *                          metade do cache está suja.
+ *          -Q <linha>:<prioridade>[:m]  prioridade da linha de IRQ no PIC (0 = mais alta;
+ *                          padrão: o número da linha, relógio 0 e disco 1) e, com `m`,
+ *                          linha mascarada desde a partida. Pode repetir.
+ *          -C <id>:<n>     nó `id` de um cluster de `n` instâncias (sockets em /tmp).
+ *          -B <none|push|pull>[:<limiar>]  política de balanceamento do cluster
+ *                          (padrão none; limiar = diferença mínima de carga, padrão 2).
+ */
+static int parse_options(int argc, char **argv) {
+  for (int i = 0; i < NSYNC; i++) sem_init_val[i] = -1;
+  for (int l = 0; l < KS_PIC_LINES; l++) pic_prio[l] = -1;
+  for (int i = 3; i < argc && strcmp(argv[i], "--") != 0; i++) {
+    if (strcmp(argv[i], "-t") == 0 && (i + 1) < argc) {
+      io_timeout_ticks = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-S") == 0 && (i + 1) < argc) {
+      int id = -1, val = 0;
+      if (sscanf(argv[++i], "%d:%d", &id, &val) != 2 || id < 0 || id >= NSYNC || val < 0) {
+        fprintf(stderr, "[KRL] ERRO: -S espera <id>:<valor> com id em 0..%d\n", NSYNC - 1);
+        return -1;
+      }
+      sem_init_val[id] = val;
+    } else if (strcmp(argv[i], "-A") == 0 && (i + 1) < argc) {
+      char m = 0;
+      if (sscanf(argv[++i], "%c:%d:%d:%d", &m, &qtune_min, &qtune_max, &qtune_pct) != 4 ||
+          (m != 'g' && m != 't') || qtune_min < 1 || qtune_max < qtune_min ||
+          qtune_pct < 1 || qtune_pct > 99) {
+        fprintf(stderr, "[KRL] ERRO: -A espera <g|t>:<qmin>:<qmax>:<pct> (ex.: g:1:8:90)\n");
+        return -1;
+      }
+      qtune_mode = (m == 'g') ? KS_Q_GLOBAL : KS_Q_TASK;
+    } else if (strcmp(argv[i], "-I") == 0 && (i + 1) < argc) {
+      int n = sscanf(argv[++i], "%d:%d", &irq_window, &irq_batch);
+      if (n < 1 || irq_window < 0 || irq_batch < 0) {
+        fprintf(stderr, "[KRL] ERRO: -I espera <janela>[:<lote>] em ticks (ex.: 2:4)\n");
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-U") == 0 && (i + 1) < argc) {
+      int n = sscanf(argv[++i], "%d:%d", &unblock_min, &unblock_cap);
+      if (n < 1 || unblock_min < 0 || unblock_cap < 0) {
+        fprintf(stderr, "[KRL] ERRO: -U espera <mínimo>[:<impulsos>] (ex.: 1:2)\n");
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-D") == 0) {
+      idle_dispatch = 1;
+    } else if (strcmp(argv[i], "-P") == 0 && (i + 1) < argc) {
+      char m = 'g';
+      int n = sscanf(argv[++i], "%d:%c", &gang_cpus, &m);
+      if (n < 1 || gang_cpus < 1 || gang_cpus > KS_GANG_MAXCPU || (m != 'g' && m != 't')) {
+        fprintf(stderr, "[KRL] ERRO: -P espera <cpus>[:<g|t>] com 1 <= cpus <= %d (ex.: 2:t)\n", KS_GANG_MAXCPU);
+        return -1;
+      }
+      gang_fair = (m == 't') ? KS_GANG_FAIR_THREAD : KS_GANG_FAIR_GROUP;
+    } else if (strcmp(argv[i], "-F") == 0 && (i + 1) < argc) {
+      char gov[16] = {0};
+      int n = sscanf(argv[++i], "%15[a-z]:%d", gov, &power_cmax);
+      power_gov = -1;
+      for (int g = 0; g < 4; g++) if (strcmp(gov, gov_name[g]) == 0) power_gov = g;
+      if (n < 1 || power_gov < 0 || power_cmax < 0 || power_cmax >= KS_PW_CSTATES) {
+        fprintf(stderr, "[KRL] ERRO: -F espera <performance|powersave|ondemand|schedutil>[:<cmax 0..%d>]\n",
+                KS_PW_CSTATES - 1);
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-G") == 0 && (i + 1) < argc) {
+      if (ncg_spec >= KS_CG_MAX - 1) {
+        fprintf(stderr, "[KRL] ERRO: no máximo %d grupos com -G\n", KS_CG_MAX - 1);
+        return -1;
+      }
+      cg_spec[ncg_spec++] = argv[++i];
+    } else if (strcmp(argv[i], "-g") == 0 && (i + 1) < argc) {
+      cg_file = argv[++i];
+    } else if (strcmp(argv[i], "-K") == 0 && (i + 1) < argc) {
+      char pol[8] = "lru";
+      int n = sscanf(argv[++i], "%d:%7[a-z]:%d", &bc_cap, pol, &bc_interval);
+      if      (strcmp(pol, "lru") == 0) bc_policy = KS_BC_LRU;
+      else if (strcmp(pol, "arc") == 0) bc_policy = KS_BC_ARC;
+      else n = 0;
+      if (n < 1 || bc_cap < 1 || bc_cap > KS_BC_MAXCAP || bc_interval < 1) {
+        fprintf(stderr, "[KRL] ERRO: -K espera <blocos>[:<lru|arc>][:<intervalo>] com 1 <= blocos <= %d (ex.: 8:arc:3)\n",
+                KS_BC_MAXCAP);
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-Q") == 0 && (i + 1) < argc) {
+      int line = -1, prio = -1;
+      char m = 0;
+      int n = sscanf(argv[++i], "%d:%d:%c", &line, &prio, &m);
+      if (n < 2 || line < 0 || line > KS_IRQ_DISK || prio < 0 || (n == 3 && m != 'm')) {
+        fprintf(stderr, "[KRL] ERRO: -Q espera <linha>:<prioridade>[:m] com linha 0 (relógio) ou 1 (disco) (ex.: 1:0)\n");
+        return -1;
+      }
+      pic_prio[line] = prio;
+      if (n == 3) pic_masked |= 1u << line;
+    } else if (strcmp(argv[i], "-C") == 0 && (i + 1) < argc) {
+      if (sscanf(argv[++i], "%d:%d", &cluster_node, &cluster_nodes) != 2 || cluster_nodes < 2 ||
+          cluster_nodes > KS_CL_MAXNODES || cluster_node < 0 || cluster_node >= cluster_nodes) {
+        fprintf(stderr, "[KRL] ERRO: -C espera <id>:<n> com 2 <= n <= %d e 0 <= id < n\n", KS_CL_MAXNODES);
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-B") == 0 && (i + 1) < argc) {
+      char pol[8] = {0};
+      int n = sscanf(argv[++i], "%7[a-z]:%d", pol, &cluster_threshold);
+      if (n < 1 || cluster_threshold < 1) pol[0] = 0;
+      if      (strcmp(pol, "none") == 0) cluster_policy = KS_CL_NONE;
+      else if (strcmp(pol, "push") == 0) cluster_policy = KS_CL_PUSH;
+      else if (strcmp(pol, "pull") == 0) cluster_policy = KS_CL_PULL;
+      else {
+        fprintf(stderr, "[KRL] ERRO: -B espera <none|push|pull>[:<limiar>] (ex.: push:2)\n");
+        return -1;
+      }
+    } else if (strcmp(argv[i], "-R") == 0 && (i + 1) < argc) {
+      rt_bound_pct = atoi(argv[++i]);
+      if (rt_bound_pct < 1 || rt_bound_pct > 100) {
+        fprintf(stderr, "[KRL] ERRO: -R espera um limite entre 1 e 100 (%%)\n");
+        return -1;
+      }
+    } else {
+      fprintf(stderr, "[KRL] ERRO: opção inválida: %s\n", argv[i]);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+// ============================================================================
+// Tratadores de interrupção
+// ============================================================================
+
+/**
+ * @brief  IRQ0 (relógio): contabiliza o tick, atende a syscall ou o pedido de I/O da
+ *         corrente e faz o rodízio.
+ */
+static void irq0_handler(void) {
+  // Tick que terminou: quem estava nas CPUs simuladas
+  if (sched.gang) ks_gang_account(&gang, sched.current, sched.current >= 0 ? shm->thr_state[sched.current] : NULL);
+  if (power_gov >= 0) power_tick();
+
+  // Relógio e temporizadores primeiro: as syscalls deste IRQ0 já veem o tick novo
+  ks_clock_tick(&sched);
+
+  if (sched.current >= 0) {
+    int idx = sched.current;
+    if (shm->want_sys[idx]) {
+      handle_syscall(idx);
+    } else if (shm->want_io[idx]) {
+      int iot = shm->io_type[idx];
+      shm->want_io[idx] = 0;
+      io_request(idx, iot);
+    }
+  }
+
+  // Metade de baixo do IRQ1 antes do rodízio, para entrar na decisão deste tick
+  if (ks_irq_due(&irqq, sched.now)) io_bottom_half();
+  flusher_tick();
+
+  ks_slice_tick(&sched);
+  gang_run(sched.current);   // rodízio das threads do grupo que fica com as CPUs
+
+  if (cluster_node >= 0) { cluster_drain(); cluster_tick(); }
+}
+
+/**
+ * @brief  IRQ1 (disco): término do I/O escrito pelo InterController na SHM.
+ */
+static void irq1_handler(void) {
+  pid_t donep = shm->io_done_pid;
+  int   dtype = shm->io_done_type;
+  int idx = idx_of_pid(donep);
+  if (bc_cap > 0 && donep == self_pid) {
+    flush_done(sched.now);
+  } else if (idx >= 0 && io_stale[idx] > 0) {
+    io_stale[idx]--;
+    printf("[KRL %ldms] IRQ1 tardio descartado (I/O %s) -> idx=%d pid=%d\n",
+           rel_ms(), dtype==0?"READ":"WRITE", idx, (int)donep);
+    fflush(stdout);
+  } else if (idx < 0 || irq_window == 0 || ks_irq_push(&irqq, idx, dtype, sched.now) != 0) {
+    int cur = sched.current;
+    ks_stats st = sched.stats;
+    if (ks_io_complete(&sched, idx, dtype)) io_priority_log(cur, &st);
+  } else {
+    printf("[KRL %ldms] IRQ1 (I/O %s) -> idx=%d pid=%d | ADIADO (%d no lote)\n",
+           rel_ms(), dtype==0?"READ":"WRITE", idx, (int)donep, irqq.n);
+    fflush(stdout);
+    if (ks_irq_due(&irqq, sched.now)) io_bottom_half();
+  }
+  shm->io_done_pid = 0;
+  shm->io_done_type = 0;
+}
+
 // ============================================================================
 // Função principal
 // ============================================================================
@@ -334,111 +1683,234 @@ int main(int argc, char **argv) {
   time_slice_seconds   = (argc > 1) ? atoi(argv[1]) : 1;
   run_duration_seconds = (argc > 2) ? atoi(argv[2]) : 15;
 
+  if (parse_options(argc, argv) != 0) return 2;
+
   // Lê os executáveis por tarefa (se fornecidos)
   int blocks = parse_app_blocks_and_paths(argc, argv);
-  if (blocks <= 0) {
-    fprintf(stderr, "[KRL] ERRO: uso: ./kernel <q> <dur> -- <app1> [-- <app2>] ...\n");
+  if (blocks < 0) return 2;
+  if (blocks == 0 && cluster_node < 0) {
+    fprintf(stderr, "[KRL] ERRO: uso: ./kernel <q> <dur> [-t <ticks>] [-S <id>:<v>] [-A <g|t>:<min>:<max>:<pct>] [-R <pct>]"
+                    " [-I <janela>[:<lote>]] [-U <mínimo>[:<impulsos>]] [-D] [-P <cpus>[:<g|t>]] [-F <governador>[:<cmax>]] [-G <nome>:<pai>:<peso>[:<cota>/<período>]] [-g <arquivo>] [-K <blocos>[:<lru|arc>][:<intervalo>]] [-Q <linha>:<prio>[:m]] [-C <id>:<n>] [-B <none|push|pull>[:<limiar>]]"
+                    " -- <app1> [rt=T:C[:D]] [ch=<in>:<out>] [thr=<n>] [cg=<grupo>] [-- <app2>] ...\n");
     fprintf(stderr, "Ex.: ./kernel 1 20 -- ./app_cpu -- ./app_rw -- ./app_cpu\n");
     return 2;
   }
-  if (blocks < MINN || blocks > MAXN) {
+  // Um nó do cluster pode começar com menos tarefas (ou nenhuma) e receber por migração
+  if ((cluster_node < 0 && blocks < MINN) || blocks > MAXN) {
     fprintf(stderr, "[KRL] ERRO: número de apps deve ser entre %d e %d (recebido %d)\n",
             MINN, MAXN, blocks);
     return 2;
   }
-  num_procs = blocks;
+  num_initial = blocks;
+  num_procs = (cluster_node >= 0) ? MAXN : blocks;
+  if (cluster_node >= 0) {
+    snprintf(fifo_path, sizeof(fifo_path), "%s.node%d", FIFO_PATH, cluster_node);
+    if (ks_cluster_open(&cluster, CLUSTER_PREFIX, cluster_node, cluster_nodes,
+                        cluster_policy, cluster_threshold) != 0) {
+      perror("[KRL] ERRO: socket do cluster");
+      return 1;
+    }
+  }
+
+  if (ks_init(&sched, num_procs, time_slice_seconds, &krl_ops, NULL) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar o escalonador\n");
+    return 1;
+  }
+  sched.io_timeout = io_timeout_ticks;
+  ks_set_unblock_policy(&sched, unblock_min, unblock_cap);
+  ks_set_idle_dispatch(&sched, idle_dispatch);
+  if (ks_irq_init(&irqq, num_procs, irq_window, irq_batch) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar a fila de IRQ1\n");
+    return 1;
+  }
+  if (qtune_mode != KS_Q_FIXED) {
+    if (ks_qtune_init(&qtune, num_procs, qtune_mode, qtune_min, qtune_max, qtune_pct,
+                      time_slice_seconds) != 0) {
+      fprintf(stderr, "[KRL] ERRO: falha ao inicializar o quantum automático\n");
+      return 1;
+    }
+    ks_set_qtune(&sched, &qtune);
+  }
+  bool any_rt = false;
+  for (int i = 0; i < num_procs; i++) if (rt_param[i][0] > 0) any_rt = true;
+  if (any_rt) {
+    if (ks_rt_init(&rt_class, num_procs, rt_bound_pct) != 0) {
+      fprintf(stderr, "[KRL] ERRO: falha ao inicializar a classe de tempo real\n");
+      return 1;
+    }
+    ks_set_rt(&sched, &rt_class);
+    for (int i = 0; i < num_procs; i++) {
+      if (rt_param[i][0] <= 0) continue;
+      int r = ks_rt_admit(&rt_class, i, rt_param[i][0], rt_param[i][1], rt_param[i][2]);
+      printf("[KRL] ADMISSÃO RT idx=%d T=%ld C=%ld D=%ld -> %s | utilização=%.2f limite=%d%%\n",
+             i, rt_param[i][0], rt_param[i][1], rt_param[i][2],
+             r == 0 ? "ACEITA" : "RECUSADA (roda como melhor esforço)", rt_class.util, rt_bound_pct);
+    }
+    fflush(stdout);
+  }
+  bool any_thr = (gang_cpus > 1);
+  for (int i = 0; i < num_procs; i++) if (thr_attr[i] > 1) any_thr = true;
+  if (any_thr) {
+    if (ks_gang_init(&gang, num_procs, gang_cpus, gang_fair) != 0) {
+      fprintf(stderr, "[KRL] ERRO: falha ao inicializar as threads das tarefas\n");
+      return 1;
+    }
+    for (int i = 0; i < num_procs; i++) if (thr_attr[i] > 1) ks_gang_set_threads(&gang, i, thr_attr[i]);
+    ks_set_gang(&sched, &gang);
+  }
+  if (cgroups_setup() != 0) return 2;
+  for (int i = 0; i < MAXN; i++) io_pend_blk[i] = -1;
+  if (bc_cap > 0 && ks_bc_init(&bcache, bc_cap, bc_policy) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar o cache de blocos\n");
+    return 1;
+  }
+  if (ks_sync_init(&sync_tab, &sched, NSYNC) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar os objetos de sincronização\n");
+    return 1;
+  }
+  for (int i = 0; i < NSYNC; i++)
+    if (sem_init_val[i] >= 0) ks_sync_create(&sync_tab, i, KS_SYNC_SEM, sem_init_val[i]);
 
   shared_memory_init(num_procs);
+  if (ks_chan_init(&chans, &sched, NCHAN, chan_seg) != 0) {
+    fprintf(stderr, "[KRL] ERRO: falha ao inicializar os canais\n");
+    return 1;
+  }
+  if (power_gov >= 0) {
+    if (ks_power_init(&power, num_procs, power_gov, power_cmax) != 0) {
+      fprintf(stderr, "[KRL] ERRO: falha ao inicializar o modelo de energia\n");
+      return 1;
+    }
+    shm->cpu_freq = ks_power_freq(&power);
+  }
   fifo_make_only();
   install_handlers();
+  // Campainha e SIGIO só são entregues dentro do sigsuspend de wait_irq()
+  sigset_t irq_sigs;
+  sigemptyset(&irq_sigs);
+  sigaddset(&irq_sigs, SIGUSR1);
+  sigaddset(&irq_sigs, SIGIO);
+  sigprocmask(SIG_BLOCK, &irq_sigs, &irq_wait_mask);
+  if (cluster_node >= 0) {
+    // Cada datagrama que chega gera SIGIO, que acorda o sigsuspend de wait_irq()
+    fcntl(cluster.fd, F_SETOWN, self_pid);
+    fcntl(cluster.fd, F_SETFL, fcntl(cluster.fd, F_GETFL) | O_ASYNC);
+  }
   spawn_inter_controller();
   fifo_open_writer_blocking();
   spawn_apps();
 
   printf("[KRL %ldms] INÍCIO | RR+I/O | quantum=%ds | duração=%ds | procs=%d\n",
-         rel_ms(), time_slice_seconds, run_duration_seconds, num_procs);
+         rel_ms(), time_slice_seconds, run_duration_seconds, num_initial);
+  if (cluster_node >= 0) {
+    static const char *pol[] = { "nenhuma", "push", "pull" };
+    printf("[KRL %ldms] CLUSTER | nó=%d de %d | política=%s limiar=%d | vagas=%d\n",
+           rel_ms(), cluster_node, cluster_nodes, pol[cluster_policy], cluster_threshold, num_procs);
+  }
+  if (power_gov >= 0) {
+    printf("[KRL %ldms] ENERGIA | governador=%s | C-state máximo=%s | frequência=%d%%\n",
+           rel_ms(), gov_name[power_gov], ks_cstates[power_cmax].name, shm->cpu_freq);
+  }
+  for (int id = 1; sched.cg && id < cgroups.ngroups; id++) {
+    const ks_cgroup *g = &cgroups.g[id];
+    printf("[KRL %ldms] CGROUP %s | pai=%s peso=%d", rel_ms(), g->name, cgroups.g[g->parent].name, g->weight);
+    if (g->quota > 0) printf(" cota=%d/%d ticks", g->quota, g->period);
+    printf(" | tarefas:");
+    for (int i = 0; i < num_procs; i++) if (cgroups.grp[i] == id) printf(" %d", i);
+    printf("\n");
+  }
+  if (pic_masked || pic_prio[KS_IRQ_TIMER] >= 0 || pic_prio[KS_IRQ_DISK] >= 0) {
+    printf("[KRL %ldms] PIC |", rel_ms());
+    for (int l = 0; l < shm->pic.nlines; l++)
+      printf(" IRQ%d prio=%d%s", l, shm->pic.line[l].prio, (shm->pic.imr >> l) & 1u ? " (mascarada)" : "");
+    printf("\n");
+  }
+  if (bc_cap > 0) {
+    printf("[KRL %ldms] CACHE | blocos=%d | política=%s | flusher a cada %d ticks ou com metade suja\n",
+           rel_ms(), bc_cap, bc_policy == KS_BC_ARC ? "ARC" : "LRU", bc_interval);
+  }
+  if (sched.gang) {
+    printf("[KRL %ldms] GANGUE | cpus=%d | justiça=%s\n",
+           rel_ms(), gang_cpus, gang_fair == KS_GANG_FAIR_THREAD ? "por thread" : "por grupo");
+  }
+  if (sched.qt) {
+    printf("[KRL %ldms] QUANTUM AUTOMÁTICO | modo=%s | faixa=%d..%d ticks | alvo=p%d\n",
+           rel_ms(), qtune_mode == KS_Q_TASK ? "tarefa" : "global", qtune_min, qtune_max, qtune_pct);
+  }
   fflush(stdout);
 
-  int first = pick_next_ready();
-  if (first >= 0) { dispatch_index(first); time_slice_left = time_slice_seconds; }
+  ks_start(&sched);
 
   time_t t0 = time(NULL);
+  // O prazo acorda o laço mesmo sem campainha (ex.: relógio mascarado com -Q)
+  alarm((unsigned)run_duration_seconds);
 
   while (true) {
     if (stop_flag) break;
     if (time(NULL) - t0 >= run_duration_seconds) break;
 
-    pause();
+    wait_irq();
 
-    if (got_irq0) {
-      got_irq0 = 0;
-
-      if (current_idx >= 0) {
-        int idx = current_idx;
-        if (shm->want_io[idx]) {
-          int iot = shm->io_type[idx];
-          shm->want_io[idx] = 0;
-          block_running_for_io(iot);
-        }
-      }
-
-      if (time_slice_left > 0) time_slice_left--;
-      if (time_slice_left == 0) {
-        int prev = current_idx;
-        if (current_idx >= 0) preempt_running_to_ready();
-        if (prev >= 0) current_idx = prev;
-        int nxt = pick_next_ready();
-        if (nxt >= 0) {
-          dispatch_index(nxt);
-          time_slice_left = time_slice_seconds;
-        } else {
-          current_idx = -1;
-        }
-      }
+    got_doorbell = 0;
+    // Linhas pendentes em ordem de prioridade; as que chegam no meio entram na volta
+    int line, n = 0;
+    while ((line = ks_pic_ack(&shm->pic, now_ns())) >= 0) {
+      n++;
+      if (line == KS_IRQ_TIMER) irq0_handler();
+      else if (line == KS_IRQ_DISK) irq1_handler();
     }
+    if (n > 0) shm->pic.wakeups++;
 
-    if (got_irq1) {
-      got_irq1 = 0;
-      pid_t donep = shm->io_done_pid;
-      int   dtype = shm->io_done_type;
-      int idx = idx_of_pid(donep);
-
-      if (idx >= 0 && proc_state[idx] == ST_WAITING) {
-        printf("[KRL %ldms] DESBLOQUEIO (IRQ1 I/O %s) -> idx=%d pid=%d | PRIORIDADE\n",
-               rel_ms(), dtype==0?"READ":"WRITE", idx, (int)donep);
-        fflush(stdout);
-        if (current_idx >= 0) preempt_running_to_ready();
-        set_state(idx, ST_READY);
-        dispatch_index(idx);
-        time_slice_left = time_slice_seconds;
-      }
-      shm->io_done_pid = 0;
-      shm->io_done_type = 0;
+    if (got_net) {
+      got_net = 0;
+      if (cluster_node >= 0) cluster_drain();
     }
 
     int status; pid_t z;
     while ((z = waitpid(-1, &status, WNOHANG)) > 0) {
       int idx = idx_of_pid(z);
-      if (idx >= 0) set_state(idx, ST_DONE);
+      if (idx >= 0) { ks_sync_task_exit(&sync_tab, idx); ks_chan_task_exit(&chans, idx); ks_exit(&sched, idx); }
     }
 
-    int alive = 0;
-    for (int i = 0; i < num_procs; i++) if (proc_state[i] != ST_DONE) alive++;
-    if (alive == 0) break;
+    power_idle();
+
+    // No cluster o nó fica de pé até o fim do prazo: pode receber tarefas
+    if (cluster_node < 0 && ks_alive(&sched) == 0) break;
   }
 
-  for (int i = 0; i < num_procs; i++) if (proc_state[i] != ST_DONE) kill(proc_pids[i], SIGKILL);
-  for (int i = 0; i < num_procs; i++) waitpid(proc_pids[i], NULL, 0);
+  for (int i = 0; i < num_procs; i++) if (proc_pids[i] > 0 && sched.state[i] != ST_DONE) kill(proc_pids[i], SIGKILL);
+  for (int i = 0; i < num_procs; i++) if (proc_pids[i] > 0) waitpid(proc_pids[i], NULL, 0);
+  flush_at_exit();
 
   if (inter_controller_pid > 0) kill(inter_controller_pid, SIGTERM);
-  if (fifo_fd >= 0) { close(fifo_fd); fifo_fd = -1; unlink(FIFO_PATH); }
+  if (fifo_fd >= 0) { close(fifo_fd); fifo_fd = -1; unlink(fifo_path); }
+  if (cluster_node >= 0) ks_cluster_close(&cluster);
 
   if (shm) {
+    for (int i = 0; i < num_procs; i++) { task_jobs[i] = shm->jobs[i]; task_job_ms[i] = shm->job_ms[i]; }
+    pic_view = shm->pic;
     shm->done = 1;
     shmdt((void*)shm);
     shmctl(shm_id, IPC_RMID, NULL);
     shm = NULL; shm_id = -1;
   }
+  if (chan_seg) {
+    shmdt(chan_seg);
+    shmctl(chan_seg_id, IPC_RMID, NULL);
+    chan_seg = NULL; chan_seg_id = -1;
+  }
+
+  print_report();
+  ks_sync_destroy(&sync_tab);
+  ks_chan_destroy(&chans);
+  if (sched.qt) ks_qtune_destroy(&qtune);
+  if (sched.rt) ks_rt_destroy(&rt_class);
+  if (power_gov >= 0) ks_power_destroy(&power);
+  if (sched.gang) ks_gang_destroy(&gang);
+  if (sched.cg) ks_cg_destroy(&cgroups);
+  if (bc_cap > 0) ks_bc_destroy(&bcache);
+  ks_irq_destroy(&irqq);
+  ks_destroy(&sched);
 
   printf("[KRL %ldms] FIM do Kernel\n", rel_ms());
   return 0;
@@ -0,0 +1,296 @@
+/**
+ * @file    ks_bcache.c
+ * @brief   Implementação do cache de blocos com LRU/ARC e write-back em lote (libkernelsim).
+ * @details As entradas (residentes e fantasmas) ficam num vetor de 2 * cap posições,
+ *          ligadas em listas por índice e achadas por um hash com encadeamento. O ARC
+ *          segue o algoritmo original, com uma diferença: a vítima de REPLACE é o bloco
+ *          limpo mais antigo da lista escolhida (ou da outra, se ela só tiver sujos),
+ *          pois um bloco sujo não pode sair antes de ser gravado.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_bcache.h"
+
+// ============================================================================
+// Hash e listas
+// ============================================================================
+
+static int hslot(const ks_bcache *b, int blk) { return (int)((unsigned)blk % (unsigned)b->nbucket); }
+
+static int lookup(const ks_bcache *b, int blk) {
+  for (int e = b->bucket[hslot(b, blk)]; e >= 0; e = b->buf[e].hnext)
+    if (b->buf[e].blk == blk) return e;
+  return -1;
+}
+
+static int resident(const ks_bcache *b, int e) {
+  return e >= 0 && (b->buf[e].list == KS_BC_T1 || b->buf[e].list == KS_BC_T2);
+}
+
+static void lst_del(ks_bcache *b, int e) {
+  ks_bcbuf *x = &b->buf[e];
+  ks_bclist *L = &b->l[x->list];
+  if (x->prev >= 0) b->buf[x->prev].next = x->next; else L->head = x->next;
+  if (x->next >= 0) b->buf[x->next].prev = x->prev; else L->tail = x->prev;
+  L->n--;
+  x->list = -1;
+}
+
+/**
+ * @brief  Põe a entrada na ponta mais recente da lista.
+ */
+static void lst_push(ks_bcache *b, int list, int e) {
+  ks_bcbuf *x = &b->buf[e];
+  ks_bclist *L = &b->l[list];
+  x->list = list;
+  x->prev = -1;
+  x->next = L->head;
+  if (L->head >= 0) b->buf[L->head].prev = e; else L->tail = e;
+  L->head = e;
+  L->n++;
+}
+
+static void move_to(ks_bcache *b, int e, int list) {
+  lst_del(b, e);
+  lst_push(b, list, e);
+}
+
+/**
+ * @brief  Tira uma entrada livre e a registra no hash para `blk`.
+ */
+static int entry_new(ks_bcache *b, int blk) {
+  int e = b->free_head;
+  if (e < 0) return -1;
+  ks_bcbuf *x = &b->buf[e];
+  b->free_head = x->next;
+  memset(x, 0, sizeof(*x));
+  x->blk = blk;
+  x->list = -1;
+  x->redirty_at = -1;
+  int h = hslot(b, blk);
+  x->hnext = b->bucket[h];
+  b->bucket[h] = e;
+  return e;
+}
+
+static void entry_free(ks_bcache *b, int e) {
+  ks_bcbuf *x = &b->buf[e];
+  int *pp = &b->bucket[hslot(b, x->blk)];
+  while (*pp != e) pp = &b->buf[*pp].hnext;
+  *pp = x->hnext;
+  if (x->list >= 0) lst_del(b, e);
+  x->next = b->free_head;
+  b->free_head = e;
+}
+
+// ============================================================================
+// Substituição
+// ============================================================================
+
+/**
+ * @brief  Bloco limpo usado há mais tempo na lista residente `list`, ou -1.
+ */
+static int victim(const ks_bcache *b, int list) {
+  for (int e = b->l[list].tail; e >= 0; e = b->buf[e].prev)
+    if (!b->buf[e].dirty) return e;
+  return -1;
+}
+
+/**
+ * @brief  Acerto num bloco residente: vira o mais recente (ARC: passa a T2).
+ */
+static void touch(ks_bcache *b, int e) {
+  move_to(b, e, b->policy == KS_BC_ARC ? KS_BC_T2 : KS_BC_T1);
+}
+
+/**
+ * @brief  REPLACE do ARC: descarta um residente limpo para a lista fantasma dele.
+ * @param  in_b2 A falta que pede a vaga acertou B2.
+ */
+static int arc_replace(ks_bcache *b, int in_b2) {
+  int t1 = b->l[KS_BC_T1].n;
+  int first = (t1 > 0 && (t1 > b->p || (in_b2 && t1 == b->p))) ? KS_BC_T1 : KS_BC_T2;
+  int e = victim(b, first);
+  if (e < 0) e = victim(b, first == KS_BC_T1 ? KS_BC_T2 : KS_BC_T1);
+  if (e < 0) return -1;
+  move_to(b, e, b->buf[e].list == KS_BC_T1 ? KS_BC_B1 : KS_BC_B2);
+  b->st.evictions++;
+  return 0;
+}
+
+/**
+ * @brief  Falta no ARC: ajusta `p` (acerto fantasma) ou apara as listas e admite `blk`.
+ */
+static int arc_admit(ks_bcache *b, int blk) {
+  int res = b->l[KS_BC_T1].n + b->l[KS_BC_T2].n;
+  int b1 = b->l[KS_BC_B1].n, b2 = b->l[KS_BC_B2].n;
+  int g = lookup(b, blk);
+  if (g >= 0) {
+    int in_b1 = (b->buf[g].list == KS_BC_B1);
+    if (in_b1) { int d = b2 / b1; b->p += (d > 1) ? d : 1; if (b->p > b->cap) b->p = b->cap; }
+    else       { int d = b1 / b2; b->p -= (d > 1) ? d : 1; if (b->p < 0) b->p = 0; }
+    if (res >= b->cap && arc_replace(b, !in_b1) != 0) return -1;
+    move_to(b, g, KS_BC_T2);
+    b->st.ghost_hits++;
+    return g;
+  }
+  if (b->l[KS_BC_T1].n + b1 >= b->cap) {
+    if (b->l[KS_BC_T1].n < b->cap) {
+      entry_free(b, b->l[KS_BC_B1].tail);
+      if (res >= b->cap && arc_replace(b, 0) != 0) return -1;
+    } else {
+      int e = victim(b, KS_BC_T1);
+      if (e < 0) return -1;
+      entry_free(b, e);
+      b->st.evictions++;
+    }
+  } else if (res + b1 + b2 >= b->cap) {
+    if (res + b1 + b2 >= 2 * b->cap) entry_free(b, b->l[KS_BC_B2].tail);
+    if (res >= b->cap && arc_replace(b, 0) != 0) return -1;
+  }
+  int e = entry_new(b, blk);
+  if (e >= 0) lst_push(b, KS_BC_T1, e);
+  return e;
+}
+
+/**
+ * @brief  Admite `blk` (não residente) como o mais recente, abrindo vaga se preciso.
+ * @return Entrada do bloco, ou -1 se não houver vítima limpa.
+ */
+static int admit(ks_bcache *b, int blk) {
+  if (b->policy == KS_BC_ARC) return arc_admit(b, blk);
+  if (b->l[KS_BC_T1].n >= b->cap) {
+    int v = victim(b, KS_BC_T1);
+    if (v < 0) return -1;
+    entry_free(b, v);
+    b->st.evictions++;
+  }
+  int e = entry_new(b, blk);
+  if (e >= 0) lst_push(b, KS_BC_T1, e);
+  return e;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+int ks_bc_init(ks_bcache *b, int cap, int policy) {
+  if (!b || cap < 1 || cap > KS_BC_MAXCAP || (policy != KS_BC_LRU && policy != KS_BC_ARC)) return -1;
+  memset(b, 0, sizeof(*b));
+  b->nbuf = 2 * cap;
+  b->nbucket = 2 * cap;
+  b->buf = (ks_bcbuf*)calloc((size_t)b->nbuf, sizeof(ks_bcbuf));
+  b->bucket = (int*)malloc((size_t)b->nbucket * sizeof(int));
+  if (!b->buf || !b->bucket) { ks_bc_destroy(b); return -1; }
+  b->cap = cap;
+  b->policy = policy;
+  for (int h = 0; h < b->nbucket; h++) b->bucket[h] = -1;
+  for (int k = 0; k < 4; k++) b->l[k].head = b->l[k].tail = -1;
+  for (int e = 0; e < b->nbuf; e++) { b->buf[e].list = -1; b->buf[e].next = (e + 1 < b->nbuf) ? e + 1 : -1; }
+  b->free_head = 0;
+  return 0;
+}
+
+void ks_bc_destroy(ks_bcache *b) {
+  if (!b) return;
+  free(b->buf);    b->buf = NULL;
+  free(b->bucket); b->bucket = NULL;
+  b->nbuf = b->nbucket = b->cap = 0;
+}
+
+int ks_bc_read(ks_bcache *b, int blk) {
+  b->st.reads++;
+  int e = lookup(b, blk);
+  if (!resident(b, e)) return 0;
+  touch(b, e);
+  b->st.read_hits++;
+  return 1;
+}
+
+int ks_bc_fill(ks_bcache *b, int blk, long now) {
+  (void)now;
+  int e = lookup(b, blk);
+  // Escrito ou lido por outra tarefa enquanto esta esperava o dispositivo
+  if (resident(b, e)) { touch(b, e); return 0; }
+  if (admit(b, blk) < 0) return -1;
+  b->st.fills++;
+  return 0;
+}
+
+int ks_bc_write(ks_bcache *b, int blk, long now) {
+  b->st.writes++;
+  int e = lookup(b, blk);
+  if (resident(b, e)) touch(b, e);
+  else if ((e = admit(b, blk)) < 0) { b->st.write_through++; return 0; }
+  ks_bcbuf *x = &b->buf[e];
+  if (x->flushing) {
+    // O lote em voo leva a versão antiga: o bloco volta a ficar sujo quando ele terminar
+    if (x->redirty_at >= 0) b->st.write_absorbed++; else x->redirty_at = now;
+    return 1;
+  }
+  if (x->dirty) { b->st.write_absorbed++; return 1; }
+  x->dirty = 1;
+  x->dirty_since = now;
+  b->ndirty++;
+  return 1;
+}
+
+int ks_bc_flush_begin(ks_bcache *b, long now, int max) {
+  if (b->nflushing > 0 || b->ndirty == 0 || max < 1) return 0;
+  int n = 0;
+  if (max >= b->ndirty) {
+    // Cabem todos: uma passada só
+    for (int e = 0; e < b->nbuf; e++)
+      if (b->buf[e].dirty && !b->buf[e].flushing) { b->buf[e].flushing = 1; n++; }
+    b->ndirty = 0;
+  }
+  while (n < max && b->ndirty > 0) {
+    int best = -1;
+    for (int e = 0; e < b->nbuf; e++) {
+      const ks_bcbuf *x = &b->buf[e];
+      if (!x->dirty || x->flushing) continue;
+      if (best < 0 || x->dirty_since < b->buf[best].dirty_since) best = e;
+    }
+    b->buf[best].flushing = 1;
+    b->ndirty--;
+    n++;
+  }
+  b->nflushing = n;
+  b->flush_at = now;
+  return n;
+}
+
+int ks_bc_flush_end(ks_bcache *b, long now) {
+  if (b->nflushing == 0) return 0;
+  int n = 0;
+  for (int e = 0; e < b->nbuf; e++) {
+    ks_bcbuf *x = &b->buf[e];
+    if (!x->flushing) continue;
+    x->flushing = 0;
+    n++;
+    long age = now - x->dirty_since;
+    b->st.dirty_age += age;
+    if (age > b->st.dirty_age_max) b->st.dirty_age_max = age;
+    if (x->redirty_at >= 0) {
+      x->dirty_since = x->redirty_at;
+      x->redirty_at = -1;
+      b->ndirty++;
+    } else {
+      x->dirty = 0;
+    }
+  }
+  long lat = now - b->flush_at;
+  b->st.flushes++;
+  b->st.flushed += n;
+  b->st.flush_lat += lat;
+  if (lat > b->st.flush_lat_max) b->st.flush_lat_max = lat;
+  b->nflushing = 0;
+  return n;
+}
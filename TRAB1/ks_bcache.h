@@ -0,0 +1,142 @@
+/**
+ * @file    ks_bcache.h
+ * @brief   Cache de blocos na frente do dispositivo de I/O, com write-back em lote
+ *          (libkernelsim).
+ * @details Guarda até `cap` blocos. Um READ de bloco em cache termina na hora, sem
+ *          bloquear a tarefa; numa falta a tarefa bloqueia no dispositivo e o bloco
+ *          entra no cache quando o IRQ1 chega (ks_bc_fill). Um WRITE só suja o bloco
+ *          no cache e também não bloqueia; os sujos vão ao dispositivo em lote, num
+ *          único pedido, pelo flusher (ks_bc_flush_begin/ks_bc_flush_end).
+ *
+ *          Um bloco sujo (ou no lote em voo) não pode ser descartado: se todos os
+ *          candidatos a vítima estiverem sujos, o WRITE vai direto ao dispositivo
+ *          (write-through) e o READ não entra no cache.
+ *
+ *          Substituição:
+ *          - LRU: descarta o bloco limpo usado há mais tempo;
+ *          - ARC (Megiddo e Modha): duas listas residentes, T1 (vistos uma vez) e T2
+ *            (vistos de novo), e duas listas fantasmas com os descartados de cada uma
+ *            (B1, B2, só o número do bloco). Uma falta que acerta B1 aumenta o alvo
+ *            `p` do tamanho de T1 (recência); uma que acerta B2, diminui (frequência).
+ *            Uma varredura passa só por T1 e não expulsa os blocos quentes de T2.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_BCACHE_H
+#define KS_BCACHE_H
+
+#define KS_BC_MAXCAP 256   /**< Capacidade máxima (blocos) */
+
+enum { KS_BC_LRU=0, KS_BC_ARC };                    /**< Política de substituição */
+enum { KS_BC_T1=0, KS_BC_T2, KS_BC_B1, KS_BC_B2 };  /**< Listas (LRU usa só T1) */
+
+/**
+ * @struct ks_bcbuf
+ * @brief  Entrada do cache: bloco residente (T1/T2) ou fantasma (B1/B2).
+ */
+typedef struct ks_bcbuf {
+  int  blk;          /**< Número do bloco */
+  int  list;         /**< KS_BC_T1..KS_BC_B2, -1 = livre */
+  int  prev, next;   /**< Vizinhos na lista (-1 = ponta); head = mais recente */
+  int  hnext;        /**< Próxima entrada no mesmo balde do hash */
+  int  dirty;        /**< Escrito e ainda não gravado */
+  int  flushing;     /**< No lote em voo */
+  long dirty_since;  /**< Tick da primeira escrita não gravada */
+  long redirty_at;   /**< Tick da escrita feita com o lote em voo (-1 = nenhuma) */
+} ks_bcbuf;
+
+/**
+ * @struct ks_bclist
+ * @brief  Lista duplamente ligada de entradas (índices em `buf`).
+ */
+typedef struct ks_bclist {
+  int head, tail, n;
+} ks_bclist;
+
+/**
+ * @struct ks_bcache_stats
+ * @brief  Métricas do cache e do flusher.
+ */
+typedef struct ks_bcache_stats {
+  long reads;           /**< READs consultados */
+  long read_hits;       /**< READs atendidos pelo cache */
+  long fills;           /**< Blocos lidos do dispositivo que entraram no cache */
+  long writes;          /**< WRITEs */
+  long write_absorbed;  /**< WRITEs sobre bloco já sujo (um só gravado no lote) */
+  long write_through;   /**< WRITEs sem vaga (todos sujos): direto ao dispositivo */
+  long evictions;       /**< Blocos descartados */
+  long ghost_hits;      /**< Faltas que acertaram B1/B2 (ARC) */
+  long flushes;         /**< Lotes gravados */
+  long flushed;         /**< Blocos gravados */
+  long flush_lat;       /**< Soma das latências dos lotes (pedido -> IRQ1, ticks) */
+  long flush_lat_max;
+  long dirty_age;       /**< Soma dos tempos sujo -> gravado (ticks) */
+  long dirty_age_max;
+} ks_bcache_stats;
+
+/**
+ * @struct ks_bcache
+ * @brief  Estado do cache.
+ */
+typedef struct ks_bcache {
+  int        policy;        /**< KS_BC_LRU ou KS_BC_ARC */
+  int        cap;           /**< Blocos residentes */
+  int        p;             /**< Alvo do tamanho de T1 (ARC) */
+  int        nbuf;          /**< Entradas (residentes + fantasmas = 2 * cap) */
+  ks_bcbuf  *buf;
+  int       *bucket;        /**< Hash bloco -> primeira entrada do balde */
+  int        nbucket;
+  ks_bclist  l[4];
+  int        free_head;     /**< Entradas livres (encadeadas por next) */
+  int        ndirty;        /**< Blocos sujos fora do lote em voo */
+  int        nflushing;     /**< Blocos no lote em voo */
+  long       flush_at;      /**< Tick do pedido do lote em voo */
+  ks_bcache_stats st;
+} ks_bcache;
+
+/**
+ * @brief  Cria o cache vazio.
+ * @return 0 em sucesso, -1 em parâmetro inválido ou falha de alocação.
+ */
+int  ks_bc_init(ks_bcache *b, int cap, int policy);
+
+/**
+ * @brief  Libera a memória.
+ */
+void ks_bc_destroy(ks_bcache *b);
+
+/**
+ * @brief  READ do bloco `blk`.
+ * @return 1 se o bloco está em cache (atendido), 0 se precisa ir ao dispositivo.
+ */
+int  ks_bc_read(ks_bcache *b, int blk);
+
+/**
+ * @brief  O dispositivo entregou o bloco `blk` lido numa falta: põe-no no cache (limpo).
+ * @return 0 em sucesso, -1 se não houve vaga (todos os candidatos sujos).
+ */
+int  ks_bc_fill(ks_bcache *b, int blk, long now);
+
+/**
+ * @brief  WRITE do bloco `blk`: suja-o no cache.
+ * @return 1 se o cache absorveu a escrita, 0 se ela precisa ir ao dispositivo.
+ */
+int  ks_bc_write(ks_bcache *b, int blk, long now);
+
+/**
+ * @brief  Põe até `max` blocos sujos (os mais antigos) num lote para o dispositivo.
+ * @return Blocos no lote (0 = nada a gravar ou já há um lote em voo).
+ */
+int  ks_bc_flush_begin(ks_bcache *b, long now, int max);
+
+/**
+ * @brief  O lote em voo foi gravado: seus blocos ficam limpos (salvo os reescritos).
+ * @return Blocos gravados.
+ */
+int  ks_bc_flush_end(ks_bcache *b, long now);
+
+#endif /* KS_BCACHE_H */
@@ -0,0 +1,168 @@
+/**
+ * @file    ks_cgroup.c
+ * @brief   Implementação dos grupos de tarefas com cota de CPU e pesos hierárquicos
+ *          (libkernelsim).
+ * @details Um grupo sempre é criado depois do pai, então o id do pai é menor que o do
+ *          filho: percorrer os ids em ordem decrescente visita os filhos antes dos pais
+ *          (soma das subárvores) e em ordem crescente os pais antes dos filhos (frações).
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_cgroup.h"
+
+int ks_cg_init(ks_cgroups *c, int ntasks) {
+  if (!c || ntasks <= 0) return -1;
+  memset(c, 0, sizeof(*c));
+  c->grp  = (int*)calloc((size_t)ntasks, sizeof(int));
+  c->live = (char*)calloc((size_t)ntasks, sizeof(char));
+  c->mult = (int*)calloc((size_t)ntasks, sizeof(int));
+  if (!c->grp || !c->live || !c->mult) { ks_cg_destroy(c); return -1; }
+  c->ntasks = ntasks;
+  for (int i = 0; i < ntasks; i++) c->live[i] = 1;
+  ks_cgroup *r = &c->g[0];
+  strcpy(r->name, "root");
+  r->parent = -1;
+  r->weight = KS_CG_WEIGHT;
+  c->ngroups = 1;
+  c->dirty = 1;
+  return 0;
+}
+
+void ks_cg_destroy(ks_cgroups *c) {
+  if (!c) return;
+  free(c->grp);  c->grp = NULL;
+  free(c->live); c->live = NULL;
+  free(c->mult); c->mult = NULL;
+  c->ntasks = 0;
+  c->ngroups = 0;
+}
+
+int ks_cg_add(ks_cgroups *c, const char *name, int parent, int weight, int quota, int period) {
+  if (!name || !*name || strlen(name) >= KS_CG_NAMELEN || ks_cg_find(c, name) >= 0) return -1;
+  if (c->ngroups >= KS_CG_MAX || parent < 0 || parent >= c->ngroups || weight < 1) return -1;
+  if (quota < 0 || (quota > 0 && (period < 1 || quota > period))) return -1;
+  int id = c->ngroups++;
+  ks_cgroup *g = &c->g[id];
+  memset(g, 0, sizeof(*g));
+  strcpy(g->name, name);
+  g->parent = parent;
+  g->weight = weight;
+  g->quota = quota;
+  g->period = (quota > 0) ? period : 0;
+  g->next_refill = g->period;
+  c->dirty = 1;
+  return id;
+}
+
+int ks_cg_find(const ks_cgroups *c, const char *name) {
+  for (int id = 0; id < c->ngroups; id++)
+    if (strcmp(c->g[id].name, name) == 0) return id;
+  return -1;
+}
+
+int ks_cg_assign(ks_cgroups *c, int idx, int gid) {
+  if (idx < 0 || idx >= c->ntasks || gid < 0 || gid >= c->ngroups) return -1;
+  c->grp[idx] = gid;
+  c->dirty = 1;
+  return 0;
+}
+
+void ks_cg_set_live(ks_cgroups *c, int idx, int live) {
+  if (idx < 0 || idx >= c->ntasks || c->live[idx] == (live != 0)) return;
+  c->live[idx] = (live != 0);
+  c->dirty = 1;
+}
+
+uint32_t ks_cg_charge(ks_cgroups *c, int idx, long now) {
+  uint32_t hit = 0;
+  if (idx < 0 || idx >= c->ntasks) return 0;
+  for (int id = c->grp[idx]; id >= 0; id = c->g[id].parent) {
+    ks_cgroup *g = &c->g[id];
+    g->usage++;
+    g->used++;
+    // A cota esgotada no último tick do período não limita: o período vira agora
+    if (g->quota > 0 && !g->throttled && g->used >= g->quota && now < g->next_refill) {
+      g->throttled = 1;
+      g->throttled_at = now;
+      g->nr_throttled++;
+      hit |= 1u << id;
+    }
+  }
+  return hit;
+}
+
+uint32_t ks_cg_refill(ks_cgroups *c, long now) {
+  uint32_t freed = 0;
+  for (int id = 1; id < c->ngroups; id++) {
+    ks_cgroup *g = &c->g[id];
+    if (g->quota <= 0 || now < g->next_refill) continue;
+    while (g->next_refill <= now) { g->next_refill += g->period; g->periods++; }
+    g->used = 0;
+    if (!g->throttled) continue;
+    g->throttled = 0;
+    g->throttled_ticks += now - g->throttled_at;
+    freed |= 1u << id;
+  }
+  return freed;
+}
+
+int ks_cg_held(const ks_cgroups *c, int idx) {
+  if (idx < 0 || idx >= c->ntasks) return 0;
+  for (int id = c->grp[idx]; id >= 0; id = c->g[id].parent)
+    if (c->g[id].throttled) return 1;
+  return 0;
+}
+
+/**
+ * @brief  Recalcula as frações da CPU dos grupos e os multiplicadores das tarefas.
+ */
+static void recompute(ks_cgroups *c) {
+  for (int id = 0; id < c->ngroups; id++) c->g[id].nlive = c->g[id].sub = 0;
+  for (int i = 0; i < c->ntasks; i++) if (c->live[i]) c->g[c->grp[i]].nlive++;
+  for (int id = c->ngroups - 1; id >= 0; id--) {
+    ks_cgroup *g = &c->g[id];
+    g->sub += g->nlive;
+    if (g->parent >= 0) c->g[g->parent].sub += g->sub;
+  }
+
+  // Soma dos pesos dos filhos ativos de cada grupo (tarefas diretas inclusive)
+  long sum[KS_CG_MAX];
+  for (int id = 0; id < c->ngroups; id++) sum[id] = (long)c->g[id].nlive * KS_CG_WEIGHT;
+  for (int id = 1; id < c->ngroups; id++)
+    if (c->g[id].sub > 0) sum[c->g[id].parent] += c->g[id].weight;
+
+  c->g[0].share = 1.0;
+  for (int id = 1; id < c->ngroups; id++) {
+    ks_cgroup *g = &c->g[id];
+    long s = sum[g->parent];
+    g->share = (g->sub > 0 && s > 0) ? c->g[g->parent].share * g->weight / s : 0.0;
+  }
+
+  double min = 0.0;
+  for (int i = 0; i < c->ntasks; i++) {
+    if (!c->live[i]) continue;
+    int id = c->grp[i];
+    double s = c->g[id].share * KS_CG_WEIGHT / sum[id];
+    if (min == 0.0 || s < min) min = s;
+  }
+  for (int i = 0; i < c->ntasks; i++) {
+    int id = c->grp[i];
+    int m = 1;
+    if (c->live[i] && min > 0.0) m = (int)(c->g[id].share * KS_CG_WEIGHT / sum[id] / min + 0.5);
+    c->mult[i] = (m < 1) ? 1 : (m > KS_CG_MAXMULT) ? KS_CG_MAXMULT : m;
+  }
+  c->dirty = 0;
+}
+
+int ks_cg_weight(ks_cgroups *c, int idx) {
+  if (idx < 0 || idx >= c->ntasks) return 1;
+  if (c->dirty) recompute(c);
+  return c->mult[idx];
+}
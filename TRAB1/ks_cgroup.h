@@ -0,0 +1,135 @@
+/**
+ * @file    ks_cgroup.h
+ * @brief   Grupos de tarefas com controle de banda de CPU (cota/período) e pesos
+ *          hierárquicos (libkernelsim).
+ * @details Os grupos formam uma árvore com raiz "root" (id 0); cada tarefa de melhor
+ *          esforço pertence a um grupo (a raiz, se nenhum for dado).
+ *
+ *          Cota: um grupo com cota Q e período P pode usar Q ticks de CPU a cada P
+ *          ticks, somando todas as tarefas da sua subárvore. Cada tick de CPU é cobrado
+ *          do grupo da tarefa e de todos os ancestrais; o grupo que esgota a cota fica
+ *          limitado, e nenhuma tarefa da subárvore roda até a virada do período dele
+ *          (múltiplos de P), quando o uso zera. A cota de um filho nunca passa da do
+ *          pai, pois o pai também é cobrado.
+ *
+ *          Peso: sob disputa, a CPU de um grupo se divide entre os filhos ativos (com
+ *          tarefas vivas na subárvore) na proporção dos pesos; uma tarefa direta do
+ *          grupo conta como um filho de peso KS_CG_WEIGHT. Como o RR dá uma vez a cada
+ *          tarefa por rodada, a fatia vira quantum: o quantum de cada tarefa é
+ *          multiplicado pela sua fração da CPU dividida pela menor fração entre as
+ *          tarefas vivas (limitado a KS_CG_MAXMULT).
+ *
+ *          Este módulo guarda a árvore, o uso e as métricas; quem tira as tarefas
+ *          limitadas da fila de prontos é ks_sched.c.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_CGROUP_H
+#define KS_CGROUP_H
+
+#include <stdint.h>
+
+#define KS_CG_MAX      16    /**< Grupos, contando a raiz */
+#define KS_CG_NAMELEN  16
+#define KS_CG_WEIGHT   100   /**< Peso padrão de um grupo e peso de uma tarefa */
+#define KS_CG_MAXMULT  8     /**< Maior multiplicador do quantum */
+
+/**
+ * @struct ks_cgroup
+ * @brief  Um grupo: posição na árvore, cota e métricas.
+ */
+typedef struct ks_cgroup {
+  char name[KS_CG_NAMELEN];
+  int  parent;           /**< Grupo pai (-1 = raiz) */
+  int  weight;           /**< Peso entre os irmãos */
+  int  quota;            /**< Ticks por período (0 = sem limite) */
+  int  period;           /**< Período da cota (ticks) */
+  int  used;             /**< Uso no período corrente */
+  long next_refill;      /**< Tick da próxima virada de período */
+  int  throttled;        /**< 1 = cota esgotada até a virada */
+  long throttled_at;     /**< Tick em que foi limitado */
+  int  nlive;            /**< Tarefas vivas diretamente no grupo */
+  int  sub;              /**< Tarefas vivas na subárvore */
+  double share;          /**< Fração da CPU sob disputa (0..1) */
+  long usage;            /**< CPU total (ticks) */
+  long periods;          /**< Períodos encerrados */
+  long nr_throttled;     /**< Períodos em que a cota esgotou */
+  long throttled_ticks;  /**< Ticks limitado */
+} ks_cgroup;
+
+/**
+ * @struct ks_cgroups
+ * @brief  Árvore de grupos e grupo de cada tarefa.
+ */
+typedef struct ks_cgroups {
+  int       ngroups;
+  ks_cgroup g[KS_CG_MAX];
+  int       ntasks;
+  int      *grp;     /**< Grupo de cada tarefa */
+  char     *live;    /**< 1 se a tarefa não terminou */
+  int      *mult;    /**< Multiplicador do quantum de cada tarefa */
+  int       dirty;   /**< Frações e multiplicadores a recalcular */
+} ks_cgroups;
+
+/**
+ * @brief  Cria a raiz, sem cota, com as `ntasks` tarefas vivas nela.
+ * @return 0 em sucesso, -1 em parâmetro inválido ou falha de alocação.
+ */
+int  ks_cg_init(ks_cgroups *c, int ntasks);
+
+/**
+ * @brief  Libera a memória.
+ */
+void ks_cg_destroy(ks_cgroups *c);
+
+/**
+ * @brief  Cria um grupo filho de `parent`.
+ * @param  weight Peso (>= 1).
+ * @param  quota  Ticks por período (0 = sem limite; senão 1..period).
+ * @return Id do grupo, ou -1 (nome repetido ou vazio, pai inexistente, limite, parâmetro).
+ */
+int  ks_cg_add(ks_cgroups *c, const char *name, int parent, int weight, int quota, int period);
+
+/**
+ * @brief  Id do grupo com o nome dado, ou -1.
+ */
+int  ks_cg_find(const ks_cgroups *c, const char *name);
+
+/**
+ * @brief  Move a tarefa `idx` para o grupo `gid`.
+ * @return 0 em sucesso, -1 em parâmetro inválido.
+ */
+int  ks_cg_assign(ks_cgroups *c, int idx, int gid);
+
+/**
+ * @brief  Marca a tarefa como viva (1) ou terminada (0); só as vivas dividem a CPU.
+ */
+void ks_cg_set_live(ks_cgroups *c, int idx, int live);
+
+/**
+ * @brief  Cobra um tick de CPU da tarefa `idx` do grupo dela e dos ancestrais.
+ * @return Bits (1 << gid) dos grupos que esgotaram a cota agora.
+ */
+uint32_t ks_cg_charge(ks_cgroups *c, int idx, long now);
+
+/**
+ * @brief  Vira os períodos vencidos em `now`: zera o uso e libera os grupos limitados.
+ * @return Bits (1 << gid) dos grupos liberados.
+ */
+uint32_t ks_cg_refill(ks_cgroups *c, long now);
+
+/**
+ * @brief  1 se a tarefa está num grupo limitado (ou com ancestral limitado).
+ */
+int  ks_cg_held(const ks_cgroups *c, int idx);
+
+/**
+ * @brief  Multiplicador do quantum da tarefa `idx` pelos pesos (1..KS_CG_MAXMULT).
+ */
+int  ks_cg_weight(ks_cgroups *c, int idx);
+
+#endif /* KS_CGROUP_H */
@@ -0,0 +1,225 @@
+/**
+ * @file    ks_chan.c
+ * @brief   Implementação dos canais de mensagens sem cópia (libkernelsim).
+ * @details Como em ks_sync.c, as filas de espera são listas encadeadas por índice de
+ *          tarefa (`next`): uma tarefa espera em no máximo uma fila por vez. A fila de
+ *          descritores e a pilha de buffers livres têm KS_CHAN_SLOTS posições, então
+ *          nunca transbordam.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_chan.h"
+
+// ============================================================================
+// Filas de espera
+// ============================================================================
+
+static void wq_push(ks_chan *c, int *head, int *tail, int ch, int idx) {
+  c->next[idx] = -1;
+  if (*tail < 0) *head = idx; else c->next[*tail] = idx;
+  *tail = idx;
+  c->waiting_on[idx] = ch;
+}
+
+static int wq_pop(ks_chan *c, int *head, int *tail) {
+  int idx = *head;
+  if (idx < 0) return -1;
+  *head = c->next[idx];
+  if (*head < 0) *tail = -1;
+  c->next[idx] = -1;
+  c->waiting_on[idx] = -1;
+  return idx;
+}
+
+/**
+ * @brief  Tira `idx` da fila, se estiver nela.
+ * @return 1 se tirou; 0 se não estava (os elos de `idx` não são tocados, pois podem
+ *         ser os da outra fila do mesmo canal).
+ */
+static int wq_remove(ks_chan *c, int *head, int *tail, int idx) {
+  int prev = -1;
+  for (int i = *head; i >= 0; prev = i, i = c->next[i]) {
+    if (i != idx) continue;
+    if (prev < 0) *head = c->next[i]; else c->next[prev] = c->next[i];
+    if (*tail == i) *tail = prev;
+    c->next[idx] = -1;
+    c->waiting_on[idx] = -1;
+    return 1;
+  }
+  return 0;
+}
+
+// ============================================================================
+// Auxiliares
+// ============================================================================
+
+/**
+ * @brief  Canal `ch` se a chamada é válida (id no intervalo e há tarefa corrente).
+ */
+static ks_channel *get_chan(ks_chan *c, int ch) {
+  if (ch < 0 || ch >= c->nchan || c->s->current < 0) return NULL;
+  return &c->ch[ch];
+}
+
+/**
+ * @brief  Entrega o buffer `slot` a uma tarefa em espera e a devolve à fila de prontos.
+ */
+static void hand_to(ks_chan *c, ks_channel *h, int slot, int idx) {
+  h->owner[slot] = idx;
+  c->result[idx] = slot;
+  ks_unpark(c->s, idx);
+}
+
+/**
+ * @brief  Devolve um buffer: vai direto a um remetente em espera, ou à pilha de livres.
+ */
+static void release_buf(ks_chan *c, ks_channel *h, int slot) {
+  int w = wq_pop(c, &h->aq_head, &h->aq_tail);
+  if (w >= 0) { hand_to(c, h, slot, w); return; }
+  h->owner[slot] = -1;
+  h->freel[h->nfree++] = slot;
+}
+
+/**
+ * @brief  Contabiliza o recebimento do buffer `slot`.
+ */
+static void account_recv(ks_chan *c, ks_channel *h, int slot) {
+  long lat = c->s->now - h->sent_at[slot];
+  h->st.received++;
+  h->st.lat_total += lat;
+  if (lat > h->st.lat_max) h->st.lat_max = lat;
+}
+
+// ============================================================================
+// Ciclo de vida
+// ============================================================================
+
+int ks_chan_init(ks_chan *c, ks_sched *s, int nchan, void *seg) {
+  if (!c || !s || nchan <= 0) return -1;
+  memset(c, 0, sizeof(*c));
+  c->s = s;
+  c->nchan = nchan;
+  c->seg = seg;
+  c->ch = (ks_channel*)calloc((size_t)nchan, sizeof(ks_channel));
+  c->next = (int*)malloc((size_t)s->ntasks * sizeof(int));
+  c->waiting_on = (int*)malloc((size_t)s->ntasks * sizeof(int));
+  c->result = (int*)malloc((size_t)s->ntasks * sizeof(int));
+  if (!c->ch || !c->next || !c->waiting_on || !c->result) { ks_chan_destroy(c); return -1; }
+  for (int i = 0; i < s->ntasks; i++) c->next[i] = c->waiting_on[i] = c->result[i] = -1;
+  for (int k = 0; k < nchan; k++) {
+    ks_channel *h = &c->ch[k];
+    h->rq_head = h->rq_tail = h->aq_head = h->aq_tail = -1;
+    // Pilha em ordem decrescente: o primeiro alloc recebe o buffer 0
+    for (int b = 0; b < KS_CHAN_SLOTS; b++) {
+      h->owner[b] = -1;
+      h->freel[b] = KS_CHAN_SLOTS - 1 - b;
+    }
+    h->nfree = KS_CHAN_SLOTS;
+  }
+  return 0;
+}
+
+void ks_chan_destroy(ks_chan *c) {
+  if (!c) return;
+  free(c->ch); c->ch = NULL;
+  free(c->next); c->next = NULL;
+  free(c->waiting_on); c->waiting_on = NULL;
+  free(c->result); c->result = NULL;
+  c->nchan = 0;
+}
+
+// ============================================================================
+// Operações
+// ============================================================================
+
+int ks_chan_alloc(ks_chan *c, int ch) {
+  ks_channel *h = get_chan(c, ch);
+  if (!h) return -1;
+  int cur = c->s->current;
+  if (h->nfree > 0) {
+    int slot = h->freel[--h->nfree];
+    h->owner[slot] = cur;
+    return slot;
+  }
+  h->st.alloc_blocks++;
+  wq_push(c, &h->aq_head, &h->aq_tail, ch, cur);
+  ks_park_running(c->s);
+  return KS_CHAN_BLOCKED;
+}
+
+int ks_chan_send(ks_chan *c, int ch, int slot, int len) {
+  ks_channel *h = get_chan(c, ch);
+  if (!h || slot < 0 || slot >= KS_CHAN_SLOTS || h->owner[slot] != c->s->current ||
+      len < 0 || len > KS_CHAN_PAYLOAD) return -1;
+  h->seq++;
+  if (c->seg) ks_chan_slot(c->seg, ch, slot)->seq = h->seq;
+  h->sent_at[slot] = c->s->now;
+  h->st.sent++;
+  h->st.bytes += len;
+
+  int r = wq_pop(c, &h->rq_head, &h->rq_tail);
+  if (r >= 0) {
+    h->st.handoffs++;
+    account_recv(c, h, slot);
+    hand_to(c, h, slot, r);
+    return 0;
+  }
+  h->owner[slot] = KS_CHAN_QUEUED;
+  h->ring[(h->head + h->n) % KS_CHAN_SLOTS] = slot;
+  h->n++;
+  if (h->n > h->st.max_depth) h->st.max_depth = h->n;
+  return 0;
+}
+
+int ks_chan_recv(ks_chan *c, int ch) {
+  ks_channel *h = get_chan(c, ch);
+  if (!h) return -1;
+  int cur = c->s->current;
+  if (h->n > 0) {
+    int slot = h->ring[h->head];
+    h->head = (h->head + 1) % KS_CHAN_SLOTS;
+    h->n--;
+    h->owner[slot] = cur;
+    account_recv(c, h, slot);
+    return slot;
+  }
+  h->st.recv_blocks++;
+  wq_push(c, &h->rq_head, &h->rq_tail, ch, cur);
+  ks_park_running(c->s);
+  return KS_CHAN_BLOCKED;
+}
+
+int ks_chan_free(ks_chan *c, int ch, int slot) {
+  ks_channel *h = get_chan(c, ch);
+  if (!h || slot < 0 || slot >= KS_CHAN_SLOTS || h->owner[slot] != c->s->current) return -1;
+  release_buf(c, h, slot);
+  return 0;
+}
+
+int ks_chan_holds(const ks_chan *c, int idx) {
+  for (int k = 0; k < c->nchan; k++)
+    for (int b = 0; b < KS_CHAN_SLOTS; b++)
+      if (c->ch[k].owner[b] == idx) return 1;
+  return 0;
+}
+
+void ks_chan_task_exit(ks_chan *c, int idx) {
+  if (idx < 0 || idx >= c->s->ntasks) return;
+  int w = c->waiting_on[idx];
+  if (w >= 0) {
+    ks_channel *h = &c->ch[w];
+    if (!wq_remove(c, &h->rq_head, &h->rq_tail, idx)) wq_remove(c, &h->aq_head, &h->aq_tail, idx);
+  }
+  c->result[idx] = -1;
+  // Mensagens já enviadas continuam na fila; buffers em mãos da tarefa voltam
+  for (int k = 0; k < c->nchan; k++)
+    for (int b = 0; b < KS_CHAN_SLOTS; b++)
+      if (c->ch[k].owner[b] == idx) release_buf(c, &c->ch[k], b);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file    ks_chan.h
+ * @brief   Canais de mensagens entre tarefas sem cópia (libkernelsim).
+ * @details Cada canal tem KS_CHAN_SLOTS buffers num segmento de memória compartilhada
+ *          com as tarefas. A mensagem é escrita no lugar: o remetente reserva um buffer
+ *          (alloc), escreve nele e envia só o descritor (índice do buffer); o
+ *          destinatário recebe o descritor, lê no lugar e devolve o buffer (free).
+ *          O núcleo nunca copia o conteúdo.
+ *
+ *          Receber de um canal vazio ou reservar sem buffer livre bloqueia a tarefa
+ *          (ks_park_running) numa fila FIFO do canal; um envio entrega o descritor
+ *          direto ao primeiro receptor em espera, e um free entrega o buffer direto ao
+ *          primeiro remetente em espera. Os buffers limitam as mensagens em trânsito,
+ *          então um produtor mais rápido que o consumidor acaba bloqueado (contrapressão).
+ *
+ *          Métricas por canal: mensagens, bytes, bloqueios, maior fila e latência do
+ *          envio ao recebimento (ticks).
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_CHAN_H
+#define KS_CHAN_H
+
+#include <stddef.h>
+
+#define KS_CHAN_SLOTS   8     /**< Buffers por canal */
+#define KS_CHAN_PAYLOAD 240   /**< Bytes úteis por buffer */
+#define KS_CHAN_QUEUED  (-2)  /**< Dono de um buffer enviado e ainda não recebido */
+#define KS_CHAN_BLOCKED (-2)  /**< Retorno de operação que bloqueou a tarefa */
+
+/**
+ * @struct ks_chan_buf
+ * @brief  Buffer de mensagem no segmento compartilhado (layout comum a núcleo e APPs).
+ */
+typedef struct ks_chan_buf {
+  int       len;                      /**< Bytes válidos (remetente) */
+  int       seq;                      /**< Número da mensagem no canal (núcleo, no envio) */
+  long long sent_ns;                  /**< Carimbo do remetente, para latência fim a fim */
+  char      data[KS_CHAN_PAYLOAD];
+} ks_chan_buf;
+
+/**
+ * @brief  Tamanho do segmento de dados para `nchan` canais.
+ */
+#define KS_CHAN_SEG_SIZE(nchan) ((size_t)(nchan) * KS_CHAN_SLOTS * sizeof(ks_chan_buf))
+
+/**
+ * @brief  Buffer `slot` do canal `ch` dentro do segmento.
+ */
+static inline ks_chan_buf *ks_chan_slot(void *seg, int ch, int slot) {
+  return (ks_chan_buf*)seg + (size_t)ch * KS_CHAN_SLOTS + slot;
+}
+
+#ifndef KS_CHAN_LAYOUT_ONLY
+
+#include "ks_sched.h"
+
+/**
+ * @struct ks_chan_stats
+ * @brief  Métricas de um canal.
+ */
+typedef struct ks_chan_stats {
+  long sent;          /**< Mensagens enviadas */
+  long received;      /**< Mensagens recebidas */
+  long bytes;         /**< Bytes enviados (sem cópia) */
+  long recv_blocks;   /**< Recebimentos que esperaram mensagem */
+  long alloc_blocks;  /**< Reservas que esperaram buffer livre (contrapressão) */
+  long handoffs;      /**< Envios entregues direto a um receptor em espera */
+  int  max_depth;     /**< Maior fila de mensagens não recebidas */
+  long lat_total;     /**< Soma das latências envio -> recebimento (ticks) */
+  long lat_max;       /**< Maior latência */
+} ks_chan_stats;
+
+/**
+ * @struct ks_channel
+ * @brief  Estado de um canal (só no núcleo; o conteúdo fica no segmento).
+ */
+typedef struct ks_channel {
+  int  owner[KS_CHAN_SLOTS];    /**< Tarefa com o buffer (-1 = livre, KS_CHAN_QUEUED = na fila) */
+  long sent_at[KS_CHAN_SLOTS];  /**< Tick do envio de cada buffer */
+  int  freel[KS_CHAN_SLOTS];    /**< Pilha de buffers livres */
+  int  nfree;
+  int  ring[KS_CHAN_SLOTS];     /**< Descritores enviados, em ordem */
+  int  head, n;
+  int  rq_head, rq_tail;        /**< Receptores em espera (FIFO, -1 = vazia) */
+  int  aq_head, aq_tail;        /**< Remetentes esperando buffer livre */
+  int  seq;
+  ks_chan_stats st;
+} ks_channel;
+
+/**
+ * @struct ks_chan
+ * @brief  Tabela de canais ligada a um escalonador.
+ */
+typedef struct ks_chan {
+  ks_sched   *s;
+  int         nchan;
+  ks_channel *ch;
+  void       *seg;          /**< Segmento de dados (NULL = só descritores, p.ex. benchmark) */
+  int        *next;         /**< Próxima tarefa na mesma fila de espera */
+  int        *waiting_on;   /**< Canal em que a tarefa espera (-1 = nenhum) */
+  int        *result;       /**< Buffer entregue a quem estava em espera (-1 = nenhum) */
+} ks_chan;
+
+/**
+ * @brief  Cria `nchan` canais vazios para as tarefas de `s`.
+ * @param  seg Segmento com KS_CHAN_SEG_SIZE(nchan) bytes (pode ser NULL).
+ * @return 0 em sucesso, -1 em falha.
+ */
+int  ks_chan_init(ks_chan *c, ks_sched *s, int nchan, void *seg);
+
+/**
+ * @brief  Libera a tabela (não o segmento).
+ */
+void ks_chan_destroy(ks_chan *c);
+
+/**
+ * @brief  Operações da tarefa corrente.
+ * @details Retornam o buffer (alloc/recv) ou 0 (send/free) se concluíram na hora,
+ *          KS_CHAN_BLOCKED se a tarefa foi bloqueada (o buffer sai depois em
+ *          `result[idx]`, quando ela for liberada) e -1 em uso inválido.
+ */
+int  ks_chan_alloc(ks_chan *c, int ch);
+int  ks_chan_send(ks_chan *c, int ch, int slot, int len);
+int  ks_chan_recv(ks_chan *c, int ch);
+int  ks_chan_free(ks_chan *c, int ch, int slot);
+
+/**
+ * @brief  1 se a tarefa tem algum buffer reservado ou recebido.
+ */
+int  ks_chan_holds(const ks_chan *c, int idx);
+
+/**
+ * @brief  Limpa o rastro de uma tarefa que terminou: sai das filas e devolve buffers.
+ */
+void ks_chan_task_exit(ks_chan *c, int idx);
+
+#endif /* KS_CHAN_LAYOUT_ONLY */
+
+#endif /* KS_CHAN_H */
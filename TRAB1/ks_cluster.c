@@ -0,0 +1,341 @@
+/**
+ * @file    ks_cluster.c
+ * @brief   Implementação do transporte e da política do modo cluster (libkernelsim).
+ * @details Datagramas Unix não bloqueantes: cada mensagem é um ks_clmsg inteiro, então
+ *          não há enquadramento. Envio para um nó que ainda não subiu (ou já saiu) falha
+ *          e é apenas contado.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ks_cluster.h"
+
+// ============================================================================
+// Auxiliares
+// ============================================================================
+
+long long ks_cluster_now_ns(void) {
+  struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void node_addr(const ks_cluster *cl, int node, struct sockaddr_un *a) {
+  memset(a, 0, sizeof(*a));
+  a->sun_family = AF_UNIX;
+  snprintf(a->sun_path, sizeof(a->sun_path), "%s_node%d.sock", cl->prefix, node);
+}
+
+static int send_to(ks_cluster *cl, int to, ks_clmsg *m) {
+  struct sockaddr_un a;
+  node_addr(cl, to, &a);
+  m->from = cl->self;
+  m->load = cl->me;
+  if (sendto(cl->fd, m, sizeof(*m), 0, (struct sockaddr*)&a, sizeof(a)) != (ssize_t)sizeof(*m)) {
+    cl->st.send_errors++;
+    return -1;
+  }
+  cl->st.sent++;
+  return 0;
+}
+
+/**
+ * @brief  Manda COMMIT (ok=1) ou ABORT da migração `seq` ao destino `to`.
+ */
+static int send_verdict(ks_cluster *cl, int to, int seq, int ok) {
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = ok ? KS_MSG_COMMIT : KS_MSG_ABORT;
+  m.seq = seq;
+  return send_to(cl, to, &m);
+}
+
+/**
+ * @brief  Decide a migração pendente: registra a decisão, avisa o destino e a encerra.
+ * @return 1 se o COMMIT saiu; 0 se a decisão final é ABORT.
+ */
+static int decide_pending(ks_cluster *cl, int ok) {
+  int to = cl->pend_to, seq = cl->pend_seq;
+  cl->pend_idx = -1;
+  // Sem COMMIT entregue o destino nunca roda a tarefa, então ela fica aqui
+  if (ok && send_verdict(cl, to, seq, 1) != 0) ok = 0;
+  cl->dec_seq[to] = seq;
+  cl->dec_ok[to] = ok;
+  if (!ok) send_verdict(cl, to, seq, 0);
+  return ok;
+}
+
+/**
+ * @brief  (Re)envia o ACK da reserva aberta para a origem `from`.
+ */
+static int send_ack(ks_cluster *cl, int from) {
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = KS_MSG_ACK;
+  m.seq = cl->in_seq[from];
+  m.idx = cl->in_idx[from];
+  m.sent_ns = cl->in_sent_ns[from];
+  cl->in_ack_ns[from] = ks_cluster_now_ns();
+  return send_to(cl, from, &m);
+}
+
+/**
+ * @brief  Encerra a reserva aberta para `from` e a devolve em `m` como `type`.
+ */
+static void close_hold(ks_cluster *cl, int from, int type, ks_clmsg *m) {
+  memset(m, 0, sizeof(*m));
+  m->type = type;
+  m->from = from;
+  m->seq = cl->in_seq[from];
+  m->idx = cl->in_slot[from];
+  m->sent_ns = cl->in_sent_ns[from];
+  cl->in_seq[from] = 0;
+  if (type == KS_MSG_COMMIT) cl->st.mig_in++; else cl->st.aborted++;
+}
+
+/**
+ * @brief  1 se o resumo de `node` é recente o bastante para a política.
+ */
+static int peer_fresh(const ks_cluster *cl, int node, long long now) {
+  return node != cl->self && cl->peer_ns[node] > 0 &&
+         now - cl->peer_ns[node] <= (long long)KS_CL_STALE_MS * 1000000LL;
+}
+
+// ============================================================================
+// Ciclo de vida
+// ============================================================================
+
+int ks_cluster_open(ks_cluster *cl, const char *prefix, int self, int nnodes, int policy, int threshold) {
+  if (!cl || nnodes < 1 || nnodes > KS_CL_MAXNODES || self < 0 || self >= nnodes) {
+    errno = EINVAL;
+    return -1;
+  }
+  memset(cl, 0, sizeof(*cl));
+  snprintf(cl->prefix, sizeof(cl->prefix), "%s", prefix);
+  cl->self = self;
+  cl->nnodes = nnodes;
+  cl->policy = policy;
+  cl->threshold = (threshold < 1) ? 1 : threshold;
+  cl->pend_idx = -1;
+  cl->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (cl->fd < 0) return -1;
+  struct sockaddr_un a;
+  node_addr(cl, self, &a);
+  unlink(a.sun_path);
+  if (bind(cl->fd, (struct sockaddr*)&a, sizeof(a)) != 0) {
+    int e = errno;
+    close(cl->fd);
+    cl->fd = -1;
+    errno = e;
+    return -1;
+  }
+  return 0;
+}
+
+void ks_cluster_close(ks_cluster *cl) {
+  if (!cl || cl->fd < 0) return;
+  struct sockaddr_un a;
+  node_addr(cl, cl->self, &a);
+  close(cl->fd);
+  unlink(a.sun_path);
+  cl->fd = -1;
+}
+
+// ============================================================================
+// Carga e política
+// ============================================================================
+
+void ks_cluster_publish(ks_cluster *cl, const ks_load *me) {
+  cl->me = *me;
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = KS_MSG_LOAD;
+  for (int n = 0; n < cl->nnodes; n++) if (n != cl->self) send_to(cl, n, &m);
+}
+
+int ks_cluster_decide(ks_cluster *cl) {
+  if (cl->policy == KS_CL_NONE || cl->pend_idx >= 0) return -1;
+  long long now = ks_cluster_now_ns();
+  int mine = ks_load_value(&cl->me);
+  int best = -1;
+
+  if (cl->policy == KS_CL_PUSH) {
+    // Menos carregado com slot livre; empate: menor fila no dispositivo
+    for (int n = 0; n < cl->nnodes; n++) {
+      if (!peer_fresh(cl, n, now) || cl->peer[n].free <= 0) continue;
+      if (mine - ks_load_value(&cl->peer[n]) < cl->threshold) continue;
+      if (best < 0 || ks_load_value(&cl->peer[n]) < ks_load_value(&cl->peer[best]) ||
+          (ks_load_value(&cl->peer[n]) == ks_load_value(&cl->peer[best]) &&
+           cl->peer[n].backlog < cl->peer[best].backlog)) best = n;
+    }
+    return best;
+  }
+
+  // KS_CL_PULL: só quem não tem fila pede, e no máximo um STEAL por prazo
+  if (cl->me.ready > 0 || cl->me.free <= 0) return -1;
+  if (now - cl->steal_ns < (long long)KS_CL_TIMEOUT_MS * 1000000LL) return -1;
+  for (int n = 0; n < cl->nnodes; n++) {
+    if (!peer_fresh(cl, n, now) || cl->peer[n].ready <= 0) continue;
+    if (ks_load_value(&cl->peer[n]) - mine < cl->threshold) continue;
+    if (best < 0 || ks_load_value(&cl->peer[n]) > ks_load_value(&cl->peer[best])) best = n;
+  }
+  return best;
+}
+
+int ks_cluster_accepts_steal(const ks_cluster *cl, int thief) {
+  if (thief < 0 || thief >= cl->nnodes || cl->pend_idx >= 0 || cl->me.ready <= 0) return 0;
+  return ks_load_value(&cl->me) - ks_load_value(&cl->peer[thief]) >= cl->threshold;
+}
+
+// ============================================================================
+// Migração
+// ============================================================================
+
+int ks_cluster_steal(ks_cluster *cl, int victim) {
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = KS_MSG_STEAL;
+  cl->steal_ns = ks_cluster_now_ns();
+  if (send_to(cl, victim, &m) != 0) return -1;
+  cl->st.steals_sent++;
+  return 0;
+}
+
+int ks_cluster_migrate(ks_cluster *cl, int to, int idx, const ks_task_image *img) {
+  if (cl->pend_idx >= 0 || to < 0 || to >= cl->nnodes || to == cl->self) return -1;
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = KS_MSG_MIGRATE;
+  m.seq = ++cl->seq;
+  m.idx = idx;
+  m.img = *img;
+  m.sent_ns = ks_cluster_now_ns();
+  if (send_to(cl, to, &m) != 0) return -1;
+  cl->pend_idx = idx;
+  cl->pend_to = to;
+  cl->pend_seq = m.seq;
+  cl->pend_ns = m.sent_ns;
+  // Reserva o slot no destino até o próximo resumo dele
+  if (cl->peer[to].free > 0) cl->peer[to].free--;
+  return 0;
+}
+
+int ks_cluster_reply(ks_cluster *cl, const ks_clmsg *req, int slot) {
+  if (slot >= 0) {
+    cl->in_seq[req->from] = req->seq;
+    cl->in_slot[req->from] = slot;
+    cl->in_idx[req->from] = req->idx;
+    cl->in_sent_ns[req->from] = req->sent_ns;
+    return send_ack(cl, req->from);
+  }
+  ks_clmsg m;
+  memset(&m, 0, sizeof(m));
+  m.type = KS_MSG_NACK;
+  m.seq = req->seq;
+  m.idx = req->idx;
+  m.sent_ns = req->sent_ns;
+  cl->st.refused++;
+  return send_to(cl, req->from, &m);
+}
+
+void ks_cluster_downtime(ks_cluster *cl, long long sent_ns) {
+  long long d = ks_cluster_now_ns() - sent_ns;
+  cl->st.down_total_ns += d;
+  if (d > cl->st.down_max_ns) cl->st.down_max_ns = d;
+  cl->st.down_n++;
+}
+
+int ks_cluster_poll(ks_cluster *cl, ks_clmsg *m) {
+  for (;;) {
+    ssize_t n = recv(cl->fd, m, sizeof(*m), 0);
+    if (n < 0) break;
+    if (n != (ssize_t)sizeof(*m) || m->from < 0 || m->from >= cl->nnodes) continue;
+    cl->st.received++;
+    cl->peer[m->from] = m->load;
+    cl->peer_ns[m->from] = ks_cluster_now_ns();
+
+    switch (m->type) {
+      case KS_MSG_LOAD:
+        continue;
+      case KS_MSG_MIGRATE:
+        if (cl->in_seq[m->from]) {
+          // Uma decisão entregue chegaria antes deste MIGRATE: a reserva anterior
+          // foi abortada sem aviso. Recusa esta e libera aquela.
+          ks_cluster_reply(cl, m, -1);
+          close_hold(cl, m->from, KS_MSG_ABORT, m);
+        }
+        return 1;
+      case KS_MSG_STEAL:
+        cl->st.steals_recv++;
+        return 1;
+      case KS_MSG_ACK:
+        if (cl->pend_idx >= 0 && m->seq == cl->pend_seq && m->from == cl->pend_to) {
+          long long rtt = ks_cluster_now_ns() - cl->pend_ns;
+          m->idx = cl->pend_idx;
+          if (decide_pending(cl, 1)) {
+            cl->st.rtt_total_ns += rtt;
+            if (rtt > cl->st.rtt_max_ns) cl->st.rtt_max_ns = rtt;
+            cl->st.mig_out++;
+          } else {
+            m->type = KS_MSG_NACK;
+            cl->st.timeouts++;
+          }
+          return 1;
+        }
+        // ACK repetido ou atrasado: repete a decisão já tomada (ABORT se não houve)
+        if (cl->dec_seq[m->from] == m->seq && cl->dec_ok[m->from]) {
+          send_verdict(cl, m->from, m->seq, 1);
+        } else {
+          cl->st.late_acks++;
+          send_verdict(cl, m->from, m->seq, 0);
+        }
+        continue;
+      case KS_MSG_NACK:
+        // Resposta de uma migração já desfeita: ignorada
+        if (cl->pend_idx < 0 || m->seq != cl->pend_seq || m->from != cl->pend_to) continue;
+        cl->st.nacks++;
+        m->idx = cl->pend_idx;
+        cl->pend_idx = -1;
+        return 1;
+      case KS_MSG_COMMIT: case KS_MSG_ABORT:
+        // Decisão de uma reserva já encerrada (COMMIT repetido): ignorada
+        if (cl->in_seq[m->from] != m->seq) continue;
+        close_hold(cl, m->from, m->type, m);
+        return 1;
+    }
+  }
+
+  long long now = ks_cluster_now_ns();
+  // Sem ACK no prazo: a origem decide ABORT e retoma a tarefa
+  if (cl->pend_idx >= 0 && now - cl->pend_ns > (long long)KS_CL_TIMEOUT_MS * 1000000LL) {
+    memset(m, 0, sizeof(*m));
+    m->type = KS_MSG_NACK;
+    m->from = cl->pend_to;
+    m->seq = cl->pend_seq;
+    m->idx = cl->pend_idx;
+    decide_pending(cl, 0);
+    cl->st.timeouts++;
+    return 1;
+  }
+
+  // Reservas abertas: a decisão pode ter se perdido; a origem que sumiu não decide mais
+  for (int n = 0; n < cl->nnodes; n++) {
+    if (!cl->in_seq[n]) continue;
+    if (now - cl->peer_ns[n] > (long long)KS_CL_STALE_MS * 1000000LL) {
+      close_hold(cl, n, KS_MSG_ABORT, m);
+      return 1;
+    }
+    if (now - cl->in_ack_ns[n] > (long long)KS_CL_TIMEOUT_MS * 1000000LL) send_ack(cl, n);
+  }
+  return 0;
+}
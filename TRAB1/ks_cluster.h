@@ -0,0 +1,205 @@
+/**
+ * @file    ks_cluster.h
+ * @brief   Modo cluster: várias instâncias do kernel no mesmo host trocando carga e tarefas.
+ * @details Cada nó tem um socket Unix de datagramas em `<prefixo>_node<id>.sock`. A cada
+ *          tick o nó publica um resumo de carga (prontas, rodando, fila do dispositivo,
+ *          slots livres) para os demais, e a política de balanceamento decide migrações:
+ *          - KS_CL_PUSH: o nó sobrecarregado empurra uma tarefa para o menos carregado;
+ *          - KS_CL_PULL: o nó ocioso pede (STEAL) uma tarefa ao mais carregado.
+ *          Em ambos a diferença de carga precisa ser de pelo menos `threshold`.
+ *
+ *          Migrar é mandar a imagem da tarefa (executável, pc e pedidos pendentes na SHM)
+ *          em MIGRATE; o destino reserva uma vaga e responde ACK (ou NACK sem vaga), mas
+ *          não roda a tarefa. Quem decide é só a origem, com a tarefa congelada:
+ *          - ACK dentro do prazo: manda COMMIT e só então descarta a sua cópia; o destino
+ *            cria o processo ao receber o COMMIT;
+ *          - sem resposta no prazo: retoma a tarefa e manda ABORT; o destino libera a vaga.
+ *          Um ACK que chega depois da decisão é respondido de novo com ela (ABORT, no caso
+ *          de atraso). O destino não desiste sozinho: reenvia o ACK a cada prazo até
+ *          saber a decisão e só libera a vaga sem ela se a origem sumir (sem nenhuma
+ *          mensagem por KS_CL_STALE_MS). Como os datagramas de um nó chegam em ordem, a
+ *          tarefa roda em exatamente um nó.
+ *          Há no máximo uma migração pendente por nó. São medidos o tempo de ida e volta
+ *          (MIGRATE -> ACK) e a indisponibilidade (da saída da fila de prontos na origem
+ *          ao primeiro despacho no destino).
+ *
+ *          Este módulo não cria processos nem trata sinais: isso fica com o `kernel`.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_CLUSTER_H
+#define KS_CLUSTER_H
+
+#define KS_CL_MAXNODES  8     /**< Nós por cluster */
+#define KS_CL_PATHLEN   96    /**< Caminho máximo do executável migrado */
+#define KS_CL_STALE_MS  3000  /**< Resumo de carga mais velho que isso é ignorado */
+#define KS_CL_TIMEOUT_MS 3000 /**< Migração sem ACK é desfeita (e o ACK reenviado) após esse prazo */
+
+enum { KS_CL_NONE=0, KS_CL_PUSH, KS_CL_PULL };
+enum { KS_MSG_LOAD=1, KS_MSG_MIGRATE, KS_MSG_ACK, KS_MSG_NACK, KS_MSG_STEAL, KS_MSG_COMMIT, KS_MSG_ABORT };
+
+/**
+ * @struct ks_load
+ * @brief  Resumo de carga de um nó.
+ */
+typedef struct ks_load {
+  long tick;     /**< Relógio do nó emissor */
+  int  ready;    /**< Tarefas prontas */
+  int  running;  /**< 1 se há tarefa na CPU */
+  int  backlog;  /**< Tarefas esperando o dispositivo de I/O */
+  int  free;     /**< Slots livres para receber tarefas */
+} ks_load;
+
+/**
+ * @brief  Carga usada pela política: tarefas disputando a CPU.
+ */
+static inline int ks_load_value(const ks_load *l) { return l->ready + l->running; }
+
+/**
+ * @struct ks_task_image
+ * @brief  Estado de uma tarefa que viaja na migração.
+ */
+typedef struct ks_task_image {
+  char path[KS_CL_PATHLEN];  /**< Executável */
+  int  pc;                   /**< Contador de programa */
+  int  want_io, io_type;     /**< Pedido de I/O ainda não atendido */
+  int  want_sys, sys_num;    /**< Syscall ainda não atendida */
+  int  sys_arg[3];
+  long cpu;                  /**< CPU já consumida (ticks); o destino continua a contagem */
+} ks_task_image;
+
+/**
+ * @struct ks_clmsg
+ * @brief  Mensagem entre nós (um datagrama).
+ */
+typedef struct ks_clmsg {
+  int  type;           /**< KS_MSG_* */
+  int  from;           /**< Nó emissor */
+  int  seq;            /**< Número da migração (ecoado em ACK/NACK/COMMIT/ABORT) */
+  int  idx;            /**< Tarefa na origem (MIGRATE/ACK/NACK) */
+  long long sent_ns;   /**< Envio do MIGRATE (CLOCK_MONOTONIC, comum ao host) */
+  ks_load load;        /**< Carga do emissor (todas as mensagens) */
+  ks_task_image img;   /**< Imagem (MIGRATE) */
+} ks_clmsg;
+
+/**
+ * @struct ks_cluster_stats
+ * @brief  Métricas do nó.
+ */
+typedef struct ks_cluster_stats {
+  long sent, received, send_errors;
+  long mig_out;          /**< Migrações confirmadas (saída: COMMIT enviado) */
+  long mig_in;           /**< Tarefas recebidas (COMMIT recebido) */
+  long nacks;            /**< Migrações recusadas pelo destino */
+  long refused;          /**< MIGRATE recusados aqui */
+  long timeouts;         /**< Migrações desfeitas por falta de resposta (ABORT enviado) */
+  long late_acks;        /**< ACKs rejeitados por chegarem depois da decisão */
+  long aborted;          /**< Reservas liberadas aqui (ABORT recebido ou origem sumiu) */
+  long steals_sent, steals_recv;
+  long long rtt_total_ns, rtt_max_ns;     /**< MIGRATE -> ACK */
+  long long down_total_ns, down_max_ns;   /**< Congelamento -> primeiro despacho no destino */
+  long down_n;
+} ks_cluster_stats;
+
+/**
+ * @struct ks_cluster
+ * @brief  Estado do nó no cluster.
+ */
+typedef struct ks_cluster {
+  int  self, nnodes;
+  int  fd;                                   /**< Socket do nó (-1 = fechado) */
+  char prefix[64];                           /**< Prefixo dos caminhos dos sockets */
+  int  policy, threshold;
+  ks_load   peer[KS_CL_MAXNODES];            /**< Último resumo de cada nó */
+  long long peer_ns[KS_CL_MAXNODES];         /**< Quando chegou (0 = nunca) */
+  ks_load   me;                              /**< Último resumo publicado por este nó */
+  int       seq;
+  int       pend_idx, pend_to, pend_seq;     /**< Migração pendente (pend_idx = -1: nenhuma) */
+  long long pend_ns;
+  int       dec_seq[KS_CL_MAXNODES];         /**< Última migração decidida por destino */
+  int       dec_ok[KS_CL_MAXNODES];          /**< 1 = COMMIT, 0 = ABORT */
+  int       in_seq[KS_CL_MAXNODES];          /**< Reserva à espera da decisão, por origem (0 = nenhuma) */
+  int       in_slot[KS_CL_MAXNODES];         /**< Vaga local reservada */
+  int       in_idx[KS_CL_MAXNODES];          /**< Tarefa na origem (ecoada no ACK) */
+  long long in_sent_ns[KS_CL_MAXNODES];      /**< Envio do MIGRATE */
+  long long in_ack_ns[KS_CL_MAXNODES];       /**< Último ACK enviado */
+  long long steal_ns;                        /**< Último STEAL enviado */
+  ks_cluster_stats st;
+} ks_cluster;
+
+/**
+ * @brief  Abre o socket do nó `self` (0..nnodes-1).
+ * @param  prefix Prefixo dos caminhos (ex.: "/tmp/kernelsim").
+ * @return 0 em sucesso, -1 em falha (errno preservado).
+ */
+int  ks_cluster_open(ks_cluster *cl, const char *prefix, int self, int nnodes, int policy, int threshold);
+
+/**
+ * @brief  Fecha e remove o socket do nó.
+ */
+void ks_cluster_close(ks_cluster *cl);
+
+/**
+ * @brief  Publica o resumo de carga do nó para todos os outros.
+ */
+void ks_cluster_publish(ks_cluster *cl, const ks_load *me);
+
+/**
+ * @brief  Decide, pela política, com qual nó agir agora.
+ * @return Destino (KS_CL_PUSH) ou vítima de STEAL (KS_CL_PULL), ou -1.
+ */
+int  ks_cluster_decide(ks_cluster *cl);
+
+/**
+ * @brief  1 se este nó deve atender um STEAL de `thief` (continua com mais carga).
+ */
+int  ks_cluster_accepts_steal(const ks_cluster *cl, int thief);
+
+/**
+ * @brief  Pede uma tarefa ao nó `victim`.
+ */
+int  ks_cluster_steal(ks_cluster *cl, int victim);
+
+/**
+ * @brief  Envia a tarefa `idx` para o nó `to`.
+ * @return 0 se enviada (fica pendente até ACK/NACK), -1 se já há migração pendente
+ *         ou o envio falhou.
+ */
+int  ks_cluster_migrate(ks_cluster *cl, int to, int idx, const ks_task_image *img);
+
+/**
+ * @brief  Responde a um MIGRATE recebido.
+ * @param  slot Vaga local reservada para a tarefa (ACK), ou -1 (NACK). A vaga fica
+ *              reservada até o COMMIT ou ABORT da origem sair de ks_cluster_poll.
+ */
+int  ks_cluster_reply(ks_cluster *cl, const ks_clmsg *req, int slot);
+
+/**
+ * @brief  Lê a próxima mensagem que exige ação do kernel, sem bloquear.
+ * @details Resumos de carga são absorvidos aqui.
+ *          - Na origem: ACK da migração pendente sai como ACK (COMMIT já enviado: a
+ *            tarefa local deve ser descartada) e NACK, falha ao enviar o COMMIT ou
+ *            falta de ACK no prazo saem como NACK (ABORT já enviado: a tarefa volta a
+ *            READY); em ambos `idx` = tarefa local.
+ *          - No destino: COMMIT e ABORT de uma reserva saem com `idx` = vaga local; se a
+ *            origem sumir com a reserva aberta, sai um ABORT.
+ * @return 1 se `m` foi preenchida, 0 se não há nada a fazer.
+ */
+int  ks_cluster_poll(ks_cluster *cl, ks_clmsg *m);
+
+/**
+ * @brief  Registra a indisponibilidade de uma tarefa recebida no primeiro despacho.
+ * @param  sent_ns Campo `sent_ns` do MIGRATE.
+ */
+void ks_cluster_downtime(ks_cluster *cl, long long sent_ns);
+
+/**
+ * @brief  Relógio monotônico em ns (mesma base em todos os processos do host).
+ */
+long long ks_cluster_now_ns(void);
+
+#endif /* KS_CLUSTER_H */
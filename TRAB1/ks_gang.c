@@ -0,0 +1,108 @@
+/**
+ * @file    ks_gang.c
+ * @brief   Implementação do escalonamento em gangue das threads de uma tarefa (libkernelsim).
+ * @details O rodízio dentro do grupo é circular por índice de thread: cada tick começa
+ *          na thread seguinte à última que ganhou CPU no tick anterior.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_gang.h"
+
+int ks_gang_init(ks_gang *g, int ngroups, int ncpu, int fair) {
+  if (!g || ngroups <= 0 || ncpu < 1 || ncpu > KS_GANG_MAXCPU) return -1;
+  memset(g, 0, sizeof(*g));
+  g->grp = (ks_group*)calloc((size_t)ngroups, sizeof(ks_group));
+  if (!g->grp) return -1;
+  g->ngroups = ngroups;
+  g->ncpu = ncpu;
+  g->fair = fair;
+  for (int i = 0; i < ngroups; i++) ks_gang_set_threads(g, i, 1);
+  return 0;
+}
+
+void ks_gang_destroy(ks_gang *g) {
+  if (!g) return;
+  free(g->grp); g->grp = NULL;
+  g->ngroups = 0;
+}
+
+int ks_gang_set_threads(ks_gang *g, int idx, int nthr) {
+  if (idx < 0 || idx >= g->ngroups || nthr < 1 || nthr > KS_GANG_MAXTHR) return -1;
+  ks_group *gp = &g->grp[idx];
+  memset(gp, 0, sizeof(*gp));
+  gp->nthr = nthr;
+  gp->live = nthr;
+  gp->picked_at = -1;
+  return 0;
+}
+
+int ks_gang_pick(ks_gang *g, int idx, long now, const int *state, int *run) {
+  ks_group *gp = &g->grp[idx];
+  int n = gp->nthr, ready = 0, live = 0;
+  for (int t = 0; t < n; t++) {
+    ready += (state[t] == KS_THR_READY);
+    live += (state[t] != KS_THR_DONE);
+  }
+  gp->live = live;
+
+  int fresh = (now != gp->picked_at);
+  if (fresh) {
+    gp->picked_at = now;
+    gp->start = gp->next;
+    if (ready > g->ncpu) g->st.rotations++;
+    for (int t = 0; t < n; t++) g->st.futex_skips += (state[t] == KS_THR_FUTEX);
+  }
+
+  int used = 0;
+  for (int k = 0; k < n; k++) {
+    int t = (gp->start + k) % n;
+    run[t] = (state[t] == KS_THR_READY && used < g->ncpu);
+    if (run[t]) { used++; gp->next = (t + 1) % n; }
+  }
+  memcpy(gp->run, run, (size_t)n * sizeof(int));
+  return used;
+}
+
+void ks_gang_account(ks_gang *g, int idx, const int *state) {
+  g->st.ticks++;
+  if (idx < 0 || idx >= g->ngroups) { g->st.idle += g->ncpu; return; }
+  ks_group *gp = &g->grp[idx];
+  gp->ticks++;
+  if (gp->nthr <= 1) {
+    gp->thr_ticks[0]++;
+    gp->cpu_ticks++;
+    g->st.busy++;
+    g->st.idle += g->ncpu - 1;
+    return;
+  }
+
+  int used = 0, wasted = 0, live = 0, together = 1;
+  for (int t = 0; t < gp->nthr; t++) {
+    if (state[t] == KS_THR_DONE) { wasted += gp->run[t]; continue; }
+    live++;
+    if (gp->run[t] && state[t] == KS_THR_READY) { used++; gp->thr_ticks[t]++; continue; }
+    wasted += gp->run[t];
+    together = 0;
+  }
+  gp->live = live;
+  gp->cpu_ticks += used;
+  if (live > 0 && together) gp->cosched++;
+  g->st.busy += used;
+  g->st.parked += wasted;
+  g->st.idle += g->ncpu - used - wasted;
+}
+
+int ks_gang_weight(const ks_gang *g, int idx) {
+  if (g->fair != KS_GANG_FAIR_THREAD || idx < 0 || idx >= g->ngroups) return 1;
+  int live = g->grp[idx].live;
+  if (live <= 1) return 1;
+  int cpus = (live < g->ncpu) ? live : g->ncpu;
+  return (live + cpus - 1) / cpus;
+}
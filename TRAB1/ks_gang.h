@@ -0,0 +1,116 @@
+/**
+ * @file    ks_gang.h
+ * @brief   Tarefas com várias threads e escalonamento em gangue (libkernelsim).
+ * @details Uma tarefa pode ser um grupo de até KS_GANG_MAXTHR threads, cada uma com seu
+ *          estado e seu pc. O núcleo continua escalonando tarefas (grupos); quando um
+ *          grupo ganha a CPU, todas as suas threads prontas rodam juntas nas `ncpu`
+ *          CPUs simuladas (gangue). Se houver mais threads prontas que CPUs, elas se
+ *          revezam em rodízio a cada tick, dentro da fatia do grupo.
+ *
+ *          Uma thread parada num futex do próprio grupo (barreira, mutex de usuário)
+ *          não recebe CPU: a vaga vai para outra thread pronta.
+ *
+ *          Justiça entre grupos: por grupo (padrão), cada tarefa recebe o mesmo
+ *          quantum, tenha quantas threads tiver; por thread, o quantum do grupo é
+ *          multiplicado por threads vivas / CPUs usadas, para que cada thread receba
+ *          a mesma CPU que uma tarefa de uma thread só.
+ *
+ *          Este módulo só escolhe as threads e contabiliza; quem as para e as retoma
+ *          (futex na SHM, no `kernel`) é quem o embute.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_GANG_H
+#define KS_GANG_H
+
+#define KS_GANG_MAXTHR 8   /**< Threads por tarefa */
+#define KS_GANG_MAXCPU 8   /**< CPUs simuladas */
+
+enum { KS_THR_READY=0, KS_THR_FUTEX, KS_THR_DONE };   /**< Estado de uma thread */
+enum { KS_GANG_FAIR_GROUP=0, KS_GANG_FAIR_THREAD };   /**< Justiça entre grupos */
+
+/**
+ * @struct ks_group
+ * @brief  Threads de uma tarefa (nthr <= 1: tarefa comum).
+ */
+typedef struct ks_group {
+  int  nthr;                       /**< Threads do grupo */
+  int  live;                       /**< Threads que ainda não terminaram */
+  int  start;                      /**< Primeira thread considerada no tick corrente */
+  int  next;                       /**< Primeira thread do próximo tick (rodízio) */
+  long picked_at;                  /**< Tick da última escolha (-1 = nunca) */
+  int  run[KS_GANG_MAXTHR];        /**< 1 se a thread está numa CPU */
+  long thr_ticks[KS_GANG_MAXTHR];  /**< Ticks de CPU de cada thread */
+  long ticks;                      /**< Ticks em que o grupo teve as CPUs */
+  long cpu_ticks;                  /**< CPU-ticks usados (soma das threads) */
+  long cosched;                    /**< Ticks com todas as threads vivas rodando juntas */
+} ks_group;
+
+/**
+ * @struct ks_gang_stats
+ * @brief  Métricas das CPUs simuladas.
+ */
+typedef struct ks_gang_stats {
+  long ticks;        /**< Ticks contabilizados */
+  long busy;         /**< CPU-ticks com uma thread rodando */
+  long idle;         /**< CPU-ticks sem thread (gangue menor que as CPUs, CPU livre) */
+  long parked;       /**< CPU-ticks dados a uma thread que parou em futex ou terminou */
+  long rotations;    /**< Rodízios de threads dentro de um grupo */
+  long futex_skips;  /**< Vezes em que uma thread em futex foi pulada na escolha */
+} ks_gang_stats;
+
+/**
+ * @struct ks_gang
+ * @brief  Grupos de threads e CPUs simuladas.
+ */
+typedef struct ks_gang {
+  int       ncpu;    /**< CPUs simuladas */
+  int       fair;    /**< KS_GANG_FAIR_GROUP ou KS_GANG_FAIR_THREAD */
+  int       ngroups;
+  ks_group *grp;
+  ks_gang_stats st;
+} ks_gang;
+
+/**
+ * @brief  Cria `ngroups` tarefas de uma thread só sobre `ncpu` CPUs.
+ * @return 0 em sucesso, -1 em parâmetro inválido ou falha de alocação.
+ */
+int  ks_gang_init(ks_gang *g, int ngroups, int ncpu, int fair);
+
+/**
+ * @brief  Libera a memória.
+ */
+void ks_gang_destroy(ks_gang *g);
+
+/**
+ * @brief  Define quantas threads a tarefa `idx` tem e zera a contabilidade dela.
+ * @return 0 em sucesso, -1 se `nthr` estiver fora de 1..KS_GANG_MAXTHR.
+ */
+int  ks_gang_set_threads(ks_gang *g, int idx, int nthr);
+
+/**
+ * @brief  Escolhe as threads do grupo `idx` que rodam agora.
+ * @param  state Estado de cada thread (KS_THR_*).
+ * @param  run   Recebe 1 para as threads que ganham uma CPU.
+ * @details O rodízio avança uma vez por tick: chamar de novo no mesmo tick (p.ex. no
+ *          despacho e no fim do IRQ0) só reaproveita o ponto de partida.
+ * @return CPUs ocupadas.
+ */
+int  ks_gang_pick(ks_gang *g, int idx, long now, const int *state, int *run);
+
+/**
+ * @brief  Contabiliza um tick que passou com o grupo `idx` nas CPUs (-1 = nenhum).
+ * @param  state Estado das threads ao fim do tick (ignorado em tarefas comuns).
+ */
+void ks_gang_account(ks_gang *g, int idx, const int *state);
+
+/**
+ * @brief  Multiplicador do quantum da tarefa `idx` (1 com justiça por grupo).
+ */
+int  ks_gang_weight(const ks_gang *g, int idx);
+
+#endif /* KS_GANG_H */
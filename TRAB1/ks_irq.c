@@ -0,0 +1,72 @@
+/**
+ * @file    ks_irq.c
+ * @brief   Implementação da coalescência de IRQ1 (libkernelsim).
+ * @details A fila é circular e do tamanho do número de tarefas: cada tarefa tem no
+ *          máximo um pedido de I/O em andamento.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_irq.h"
+
+int ks_irq_init(ks_irqq *q, int cap, int window, int batch) {
+  if (!q || cap < 1 || window < 0 || batch < 0) return -1;
+  memset(q, 0, sizeof(*q));
+  q->ev = (ks_irq_ev*)calloc((size_t)cap, sizeof(ks_irq_ev));
+  if (!q->ev) return -1;
+  q->cap = cap;
+  q->window = window;
+  q->batch = batch;
+  return 0;
+}
+
+void ks_irq_destroy(ks_irqq *q) {
+  if (!q) return;
+  free(q->ev); q->ev = NULL;
+  q->cap = q->n = 0;
+}
+
+int ks_irq_push(ks_irqq *q, int idx, int type, long now) {
+  if (q->n >= q->cap) { q->st.overflows++; return -1; }
+  ks_irq_ev *e = &q->ev[(q->head + q->n) % q->cap];
+  e->idx = idx;
+  e->type = type;
+  e->tick = now;
+  q->n++;
+  q->st.irqs++;
+  return 0;
+}
+
+int ks_irq_due(const ks_irqq *q, long now) {
+  if (q->n == 0) return 0;
+  if (q->window == 0 || (q->batch > 0 && q->n >= q->batch)) return 1;
+  return now - q->ev[q->head].tick >= q->window;
+}
+
+int ks_irq_drain(ks_irqq *q, int *idx, int *type, int max, long now) {
+  if (q->n == 0 || max < 1) return 0;
+  if (q->window > 0) {
+    if (q->batch > 0 && q->n >= q->batch) q->st.by_batch++; else q->st.by_window++;
+  }
+  int k = 0;
+  while (q->n > 0 && k < max) {
+    const ks_irq_ev *e = &q->ev[q->head];
+    long d = now - e->tick;
+    q->st.delay_total += d;
+    if (d > q->st.delay_max) q->st.delay_max = d;
+    idx[k] = e->idx;
+    type[k] = e->type;
+    k++;
+    q->head = (q->head + 1) % q->cap;
+    q->n--;
+  }
+  q->st.flushes++;
+  if (k > q->st.max_batch) q->st.max_batch = k;
+  return k;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file    ks_irq.h
+ * @brief   Coalescência de interrupções de término de I/O (IRQ1) da libkernelsim.
+ * @details O tratador do IRQ1 (metade de cima) só registra o término numa fila; o
+ *          desbloqueio das tarefas (metade de baixo) é feito em lote quando a janela
+ *          de `window` ticks desde o primeiro término pendente vence ou quando `batch`
+ *          términos se acumulam. Com `window` = 0 cada IRQ1 é tratado na hora, como no
+ *          kernel original.
+ *
+ *          Um lote com vários términos custa no máximo uma preempção (ver
+ *          ks_io_complete_batch), em vez de um par SIGSTOP/SIGCONT por término.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_IRQ_H
+#define KS_IRQ_H
+
+/**
+ * @struct ks_irq_ev
+ * @brief  Término de I/O pendente.
+ */
+typedef struct ks_irq_ev {
+  int  idx;    /**< Tarefa cujo I/O terminou */
+  int  type;   /**< Tipo do I/O */
+  long tick;   /**< Tick em que o IRQ1 chegou */
+} ks_irq_ev;
+
+/**
+ * @struct ks_irq_stats
+ * @brief  Métricas da coalescência.
+ */
+typedef struct ks_irq_stats {
+  long irqs;         /**< Términos registrados */
+  long flushes;      /**< Lotes tratados */
+  long by_window;    /**< Lotes disparados pela janela */
+  long by_batch;     /**< Lotes disparados pelo tamanho */
+  long max_batch;    /**< Maior lote */
+  long delay_total;  /**< Soma dos atrasos IRQ1 -> tratamento (ticks) */
+  long delay_max;    /**< Maior atraso */
+  long overflows;    /**< Términos tratados na hora por fila cheia */
+} ks_irq_stats;
+
+/**
+ * @struct ks_irqq
+ * @brief  Fila circular de términos pendentes.
+ */
+typedef struct ks_irqq {
+  int        window;  /**< Janela em ticks (0 = sem coalescência) */
+  int        batch;   /**< Lote que força o tratamento (0 = só a janela) */
+  int        cap;     /**< Capacidade da fila */
+  int        head, n;
+  ks_irq_ev *ev;
+  ks_irq_stats st;
+} ks_irqq;
+
+/**
+ * @brief  Cria a fila.
+ * @param  cap    Capacidade (>= 1; uma por tarefa basta).
+ * @param  window Janela em ticks (>= 0).
+ * @param  batch  Lote máximo (>= 0).
+ * @return 0 em sucesso, -1 em falha.
+ */
+int  ks_irq_init(ks_irqq *q, int cap, int window, int batch);
+
+/**
+ * @brief  Libera a fila.
+ */
+void ks_irq_destroy(ks_irqq *q);
+
+/**
+ * @brief  Registra um término (metade de cima).
+ * @return 0 se enfileirado, -1 se a fila está cheia (trate o término na hora).
+ */
+int  ks_irq_push(ks_irqq *q, int idx, int type, long now);
+
+/**
+ * @brief  1 se o lote pendente deve ser tratado agora.
+ */
+int  ks_irq_due(const ks_irqq *q, long now);
+
+/**
+ * @brief  Retira até `max` términos em ordem de chegada (metade de baixo).
+ * @return Quantidade retirada.
+ */
+int  ks_irq_drain(ks_irqq *q, int *idx, int *type, int max, long now);
+
+#endif /* KS_IRQ_H */
@@ -0,0 +1,76 @@
+/**
+ * @file    ks_pic.c
+ * @brief   Implementação do controlador de interrupções programável (libkernelsim).
+ * @details O instante do levantamento é gravado antes de o bit ser ligado (release) e
+ *          lido depois de o bit ser visto (acquire), então o kernel nunca mede com o
+ *          instante de um levantamento anterior.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <string.h>
+
+#include "ks_pic.h"
+
+int ks_pic_init(ks_pic *p, int nlines) {
+  if (!p || nlines < 1 || nlines > KS_PIC_LINES) return -1;
+  memset(p, 0, sizeof(*p));
+  p->nlines = nlines;
+  for (int l = 0; l < KS_PIC_LINES; l++) p->line[l].prio = l;
+  return 0;
+}
+
+int ks_pic_set_prio(ks_pic *p, int line, int prio) {
+  if (line < 0 || line >= p->nlines || prio < 0) return -1;
+  p->line[line].prio = prio;
+  return 0;
+}
+
+int ks_pic_mask(ks_pic *p, int line, int masked) {
+  if (line < 0 || line >= p->nlines) return -1;
+  uint32_t bit = 1u << line;
+  if (masked) __atomic_fetch_or(&p->imr, bit, __ATOMIC_RELEASE);
+  else        __atomic_fetch_and(&p->imr, ~bit, __ATOMIC_RELEASE);
+  return 0;
+}
+
+int ks_pic_raise(ks_pic *p, int line, long long now_ns) {
+  if (line < 0 || line >= p->nlines) return -1;
+  uint32_t bit = 1u << line;
+  ks_pic_line *l = &p->line[line];
+  if (__atomic_load_n(&p->irr, __ATOMIC_ACQUIRE) & bit) { l->merged++; return 0; }
+  __atomic_store_n(&l->raised_ns, now_ns, __ATOMIC_RELAXED);
+  __atomic_fetch_or(&p->irr, bit, __ATOMIC_RELEASE);
+  l->raised++;
+  return 1;
+}
+
+int ks_pic_pending(const ks_pic *p, int line) {
+  if (line < 0 || line >= p->nlines) return 0;
+  return (__atomic_load_n(&p->irr, __ATOMIC_ACQUIRE) >> line) & 1u;
+}
+
+int ks_pic_deliverable(const ks_pic *p) {
+  return (__atomic_load_n(&p->irr, __ATOMIC_ACQUIRE) & ~__atomic_load_n(&p->imr, __ATOMIC_ACQUIRE)) != 0;
+}
+
+int ks_pic_ack(ks_pic *p, long long now_ns) {
+  uint32_t ready = __atomic_load_n(&p->irr, __ATOMIC_ACQUIRE) & ~__atomic_load_n(&p->imr, __ATOMIC_ACQUIRE);
+  if (!ready) return -1;
+  int best = -1;
+  for (int l = 0; l < p->nlines; l++) {
+    if (!(ready & (1u << l))) continue;
+    if (best < 0 || p->line[l].prio < p->line[best].prio) best = l;
+  }
+  ks_pic_line *l = &p->line[best];
+  long long lat = now_ns - __atomic_load_n(&l->raised_ns, __ATOMIC_RELAXED);
+  __atomic_fetch_and(&p->irr, ~(1u << best), __ATOMIC_ACQ_REL);
+  if (lat < 0) lat = 0;
+  l->delivered++;
+  l->lat_total_ns += lat;
+  if (lat > l->lat_max_ns) l->lat_max_ns = lat;
+  return best;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file    ks_pic.h
+ * @brief   Controlador de interrupções programável (PIC) simulado da libkernelsim.
+ * @details O PIC tem KS_PIC_LINES linhas de IRQ, cada uma com prioridade (0 = mais
+ *          alta) e máscara. Um dispositivo levanta a sua linha (bit pendente no IRR,
+ *          com o instante) e toca a campainha — um único sinal para todas as linhas;
+ *          o kernel, ao acordar, reconhece as pendentes não mascaradas em ordem de
+ *          prioridade (ks_pic_ack), trata cada uma e mede a latência levantamento ->
+ *          reconhecimento por linha.
+ *
+ *          A estrutura não tem ponteiros: fica na SHM, escrita pelos dois lados. Só o
+ *          IRR é disputado (o dispositivo liga bits, o kernel desliga) e é mexido com
+ *          operações atômicas; as métricas de levantamento são do dispositivo e as de
+ *          entrega, do kernel.
+ *
+ *          Uma linha levantada de novo enquanto ainda pendente funde-se com o pedido
+ *          anterior, como no hardware; uma linha mascarada fica pendente até ser
+ *          desmascarada. Os tratadores rodam até o fim no laço do kernel, sem aninhar:
+ *          a prioridade decide a ordem entre as pendentes de uma mesma campainha.
+ *          Como a campainha só toca para linha nova, o kernel precisa olhar o IRR
+ *          (ks_pic_deliverable) com a campainha bloqueada antes de dormir: um toque
+ *          atendido entre o último ks_pic_ack e a espera deixaria a linha pendente
+ *          sem ninguém para tocar de novo.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_PIC_H
+#define KS_PIC_H
+
+#include <stdint.h>
+
+#define KS_PIC_LINES 16   /**< Linhas de IRQ */
+
+/**
+ * @brief  Linhas usadas pelo InterController.
+ */
+enum { KS_IRQ_TIMER=0, KS_IRQ_DISK=1 };
+
+/**
+ * @struct ks_pic_line
+ * @brief  Configuração e métricas de uma linha.
+ */
+typedef struct ks_pic_line {
+  int       prio;        /**< Prioridade (0 = mais alta) */
+  long long raised_ns;   /**< Instante (CLOCK_MONOTONIC) do levantamento pendente */
+  long      raised;      /**< Levantamentos aceitos (dispositivo) */
+  long      merged;      /**< Levantamentos fundidos a um pendente (dispositivo) */
+  long      delivered;   /**< Reconhecidos pelo kernel */
+  long long lat_total_ns;
+  long long lat_max_ns;
+} ks_pic_line;
+
+/**
+ * @struct ks_pic
+ * @brief  Estado do PIC (na SHM).
+ */
+typedef struct ks_pic {
+  uint32_t    irr;       /**< Linhas pendentes (Interrupt Request Register) */
+  uint32_t    imr;       /**< Linhas mascaradas (Interrupt Mask Register) */
+  int         nlines;    /**< Linhas em uso */
+  long        rings;     /**< Campainhas tocadas (dispositivo) */
+  long        wakeups;   /**< Campainhas atendidas com ao menos uma entrega (kernel) */
+  ks_pic_line line[KS_PIC_LINES];
+} ks_pic;
+
+/**
+ * @brief  Zera o PIC: `nlines` linhas desmascaradas, prioridade = número da linha.
+ * @return 0 em sucesso, -1 em parâmetro inválido.
+ */
+int  ks_pic_init(ks_pic *p, int nlines);
+
+/**
+ * @brief  Define a prioridade da linha (0 = mais alta; empate: linha menor primeiro).
+ * @return 0 em sucesso, -1 em parâmetro inválido.
+ */
+int  ks_pic_set_prio(ks_pic *p, int line, int prio);
+
+/**
+ * @brief  Mascara (1) ou desmascara (0) a linha.
+ * @return 0 em sucesso, -1 em parâmetro inválido.
+ */
+int  ks_pic_mask(ks_pic *p, int line, int masked);
+
+/**
+ * @brief  Lado do dispositivo: levanta a linha.
+ * @param  now_ns Instante do levantamento (CLOCK_MONOTONIC, ns).
+ * @return 1 se a linha ficou pendente agora (toque a campainha), 0 se já estava
+ *         pendente (fundido), -1 em linha inválida.
+ */
+int  ks_pic_raise(ks_pic *p, int line, long long now_ns);
+
+/**
+ * @brief  1 se a linha ainda não foi reconhecida pelo kernel.
+ */
+int  ks_pic_pending(const ks_pic *p, int line);
+
+/**
+ * @brief  1 se há linha pendente e não mascarada (ks_pic_ack devolveria uma).
+ */
+int  ks_pic_deliverable(const ks_pic *p);
+
+/**
+ * @brief  Lado do kernel: reconhece a linha pendente e não mascarada de maior
+ *         prioridade, desliga o bit e registra a latência.
+ * @param  now_ns Instante do reconhecimento (CLOCK_MONOTONIC, ns).
+ * @return Linha reconhecida, ou -1 se não há nenhuma.
+ */
+int  ks_pic_ack(ks_pic *p, long long now_ns);
+
+#endif /* KS_PIC_H */
@@ -0,0 +1,138 @@
+/**
+ * @file    ks_power.c
+ * @brief   Implementação do modelo de energia (C-states, DVFS e governadores) da libkernelsim.
+ * @details As tabelas seguem a forma de uma CPU real em escala: a potência ativa cresce
+ *          mais rápido que a frequência (tensão sobe junto), então o nível mais baixo
+ *          gasta menos energia por instrução, e os C-states mais profundos gastam menos
+ *          mas demoram mais para sair.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_power.h"
+
+const ks_pstate ks_pstates[KS_PW_LEVELS] = {
+  {  40,  350 },
+  {  60,  600 },
+  {  80, 1000 },
+  { 100, 1700 },
+};
+
+const ks_cstate ks_cstates[KS_PW_CSTATES] = {
+  { "C0", 300,   0, 0 },   // espera ativa: sem latência, gasta quase como ativa
+  { "C1", 150,  10, 0 },
+  { "C2",  60, 100, 2 },
+  { "C3",  15, 300, 4 },
+};
+
+/**
+ * @brief  Menor nível cuja frequência cobre a fração `need` da máxima.
+ */
+static int level_for(double need) {
+  for (int l = 0; l < KS_PW_LEVELS; l++)
+    if (ks_pstates[l].freq_pct >= need * 100.0 - 1e-9) return l;
+  return KS_PW_LEVELS - 1;
+}
+
+int ks_power_init(ks_power *p, int ntasks, int gov, int cmax) {
+  if (!p || ntasks <= 0 || gov < KS_GOV_PERFORMANCE || gov > KS_GOV_SCHEDUTIL ||
+      cmax < 0 || cmax >= KS_PW_CSTATES) return -1;
+  memset(p, 0, sizeof(*p));
+  p->task_mj = (double*)calloc((size_t)ntasks, sizeof(double));
+  if (!p->task_mj) return -1;
+  p->ntasks = ntasks;
+  p->gov = gov;
+  p->cmax = cmax;
+  p->level = KS_PW_LEVELS - 1;
+  if (gov == KS_GOV_POWERSAVE) p->level = 0;
+  return 0;
+}
+
+void ks_power_destroy(ks_power *p) {
+  if (!p) return;
+  free(p->task_mj); p->task_mj = NULL;
+  p->ntasks = 0;
+}
+
+int ks_power_tick(ks_power *p, int cur, int nready) {
+  int busy = (cur >= 0);
+  if (busy) {
+    double e = ks_pstates[p->level].power_mw;   // mW durante um tick de 1s = mJ
+    p->st.busy_ticks++;
+    p->st.level_ticks[p->level]++;
+    p->st.e_active += e;
+    if (cur < p->ntasks) p->task_mj[cur] += e;
+  } else {
+    // Ociosa sem ks_power_idle_enter (p.ex. antes do primeiro despacho): espera ativa
+    int c = p->idle ? p->cstate : 0;
+    p->st.idle_ticks++;
+    p->st.cstate_ticks[c]++;
+    p->st.e_idle += ks_cstates[c].power_mw;
+  }
+
+  int want = p->level;
+  double f = ks_pstates[p->level].freq_pct / 100.0;
+  switch (p->gov) {
+    case KS_GOV_PERFORMANCE: want = KS_PW_LEVELS - 1; break;
+    case KS_GOV_POWERSAVE:   want = 0; break;
+    case KS_GOV_ONDEMAND:
+      p->win_busy += busy;
+      if (++p->win_n >= KS_PW_OD_WINDOW) {
+        double load = (double)p->win_busy / p->win_n;
+        want = (load >= 0.8) ? KS_PW_LEVELS - 1 : level_for(load);
+        p->win_busy = p->win_n = 0;
+      }
+      break;
+    case KS_GOV_SCHEDUTIL: {
+      double demand = (busy + nready) * f;
+      if (demand > 1.0) demand = 1.0;
+      p->util = 0.5 * p->util + 0.5 * demand;
+      want = level_for(1.25 * p->util);
+      break;
+    }
+  }
+  if (want == p->level) return 0;
+  p->level = want;
+  p->st.transitions++;
+  return 1;
+}
+
+int ks_power_idle_enter(ks_power *p, long now, long next_event) {
+  if (p->idle) return p->cstate;
+  double pred = p->idle_ema;
+  if (next_event >= 0 && next_event < pred) pred = (double)next_event;
+  int c = 0;
+  for (int k = 1; k <= p->cmax; k++) if (ks_cstates[k].residency <= pred) c = k;
+  p->idle = 1;
+  p->cstate = c;
+  p->idle_since = now;
+  p->st.cstate_entries[c]++;
+  return c;
+}
+
+int ks_power_idle_exit(ks_power *p, long now) {
+  if (!p->idle) return 0;
+  const ks_cstate *c = &ks_cstates[p->cstate];
+  long len = now - p->idle_since;
+  p->idle_ema = 0.5 * p->idle_ema + 0.5 * (double)len;
+  if (len < c->residency) p->st.mispredicts++;
+  p->idle = 0;
+  if (c->exit_ms > 0) {
+    p->st.exits++;
+    p->st.exit_ms += c->exit_ms;
+    p->st.e_exit += ks_pstates[p->level].power_mw * c->exit_ms / 1000.0;
+  }
+  return c->exit_ms;
+}
+
+int ks_power_freq(const ks_power *p) { return ks_pstates[p->level].freq_pct; }
+
+double ks_power_energy(const ks_power *p) {
+  return p->st.e_active + p->st.e_idle + p->st.e_exit;
+}
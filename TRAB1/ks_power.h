@@ -0,0 +1,145 @@
+/**
+ * @file    ks_power.h
+ * @brief   Modelo de energia da CPU: estados ociosos (C-states), níveis de frequência
+ *          (DVFS) e governadores (libkernelsim).
+ * @details A cada tick a CPU está ocupada (roda uma tarefa, no nível de frequência
+ *          corrente) ou ociosa (num C-state); a energia do tick é a potência do estado
+ *          vezes a duração do tick (1s). Sair de um C-state custa a latência de saída do
+ *          estado, paga na CPU ativa antes de a tarefa voltar a rodar.
+ *
+ *          Governador ocioso (tipo "menu"): ao ficar ociosa, a CPU entra no C-state mais
+ *          profundo cuja residência mínima cabe no ocioso previsto, que é o menor entre
+ *          a média móvel dos últimos períodos ociosos e o próximo temporizador.
+ *
+ *          Governadores de frequência, avaliados a cada tick:
+ *          - performance: sempre na frequência máxima;
+ *          - powersave: sempre na mínima;
+ *          - ondemand: a cada KS_PW_OD_WINDOW ticks, carga (fração ocupada) >= 80% vai
+ *            à máxima; abaixo disso, ao menor nível que cubra a carga;
+ *          - schedutil: utilização da fila de prontos (corrente + prontas, ponderada
+ *            pela frequência em que rodaram, média móvel) * 1,25, ao menor nível que a
+ *            cubra; reage a cada tick.
+ *
+ *          A frequência não muda a duração do tick: muda quanto trabalho a tarefa faz
+ *          nele (as APPs leem a frequência na SHM e alongam as instruções).
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_POWER_H
+#define KS_POWER_H
+
+#define KS_PW_LEVELS     4   /**< Níveis de frequência (P-states) */
+#define KS_PW_CSTATES    4   /**< C0 (espera ativa) .. C3 */
+#define KS_PW_OD_WINDOW  3   /**< Janela de amostragem do ondemand (ticks) */
+
+enum { KS_GOV_PERFORMANCE=0, KS_GOV_POWERSAVE, KS_GOV_ONDEMAND, KS_GOV_SCHEDUTIL };
+
+/**
+ * @struct ks_pstate
+ * @brief  Nível de frequência e potência da CPU ocupada nele.
+ */
+typedef struct ks_pstate {
+  int freq_pct;   /**< Frequência (% da máxima) */
+  int power_mw;   /**< Potência ativa (mW) */
+} ks_pstate;
+
+/**
+ * @struct ks_cstate
+ * @brief  Estado ocioso.
+ */
+typedef struct ks_cstate {
+  const char *name;
+  int power_mw;    /**< Potência no estado (mW) */
+  int exit_ms;     /**< Latência de saída (ms) */
+  int residency;   /**< Ociosidade mínima (ticks) para o estado compensar */
+} ks_cstate;
+
+extern const ks_pstate ks_pstates[KS_PW_LEVELS];
+extern const ks_cstate ks_cstates[KS_PW_CSTATES];
+
+/**
+ * @struct ks_power_stats
+ * @brief  Métricas de energia e de latência.
+ */
+typedef struct ks_power_stats {
+  long   busy_ticks;                   /**< Ticks com tarefa rodando */
+  long   idle_ticks;                   /**< Ticks ociosos */
+  long   level_ticks[KS_PW_LEVELS];    /**< Ticks ocupados em cada nível */
+  long   cstate_ticks[KS_PW_CSTATES];  /**< Ticks ociosos em cada C-state */
+  long   cstate_entries[KS_PW_CSTATES];/**< Entradas em cada C-state */
+  long   transitions;                  /**< Trocas de nível de frequência */
+  long   exits;                        /**< Saídas de C-state com latência */
+  long   exit_ms;                      /**< Soma das latências de saída (ms) */
+  long   mispredicts;                  /**< Ociosos mais curtos que a residência do estado */
+  double e_active;                     /**< Energia com a CPU ocupada (mJ) */
+  double e_idle;                       /**< Energia ociosa (mJ) */
+  double e_exit;                       /**< Energia das saídas de C-state (mJ) */
+} ks_power_stats;
+
+/**
+ * @struct ks_power
+ * @brief  Estado do modelo de energia.
+ */
+typedef struct ks_power {
+  int     gov;        /**< Governador de frequência (KS_GOV_*) */
+  int     cmax;       /**< C-state mais profundo permitido (0 = só espera ativa) */
+  int     ntasks;
+  int     level;      /**< Nível de frequência corrente */
+  int     idle;       /**< 1 = CPU ociosa */
+  int     cstate;     /**< C-state corrente (se ociosa) */
+  long    idle_since; /**< Tick de entrada no ocioso */
+  double  idle_ema;   /**< Média móvel dos períodos ociosos (ticks) */
+  double  util;       /**< Utilização da fila de prontos (schedutil, 0..1) */
+  int     win_busy;   /**< Ticks ocupados na janela do ondemand */
+  int     win_n;      /**< Ticks na janela */
+  double *task_mj;    /**< Energia ativa gasta por tarefa (mJ) */
+  ks_power_stats st;
+} ks_power;
+
+/**
+ * @brief  Cria o modelo com a CPU ativa na frequência máxima.
+ * @return 0 em sucesso, -1 em parâmetro inválido ou falha de alocação.
+ */
+int  ks_power_init(ks_power *p, int ntasks, int gov, int cmax);
+
+/**
+ * @brief  Libera a memória.
+ */
+void ks_power_destroy(ks_power *p);
+
+/**
+ * @brief  Contabiliza o tick que terminou e roda o governador de frequência.
+ * @param  cur    Tarefa que ocupou a CPU no tick (-1 = ociosa).
+ * @param  nready Tarefas prontas esperando a CPU.
+ * @return 1 se o nível de frequência mudou, 0 caso contrário.
+ */
+int  ks_power_tick(ks_power *p, int cur, int nready);
+
+/**
+ * @brief  A CPU ficou ociosa: escolhe o C-state.
+ * @param  next_event Ticks até o próximo temporizador (-1 = nenhum).
+ * @return C-state escolhido.
+ */
+int  ks_power_idle_enter(ks_power *p, long now, long next_event);
+
+/**
+ * @brief  Uma tarefa vai rodar numa CPU ociosa: sai do C-state.
+ * @return Latência de saída a pagar antes de a tarefa rodar (ms).
+ */
+int  ks_power_idle_exit(ks_power *p, long now);
+
+/**
+ * @brief  Frequência corrente (% da máxima).
+ */
+int  ks_power_freq(const ks_power *p);
+
+/**
+ * @brief  Energia total gasta até agora (mJ).
+ */
+double ks_power_energy(const ks_power *p);
+
+#endif /* KS_POWER_H */
@@ -0,0 +1,140 @@
+/**
+ * @file    ks_quantum.c
+ * @brief   Implementação do ajuste automático de quantum (libkernelsim).
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_quantum.h"
+
+/**
+ * @brief  Quantil da normal padrão para o percentil dado (interpolação em tabela).
+ */
+static double z_for_pct(int pct) {
+  static const int    p[] = { 50,   75,    90,    95,    99 };
+  static const double z[] = { 0.0,  0.674, 1.282, 1.645, 2.326 };
+  if (pct <= p[0]) return z[0];
+  for (int i = 1; i < 5; i++) {
+    if (pct <= p[i]) return z[i-1] + (z[i] - z[i-1]) * (pct - p[i-1]) / (double)(p[i] - p[i-1]);
+  }
+  return z[4];
+}
+
+/**
+ * @brief  Teto de um double não negativo (evita depender de libm).
+ */
+static long ceil_pos(double x) {
+  long i = (long)x;
+  return ((double)i < x) ? i + 1 : i;
+}
+
+static int clampq(const ks_qtune *qt, long q) {
+  if (q < qt->qmin) return qt->qmin;
+  if (q > qt->qmax) return qt->qmax;
+  return (int)q;
+}
+
+int ks_qtune_init(ks_qtune *qt, int ntasks, int mode, int qmin, int qmax, int pct, int q0) {
+  if (!qt || ntasks <= 0) return -1;
+  memset(qt, 0, sizeof(*qt));
+  qt->mode   = mode;
+  qt->qmin   = (qmin < 1) ? 1 : qmin;
+  qt->qmax   = (qmax < qt->qmin) ? qt->qmin : qmax;
+  qt->pct    = (pct < 1) ? 1 : (pct > 99 ? 99 : pct);
+  qt->z      = z_for_pct(qt->pct);
+  qt->alpha  = 0.25;
+  qt->lat    = qt->qmax;
+  qt->ntasks = ntasks;
+  qt->global_q = clampq(qt, q0);
+  qt->ema    = (double*)calloc((size_t)ntasks, sizeof(double));
+  qt->dev    = (double*)calloc((size_t)ntasks, sizeof(double));
+  qt->task_q = (int*)malloc((size_t)ntasks * sizeof(int));
+  qt->kind   = (signed char*)malloc((size_t)ntasks);
+  if (!qt->ema || !qt->dev || !qt->task_q || !qt->kind) { ks_qtune_destroy(qt); return -1; }
+  for (int i = 0; i < ntasks; i++) { qt->task_q[i] = qt->global_q; qt->ema[i] = qt->global_q; qt->kind[i] = -1; }
+  return 0;
+}
+
+void ks_qtune_destroy(ks_qtune *qt) {
+  if (!qt) return;
+  free(qt->ema);    qt->ema = NULL;
+  free(qt->dev);    qt->dev = NULL;
+  free(qt->task_q); qt->task_q = NULL;
+  free(qt->kind);   qt->kind = NULL;
+}
+
+/**
+ * @brief  Recalcula o quantum global: menor q com pct% do histograma em [1, q].
+ */
+static int global_from_hist(const ks_qtune *qt) {
+  if (qt->hist_n <= 0) return (qt->cens_n > 0) ? qt->qmax : qt->global_q;
+  long need = (qt->hist_n * qt->pct + 99) / 100;
+  long acc = 0;
+  for (int b = 1; b < KS_BURST_BUCKETS; b++) {
+    acc += qt->hist[b];
+    if (acc >= need) return clampq(qt, b);
+  }
+  return qt->qmax;
+}
+
+int ks_qtune_sample(ks_qtune *qt, int idx, long burst, int censored) {
+  if (qt->mode == KS_Q_FIXED || idx < 0 || idx >= qt->ntasks) return 0;
+  if (burst < 1) burst = 1;
+  qt->samples++;
+  if (censored) qt->censored++;
+
+  if (qt->mode == KS_Q_GLOBAL) {
+    if (censored) {
+      qt->cens_n++;
+    } else {
+      int b = (burst >= KS_BURST_BUCKETS) ? KS_BURST_BUCKETS - 1 : (int)burst;
+      qt->hist[b]++;
+      qt->hist_n++;
+    }
+    if (++qt->since_aging >= KS_BURST_AGING) {
+      qt->since_aging = 0;
+      qt->hist_n = 0;
+      qt->cens_n /= 2;
+      for (int i = 0; i < KS_BURST_BUCKETS; i++) { qt->hist[i] /= 2; qt->hist_n += qt->hist[i]; }
+    }
+    int q = global_from_hist(qt);
+    if (q == qt->global_q) return 0;
+    qt->global_q = q;
+    qt->changes++;
+    return 1;
+  }
+
+  // KS_Q_TASK: classe da tarefa pela última amostra (entra no teto das CPU-bound)
+  int k = censored ? 1 : 0;
+  if (qt->kind[idx] != k) {
+    if (qt->kind[idx] == 0) qt->n_inter--; else if (qt->kind[idx] == 1) qt->n_cpu--;
+    if (k) qt->n_cpu++; else qt->n_inter++;
+    qt->kind[idx] = (signed char)k;
+  }
+  // EMA da rajada e do desvio absoluto (como SRTT/RTTVAR)
+  double err = (double)burst - qt->ema[idx];
+  qt->ema[idx] += qt->alpha * err;
+  qt->dev[idx] += qt->alpha * ((err < 0 ? -err : err) - qt->dev[idx]);
+  int q = clampq(qt, ceil_pos(qt->ema[idx] + qt->z * qt->dev[idx]));
+  if (q == qt->task_q[idx]) return 0;
+  qt->task_q[idx] = q;
+  qt->changes++;
+  return 1;
+}
+
+int ks_qtune_quantum(const ks_qtune *qt, int idx) {
+  if (qt->mode != KS_Q_TASK || idx < 0 || idx >= qt->ntasks) return qt->global_q;
+  int q = qt->task_q[idx];
+  if (qt->kind[idx] == 1 && qt->n_inter > 0) {
+    // As CPU-bound dividem a espera-alvo de quem acorda
+    int cap = clampq(qt, qt->lat / qt->n_cpu);
+    if (q > cap) q = cap;
+  }
+  return q;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file    ks_quantum.h
+ * @brief   Ajuste automático do quantum a partir das rajadas de CPU observadas.
+ * @details Uma rajada (burst) é o tempo de CPU entre a tarefa ficar pronta por conta
+ *          própria e sair da CPU voluntariamente (I/O, sono, espera em objeto, fim).
+ *          Preempções não encerram a rajada; nelas a amostra é "censurada" (a rajada
+ *          real é maior) e entra como o tempo já consumido mais um quantum.
+ *
+ *          Dois modos:
+ *          - KS_Q_GLOBAL: histograma (com envelhecimento) das rajadas não censuradas;
+ *            o quantum global é o menor valor em que `pct`% delas cabem. Uma amostra
+ *            censurada é só um limite inferior e puxaria o percentil para qmax; elas
+ *            só decidem o quantum quando não há nenhuma rajada voluntária (todas as
+ *            tarefas CPU-bound: qmax).
+ *          - KS_Q_TASK: por tarefa, média móvel exponencial (EMA) da rajada e do desvio;
+ *            quantum = EMA + z(pct) * desvio. Enquanto houver tarefas interativas, as
+ *            CPU-bound (última amostra censurada) dividem entre si a espera-alvo `lat`:
+ *            o quantum de cada uma fica em no máximo lat / (número de CPU-bound), para
+ *            que uma interativa que acorda não espere mais que `lat` ticks.
+ *          Em ambos o resultado fica em [qmin, qmax].
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_QUANTUM_H
+#define KS_QUANTUM_H
+
+#define KS_BURST_BUCKETS 64   /**< Histograma de 1..63 ticks + transbordo */
+#define KS_BURST_AGING   64   /**< A cada N amostras o histograma é dividido por 2 */
+
+enum { KS_Q_FIXED=0, KS_Q_GLOBAL, KS_Q_TASK };
+
+/**
+ * @struct ks_qtune
+ * @brief  Estado do ajuste automático.
+ */
+typedef struct ks_qtune {
+  int    mode;                    /**< KS_Q_* */
+  int    qmin, qmax;              /**< Limites do quantum (ticks) */
+  int    pct;                     /**< Percentil-alvo de rajadas dentro de um quantum */
+  double z;                       /**< Fator do desvio correspondente a `pct` (modo tarefa) */
+  double alpha;                   /**< Peso da amostra nova na EMA */
+  int    lat;                     /**< Espera-alvo das interativas em ticks (modo tarefa; = qmax) */
+  int    ntasks;
+  long   hist[KS_BURST_BUCKETS];  /**< Rajadas não censuradas por duração (modo global) */
+  long   hist_n;                  /**< Soma do histograma */
+  long   cens_n;                  /**< Amostras censuradas (envelhecidas junto com o histograma) */
+  long   since_aging;             /**< Amostras desde o último envelhecimento */
+  int    global_q;                /**< Quantum global corrente */
+  double *ema;                    /**< EMA da rajada por tarefa */
+  double *dev;                    /**< EMA do desvio absoluto por tarefa */
+  int    *task_q;                 /**< Quantum por tarefa (sem o teto de CPU-bound) */
+  signed char *kind;              /**< Última amostra: -1 nenhuma, 0 voluntária, 1 censurada */
+  int    n_inter, n_cpu;          /**< Tarefas com kind 0 e com kind 1 */
+  long   samples;                 /**< Amostras recebidas */
+  long   censored;                /**< Amostras vindas de preempção */
+  long   changes;                 /**< Mudanças de quantum */
+} ks_qtune;
+
+/**
+ * @brief  Inicializa o ajuste.
+ * @param  q0 Quantum inicial (também o de todas as tarefas no modo por tarefa).
+ * @return 0 em sucesso, -1 em falha.
+ */
+int  ks_qtune_init(ks_qtune *qt, int ntasks, int mode, int qmin, int qmax, int pct, int q0);
+
+/**
+ * @brief  Libera a memória do ajuste.
+ */
+void ks_qtune_destroy(ks_qtune *qt);
+
+/**
+ * @brief  Registra uma rajada da tarefa `idx`.
+ * @param  burst    Duração em ticks.
+ * @param  censored 1 se a rajada foi interrompida por preempção.
+ * @return 1 se o quantum (global ou da tarefa) mudou, 0 caso contrário.
+ */
+int  ks_qtune_sample(ks_qtune *qt, int idx, long burst, int censored);
+
+/**
+ * @brief  Quantum a usar no próximo despacho da tarefa `idx` (já com o teto de CPU-bound).
+ */
+int  ks_qtune_quantum(const ks_qtune *qt, int idx);
+
+#endif /* KS_QUANTUM_H */
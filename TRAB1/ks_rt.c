@@ -0,0 +1,134 @@
+/**
+ * @file    ks_rt.c
+ * @brief   Implementação da classe de tempo real EDF (libkernelsim).
+ * @details Heap binário indexado: cada tarefa guarda sua posição (`heap_pos`), então
+ *          inserir, remover uma tarefa qualquer e consultar o topo custam O(log n)/O(1).
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_rt.h"
+
+// ============================================================================
+// Heap de prazos
+// ============================================================================
+
+static void heap_set(ks_rt *rt, int pos, int idx) {
+  rt->heap[pos] = idx;
+  rt->t[idx].heap_pos = pos;
+}
+
+static void sift_up(ks_rt *rt, int pos) {
+  int idx = rt->heap[pos];
+  while (pos > 0) {
+    int parent = (pos - 1) / 2;
+    if (!ks_rt_earlier(rt, idx, rt->heap[parent])) break;
+    heap_set(rt, pos, rt->heap[parent]);
+    pos = parent;
+  }
+  heap_set(rt, pos, idx);
+}
+
+static void sift_down(ks_rt *rt, int pos) {
+  int idx = rt->heap[pos];
+  for (;;) {
+    int c = 2 * pos + 1;
+    if (c >= rt->nheap) break;
+    if (c + 1 < rt->nheap && ks_rt_earlier(rt, rt->heap[c + 1], rt->heap[c])) c++;
+    if (!ks_rt_earlier(rt, rt->heap[c], idx)) break;
+    heap_set(rt, pos, rt->heap[c]);
+    pos = c;
+  }
+  heap_set(rt, pos, idx);
+}
+
+void ks_rt_push(ks_rt *rt, int idx) {
+  if (rt->t[idx].heap_pos >= 0) return;
+  heap_set(rt, rt->nheap++, idx);
+  sift_up(rt, rt->nheap - 1);
+}
+
+void ks_rt_remove(ks_rt *rt, int idx) {
+  int pos = rt->t[idx].heap_pos;
+  if (pos < 0) return;
+  rt->t[idx].heap_pos = -1;
+  int last = rt->heap[--rt->nheap];
+  if (pos == rt->nheap) return;
+  heap_set(rt, pos, last);
+  sift_up(rt, pos);
+  sift_down(rt, rt->t[last].heap_pos);
+}
+
+// ============================================================================
+// Ciclo de vida e admissão
+// ============================================================================
+
+int ks_rt_init(ks_rt *rt, int ntasks, int bound_pct) {
+  if (!rt || ntasks <= 0) return -1;
+  memset(rt, 0, sizeof(*rt));
+  rt->ntasks = ntasks;
+  rt->bound_pct = (bound_pct < 1) ? 1 : (bound_pct > 100 ? 100 : bound_pct);
+  rt->t = (ks_rt_task*)calloc((size_t)ntasks, sizeof(ks_rt_task));
+  rt->heap = (int*)malloc((size_t)ntasks * sizeof(int));
+  if (!rt->t || !rt->heap) { ks_rt_destroy(rt); return -1; }
+  for (int i = 0; i < ntasks; i++) rt->t[i].heap_pos = -1;
+  return 0;
+}
+
+void ks_rt_destroy(ks_rt *rt) {
+  if (!rt) return;
+  free(rt->t);    rt->t = NULL;
+  free(rt->heap); rt->heap = NULL;
+  rt->ntasks = rt->nheap = 0;
+}
+
+int ks_rt_admit(ks_rt *rt, int idx, long period, long wcet, long deadline) {
+  if (idx < 0 || idx >= rt->ntasks || period < 1 || wcet < 1) return -1;
+  if (deadline <= 0) deadline = period;
+  if (wcet > deadline || rt->t[idx].period > 0) return -1;
+  double dens = (double)wcet / (double)(deadline < period ? deadline : period);
+  if ((rt->util + dens) * 100.0 > rt->bound_pct + 1e-9) { rt->st.rejected++; return 1; }
+  ks_rt_task *t = &rt->t[idx];
+  t->period = period;
+  t->wcet = wcet;
+  t->deadline = deadline;
+  rt->util += dens;
+  rt->nrt++;
+  return 0;
+}
+
+// ============================================================================
+// Métricas
+// ============================================================================
+
+int ks_rt_bucket(long v) {
+  int b = 0;
+  while (v > 0 && b < KS_RT_HBUCKETS - 1) { v >>= 1; b++; }
+  return b;
+}
+
+long ks_rt_complete(ks_rt *rt, int idx, long now) {
+  ks_rt_task *t = &rt->t[idx];
+  long late = now - t->job_dl;
+  long resp = now - (t->job_dl - t->deadline);   // desde a liberação original do job
+  t->pending = 0;
+  t->jobs++;
+  t->resp_total += resp;
+  if (resp > t->resp_max) t->resp_max = resp;
+  rt->st.completions++;
+  if (late > 0) {
+    t->misses++;
+    rt->st.misses++;
+    rt->st.late_hist[ks_rt_bucket(late)]++;
+    if (late > t->late_max) t->late_max = late;
+  } else {
+    rt->st.slack_hist[ks_rt_bucket(-late)]++;
+  }
+  return late;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file    ks_rt.h
+ * @brief   Classe de tempo real EDF (earliest deadline first) da libkernelsim.
+ * @details Tarefas de tempo real declaram período T, tempo de execução no pior caso C
+ *          (WCET) e prazo relativo D, todos em ticks. A cada período a tarefa libera um
+ *          job com prazo absoluto `liberação + D`; entre as prontas de tempo real roda a
+ *          de prazo mais cedo (heap mínimo), e qualquer uma delas tem precedência sobre
+ *          as tarefas de melhor esforço do RR.
+ *
+ *          Admissão: a tarefa só entra na classe se a soma das densidades C/min(D,T)
+ *          continuar dentro do limite de utilização (teste suficiente para EDF; exato
+ *          quando D = T). Um job que consome C ticks sem terminar é suspenso até a
+ *          próxima liberação (orçamento), o que protege as demais tarefas admitidas.
+ *
+ *          Este módulo guarda os parâmetros, o heap e as métricas (folga e atraso dos
+ *          jobs em histogramas log2); as transições ficam em ks_sched.c.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_RT_H
+#define KS_RT_H
+
+#define KS_RT_HBUCKETS 8   /**< Faixas: 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+ ticks */
+
+/**
+ * @struct ks_rt_task
+ * @brief  Parâmetros e job corrente de uma tarefa (period = 0: melhor esforço).
+ */
+typedef struct ks_rt_task {
+  long period;       /**< T (ticks) */
+  long wcet;         /**< C (ticks) */
+  long deadline;     /**< D relativo (ticks) */
+  long release;      /**< Liberação do job corrente */
+  long next_rel;     /**< Próxima liberação (enquanto aguarda) */
+  long dl;           /**< Prazo absoluto usado no heap */
+  long job_dl;       /**< Prazo do job pendente, para medir o atraso */
+  long budget_base;  /**< CPU da tarefa quando o orçamento foi recarregado */
+  int  pending;      /**< Há job liberado e não concluído */
+  int  idle;         /**< Aguardando a próxima liberação (concluiu ou estourou C) */
+  int  heap_pos;     /**< Posição no heap (-1 = fora) */
+  long jobs;         /**< Jobs concluídos */
+  long misses;       /**< Jobs concluídos depois do prazo */
+  long overruns;     /**< Vezes em que o job esgotou o orçamento C */
+  long late_max;     /**< Maior atraso */
+  long resp_total;   /**< Soma dos tempos de resposta (liberação -> conclusão) */
+  long resp_max;     /**< Maior tempo de resposta */
+} ks_rt_task;
+
+/**
+ * @struct ks_rt_stats
+ * @brief  Métricas globais da classe.
+ */
+typedef struct ks_rt_stats {
+  long releases;                    /**< Jobs liberados */
+  long completions;                 /**< Jobs concluídos */
+  long misses;                      /**< Jobs concluídos depois do prazo */
+  long skipped;                     /**< Liberações perdidas porque o job anterior atrasou */
+  long overruns;                    /**< Jobs suspensos por esgotar o orçamento C */
+  long preemptions;                 /**< Preempções causadas por um prazo mais cedo */
+  long rejected;                    /**< Pedidos de admissão recusados */
+  long slack_hist[KS_RT_HBUCKETS];  /**< Folga (prazo - conclusão) dos jobs no prazo */
+  long late_hist[KS_RT_HBUCKETS];   /**< Atraso (conclusão - prazo) dos jobs perdidos */
+} ks_rt_stats;
+
+/**
+ * @struct ks_rt
+ * @brief  Estado da classe de tempo real.
+ */
+typedef struct ks_rt {
+  int         ntasks;
+  int         bound_pct;  /**< Limite de utilização da classe (% da CPU) */
+  double      util;       /**< Soma das densidades admitidas */
+  int         nrt;        /**< Tarefas admitidas */
+  ks_rt_task *t;          /**< Por tarefa */
+  int        *heap;       /**< Heap mínimo por (dl, idx) das prontas de tempo real */
+  int         nheap;
+  ks_rt_stats st;
+} ks_rt;
+
+/**
+ * @brief  Inicializa a classe sem tarefas admitidas.
+ * @param  bound_pct Limite de utilização em % (1..100).
+ * @return 0 em sucesso, -1 em falha.
+ */
+int  ks_rt_init(ks_rt *rt, int ntasks, int bound_pct);
+
+/**
+ * @brief  Libera a memória da classe.
+ */
+void ks_rt_destroy(ks_rt *rt);
+
+/**
+ * @brief  Pede a admissão da tarefa `idx` com período, WCET e prazo relativo.
+ * @param  deadline Prazo relativo (<= 0 usa o período).
+ * @return 0 se admitida, 1 se recusada pelo limite de utilização, -1 se inválida.
+ * @note   Deve ser chamada antes de a tarefa ficar pronta pela primeira vez.
+ */
+int  ks_rt_admit(ks_rt *rt, int idx, long period, long wcet, long deadline);
+
+/**
+ * @brief  1 se `idx` pertence à classe de tempo real.
+ */
+static inline int ks_rt_is(const ks_rt *rt, int idx) {
+  return rt && idx >= 0 && idx < rt->ntasks && rt->t[idx].period > 0;
+}
+
+/**
+ * @brief  1 se o job de `a` tem precedência sobre o de `b` (prazo mais cedo; empate
+ *         pelo menor índice).
+ */
+static inline int ks_rt_earlier(const ks_rt *rt, int a, int b) {
+  long da = rt->t[a].dl, db = rt->t[b].dl;
+  return (da != db) ? (da < db) : (a < b);
+}
+
+/**
+ * @brief  Tarefa de tempo real pronta com o prazo mais cedo, ou -1.
+ */
+static inline int ks_rt_top(const ks_rt *rt) { return rt->nheap > 0 ? rt->heap[0] : -1; }
+
+/**
+ * @brief  Insere/remove uma tarefa do heap de prontas (O(log n)).
+ */
+void ks_rt_push(ks_rt *rt, int idx);
+void ks_rt_remove(ks_rt *rt, int idx);
+
+/**
+ * @brief  Contabiliza a conclusão do job pendente de `idx` no tick `now`.
+ * @return Atraso (conclusão - prazo; <= 0 = no prazo).
+ */
+long ks_rt_complete(ks_rt *rt, int idx, long now);
+
+/**
+ * @brief  Faixa do histograma para um valor >= 0 (ver KS_RT_HBUCKETS).
+ */
+int  ks_rt_bucket(long v);
+
+#endif /* KS_RT_H */
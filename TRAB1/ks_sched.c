@@ -0,0 +1,601 @@
+/**
+ * @file    ks_sched.c
+ * @brief   Implementação do núcleo de escalonamento do KernelSim (libkernelsim).
+ * @details Mesma política do kernel original: RR por índice com quantum em ticks,
+ *          bloqueio da tarefa corrente por I/O e desbloqueio com prioridade no IRQ1.
+ *          Sono e prazos de I/O usam um temporizador por tarefa na roda hierárquica
+ *          (ks_timer.c), avançada a cada tick. Tarefas de tempo real (ks_rt.c) usam o
+ *          mesmo temporizador para aguardar a próxima liberação e o quantum como
+ *          orçamento do job.
+ *          A prioridade do IRQ1 é limitada por uma política (tempo mínimo garantido à
+ *          corrente e limite de impulsos seguidos por tarefa).
+ *          Com grupos (ks_cgroup.c), o tick de cada tarefa é cobrado do grupo dela; as
+ *          tarefas de um grupo que esgotou a cota saem do bitmap de prontas (sem sair
+ *          de READY) até a virada do período.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_sched.h"
+
+// ============================================================================
+// Bitmap de tarefas prontas
+// ============================================================================
+
+/**
+ * @brief  Retorna o primeiro bit ligado em [from, n) de um bitmap simples, ou -1.
+ */
+static int bm_next_from(const uint64_t *bm, int n, int from) {
+  if (from >= n) return -1;
+  int w = from >> 6;
+  uint64_t word = bm[w] & (~0ULL << (from & 63));
+  int nw = (n + 63) >> 6;
+  for (;;) {
+    if (word) {
+      int i = (w << 6) + __builtin_ctzll(word);
+      return (i < n) ? i : -1;
+    }
+    if (++w >= nw) return -1;
+    word = bm[w];
+  }
+}
+
+/**
+ * @brief  Próxima tarefa pronta em [from, lim), usando o resumo para pular palavras vazias.
+ */
+static int ready_next_from(const ks_sched *s, int lim, int from) {
+  if (from >= lim) return -1;
+  int w = from >> 6;
+  uint64_t word = s->ready[w] & (~0ULL << (from & 63));
+  if (!word) {
+    w = bm_next_from(s->summary, s->nwords, w + 1);
+    if (w < 0) return -1;
+    word = s->ready[w];
+  }
+  int i = (w << 6) + __builtin_ctzll(word);
+  return (i < lim) ? i : -1;
+}
+
+/**
+ * @brief  Põe (on=1) ou tira a tarefa de melhor esforço `idx` do bitmap de prontas.
+ */
+static void rq_set(ks_sched *s, int idx, int on) {
+  int w = idx >> 6;
+  if (on) {
+    s->ready[w] |= (1ULL << (idx & 63));
+    s->summary[w >> 6] |= (1ULL << (w & 63));
+    s->nready++;
+  } else {
+    s->ready[w] &= ~(1ULL << (idx & 63));
+    if (!s->ready[w]) s->summary[w >> 6] &= ~(1ULL << (w & 63));
+    s->nready--;
+  }
+}
+
+// ============================================================================
+// Classe de tempo real
+// ============================================================================
+
+/**
+ * @brief  Libera o job da tarefa `i` com liberação nominal `rel` e recarrega o orçamento.
+ * @details Se o job anterior ainda estava pendente (estourou o WCET), ele absorve esta
+ *          liberação: ganha o novo prazo para escalonar, mas o atraso continua medido
+ *          contra o prazo original.
+ */
+static void rt_release(ks_sched *s, int i, long rel) {
+  ks_rt *rt = s->rt;
+  ks_rt_task *t = &rt->t[i];
+  t->release = rel;
+  t->dl = rel + t->deadline;
+  t->idle = 0;
+  t->budget_base = s->cpu[i];
+  if (t->pending) { rt->st.skipped++; return; }
+  t->pending = 1;
+  t->job_dl = t->dl;
+  rt->st.releases++;
+}
+
+/**
+ * @brief  Tira a tarefa `i` (fora da CPU) de circulação até a próxima liberação.
+ * @details Liberações que já passaram inteiras são puladas; se a próxima já venceu,
+ *          o job é liberado na hora.
+ */
+static void rt_wait_next(ks_sched *s, int i) {
+  ks_rt_task *t = &s->rt->t[i];
+  long next = t->release + t->period;
+  while (next + t->period <= s->now) { next += t->period; s->rt->st.skipped++; }
+  if (next <= s->now) {
+    rt_release(s, i, next);
+    ks_set_state(s, i, ST_READY);
+    if (s->ops.release) s->ops.release(s->ctx, i);
+    return;
+  }
+  t->idle = 1;
+  t->next_rel = next;
+  ks_set_state(s, i, ST_SLEEPING);
+  ks_timer_arm(&s->wheel, &s->timers[i], (uint64_t)next);
+}
+
+/**
+ * @brief  1 se a tarefa `a` deve tomar a CPU de `b` (-1 = CPU livre).
+ * @details Tempo real vence melhor esforço; entre tempo real, o prazo mais cedo;
+ *          entre melhor esforço, `a` vence (regra de prioridade do IRQ1).
+ */
+static int outranks(const ks_sched *s, int a, int b) {
+  if (b < 0) return 1;
+  int ra = ks_rt_is(s->rt, a), rb = ks_rt_is(s->rt, b);
+  if (ra != rb) return ra;
+  return ra ? ks_rt_earlier(s->rt, a, b) : 1;
+}
+
+// ============================================================================
+// Temporizadores por tarefa
+// ============================================================================
+
+/**
+ * @brief  Expiração do temporizador de uma tarefa: fim do sono ou prazo de I/O.
+ */
+static void task_timer_fired(void *arg, ks_timer *t) {
+  ks_sched *s = (ks_sched*)arg;
+  int idx = (int)(t - s->timers);
+  if (s->state[idx] == ST_SLEEPING && ks_rt_is(s->rt, idx) && s->rt->t[idx].idle) {
+    rt_release(s, idx, s->rt->t[idx].next_rel);
+    ks_set_state(s, idx, ST_READY);
+    if (s->ops.release) s->ops.release(s->ctx, idx);
+  } else if (s->state[idx] == ST_SLEEPING) {
+    ks_set_state(s, idx, ST_READY);
+    s->stats.wakeups++;
+    if (s->ops.wake) s->ops.wake(s->ctx, idx);
+  } else if (s->state[idx] == ST_WAITING) {
+    ks_set_state(s, idx, ST_READY);
+    s->stats.io_timeouts++;
+    if (s->ops.io_timeout) s->ops.io_timeout(s->ctx, idx);
+  }
+}
+
+// ============================================================================
+// Ciclo de vida
+// ============================================================================
+
+int ks_init(ks_sched *s, int ntasks, int slice, const ks_ops *ops, void *ctx) {
+  if (!s || ntasks <= 0) return -1;
+  memset(s, 0, sizeof(*s));
+  s->ntasks = ntasks;
+  s->current = -1;
+  s->slice = (slice < 1) ? 1 : slice;
+  s->nwords = (ntasks + 63) / 64;
+  s->state = (int*)calloc((size_t)ntasks, sizeof(int));
+  s->ready = (uint64_t*)calloc((size_t)s->nwords, sizeof(uint64_t));
+  s->summary = (uint64_t*)calloc((size_t)(s->nwords + 63) / 64, sizeof(uint64_t));
+  s->timers = (ks_timer*)calloc((size_t)ntasks, sizeof(ks_timer));
+  s->run_start   = (long*)calloc((size_t)ntasks, sizeof(long));
+  s->burst       = (long*)calloc((size_t)ntasks, sizeof(long));
+  s->cpu         = (long*)calloc((size_t)ntasks, sizeof(long));
+  s->ready_since = (long*)calloc((size_t)ntasks, sizeof(long));
+  s->woke        = (char*)calloc((size_t)ntasks, sizeof(char));
+  s->boosts      = (int*)calloc((size_t)ntasks, sizeof(int));
+  s->held        = (char*)calloc((size_t)ntasks, sizeof(char));
+  if (!s->state || !s->ready || !s->summary || !s->timers || !s->run_start || !s->burst ||
+      !s->cpu || !s->ready_since || !s->woke || !s->boosts || !s->held) { ks_destroy(s); return -1; }
+  s->boost = -1;
+  s->rr_last = -1;
+  ks_wheel_init(&s->wheel, 1);
+  for (int i = 0; i < ntasks; i++) ks_timer_init(&s->timers[i], task_timer_fired, s);
+  if (ops) s->ops = *ops;
+  s->ctx = ctx;
+  return 0;
+}
+
+void ks_destroy(ks_sched *s) {
+  if (!s) return;
+  free(s->state); s->state = NULL;
+  free(s->ready); s->ready = NULL;
+  free(s->summary); s->summary = NULL;
+  free(s->timers); s->timers = NULL;
+  free(s->run_start);   s->run_start = NULL;
+  free(s->burst);       s->burst = NULL;
+  free(s->cpu);         s->cpu = NULL;
+  free(s->ready_since); s->ready_since = NULL;
+  free(s->woke);        s->woke = NULL;
+  free(s->boosts);      s->boosts = NULL;
+  free(s->held);        s->held = NULL;
+  s->ntasks = 0;
+  s->current = -1;
+}
+
+// ============================================================================
+// Estado e escolha
+// ============================================================================
+
+void ks_set_state(ks_sched *s, int idx, int st) {
+  if (idx < 0 || idx >= s->ntasks) return;
+  int prev = s->state[idx];
+  int was = (prev == ST_READY);
+  s->state[idx] = st;
+  if (s->cg && (st == ST_DONE) != (prev == ST_DONE)) ks_cg_set_live(s->cg, idx, st != ST_DONE);
+  if ((st == ST_READY) == was) return;
+  if (st == ST_READY) {
+    s->ready_since[idx] = s->now;
+    // Liberações de tempo real têm métrica própria (tempo de resposta do job)
+    s->woke[idx] = (prev == ST_WAITING || prev == ST_SLEEPING || prev == ST_BLOCKED) &&
+                   !ks_rt_is(s->rt, idx);
+  }
+
+  if (ks_rt_is(s->rt, idx)) {
+    if (st == ST_READY && prev == ST_NEW) rt_release(s, idx, s->now);
+    if (st == ST_READY) ks_rt_push(s->rt, idx); else ks_rt_remove(s->rt, idx);
+    return;
+  }
+
+  // Grupo limitado: a tarefa espera fora do bitmap até a virada do período
+  if (s->held[idx]) { s->nheld += (st == ST_READY) ? 1 : -1; return; }
+  rq_set(s, idx, st == ST_READY);
+}
+
+int ks_pick_after(const ks_sched *s, int after) {
+  if (s->rt && s->rt->nheap > 0) return ks_rt_top(s->rt);
+  if (s->nready <= 0) return -1;
+  int start = (after < 0) ? 0 : (after + 1) % s->ntasks;
+  int i = ready_next_from(s, s->ntasks, start);
+  if (i >= 0) return i;
+  return (start > 0) ? ready_next_from(s, start, 0) : -1;
+}
+
+int ks_pick_next(const ks_sched *s) { return ks_pick_after(s, s->current); }
+
+// ============================================================================
+// Rajadas de CPU e quantum
+// ============================================================================
+
+void ks_set_qtune(ks_sched *s, ks_qtune *qt) { s->qt = qt; }
+
+void ks_set_rt(ks_sched *s, ks_rt *rt) { s->rt = rt; }
+
+void ks_set_gang(ks_sched *s, ks_gang *g) { s->gang = g; }
+
+/**
+ * @brief  Acerta quem está retido depois de grupos serem limitados ou liberados.
+ */
+static void cg_sync(ks_sched *s) {
+  for (int i = 0; i < s->ntasks; i++) {
+    char h = (char)ks_cg_held(s->cg, i);
+    if (h == s->held[i]) continue;
+    s->held[i] = h;
+    if (s->state[i] != ST_READY || ks_rt_is(s->rt, i)) continue;
+    rq_set(s, i, !h);
+    s->nheld += h ? 1 : -1;
+  }
+}
+
+void ks_set_cgroups(ks_sched *s, ks_cgroups *cg) {
+  s->cg = cg;
+  if (!cg) return;
+  for (int i = 0; i < s->ntasks; i++) ks_cg_set_live(cg, i, s->state[i] != ST_DONE);
+  cg_sync(s);
+}
+
+void ks_set_unblock_policy(ks_sched *s, int min_run, int boost_cap) {
+  s->min_run = (min_run < 0) ? 0 : min_run;
+  s->boost_cap = (boost_cap < 0) ? 0 : boost_cap;
+}
+
+void ks_set_idle_dispatch(ks_sched *s, int on) {
+  s->idle_dispatch = (on != 0);
+}
+
+int ks_slice_for(const ks_sched *s, int idx) {
+  if (ks_rt_is(s->rt, idx)) {
+    const ks_rt_task *t = &s->rt->t[idx];
+    long left = t->wcet - (s->cpu[idx] - t->budget_base);
+    return (left < 1) ? 1 : (int)left;
+  }
+  int q = s->qt ? ks_qtune_quantum(s->qt, idx) : s->slice;
+  if (s->gang) q *= ks_gang_weight(s->gang, idx);
+  return s->cg ? q * ks_cg_weight(s->cg, idx) : q;
+}
+
+/**
+ * @brief  Contabiliza a CPU usada pela tarefa desde o último despacho.
+ */
+static void account_run(ks_sched *s, int i) {
+  long ran = s->now - s->run_start[i];
+  s->cpu[i] += ran;
+  s->burst[i] += ran;
+  s->run_start[i] = s->now;
+}
+
+/**
+ * @brief  Entrega uma amostra de rajada ao ajuste de quantum, se ligado.
+ */
+static void burst_sample(ks_sched *s, int i, long burst, int censored) {
+  // Tarefas de tempo real têm orçamento próprio e não entram no ajuste
+  if (!s->qt || ks_rt_is(s->rt, i) || !ks_qtune_sample(s->qt, i, burst, censored)) return;
+  if (s->ops.quantum) {
+    int who = (s->qt->mode == KS_Q_TASK) ? i : -1;
+    s->ops.quantum(s->ctx, who, ks_qtune_quantum(s->qt, i));
+  }
+}
+
+/**
+ * @brief  A tarefa saiu da CPU voluntariamente: fecha a rajada corrente.
+ */
+static void end_burst(ks_sched *s, int i) {
+  account_run(s, i);
+  burst_sample(s, i, s->burst[i], 0);
+  s->burst[i] = 0;
+  // Saída voluntária de melhor esforço: o rodízio recomeça do índice 0
+  if (!ks_rt_is(s->rt, i)) s->rr_last = -1;
+}
+
+// ============================================================================
+// Transições
+// ============================================================================
+
+void ks_dispatch(ks_sched *s, int idx) {
+  if (idx < 0) return;
+  long waited = s->now - s->ready_since[idx];
+  s->stats.ready_lat += waited;
+  s->stats.ready_n++;
+  if (s->woke[idx]) {
+    s->stats.wake_lat += waited;
+    s->stats.wake_n++;
+    if (waited > s->stats.wake_lat_max) s->stats.wake_lat_max = waited;
+    s->woke[idx] = 0;
+  }
+  s->current = idx;
+  if (!ks_rt_is(s->rt, idx)) s->rr_last = idx;
+  s->run_start[idx] = s->now;
+  s->boosts[idx] = 0;
+  if (s->boost == idx) s->boost = -1;
+  ks_set_state(s, idx, ST_RUNNING);
+  s->stats.dispatches++;
+  if (s->ops.dispatch) s->ops.dispatch(s->ctx, idx);
+}
+
+void ks_preempt(ks_sched *s) {
+  if (s->current < 0) return;
+  int i = s->current;
+  // Rajada interrompida: a real é maior do que o consumido até aqui
+  account_run(s, i);
+  burst_sample(s, i, s->burst[i] + ks_slice_for(s, i), 1);
+  ks_set_state(s, i, ST_READY);
+  s->current = -1;
+  s->stats.preemptions++;
+  if (s->ops.preempt) s->ops.preempt(s->ctx, i);
+}
+
+void ks_block_running(ks_sched *s, int io_type) {
+  ks_block_running_timeout(s, io_type, s->io_timeout);
+}
+
+void ks_block_running_timeout(ks_sched *s, int io_type, long timeout) {
+  if (s->current < 0) return;
+  int i = s->current;
+  end_burst(s, i);
+  ks_set_state(s, i, ST_WAITING);
+  s->current = -1;
+  s->stats.blocks++;
+  if (timeout > 0) ks_timer_arm(&s->wheel, &s->timers[i], (uint64_t)(s->now + timeout));
+  if (s->ops.block) s->ops.block(s->ctx, i, io_type);
+}
+
+void ks_sleep_running(ks_sched *s, long ticks) {
+  if (s->current < 0) return;
+  int i = s->current;
+  if (ticks < 1) ticks = 1;
+  end_burst(s, i);
+  ks_set_state(s, i, ST_SLEEPING);
+  s->current = -1;
+  s->stats.sleeps++;
+  ks_timer_arm(&s->wheel, &s->timers[i], (uint64_t)(s->now + ticks));
+  if (s->ops.sleep) s->ops.sleep(s->ctx, i, ticks);
+}
+
+void ks_park_running(ks_sched *s) {
+  if (s->current < 0) return;
+  int i = s->current;
+  end_burst(s, i);
+  ks_set_state(s, i, ST_BLOCKED);
+  s->current = -1;
+  s->stats.parks++;
+  if (s->ops.park) s->ops.park(s->ctx, i);
+}
+
+int ks_unpark(ks_sched *s, int idx) {
+  if (idx < 0 || idx >= s->ntasks || s->state[idx] != ST_BLOCKED) return 0;
+  ks_set_state(s, idx, ST_READY);
+  if (s->ops.unpark) s->ops.unpark(s->ctx, idx);
+  return 1;
+}
+
+int ks_job_done(ks_sched *s, long *late) {
+  int i = s->current;
+  if (i < 0 || !ks_rt_is(s->rt, i)) return -1;
+  end_burst(s, i);
+  long l = ks_rt_complete(s->rt, i, s->now);
+  if (late) *late = l;
+  s->current = -1;
+  // O job encerra o quantum: o próximo IRQ0 despacha mesmo sem idle_dispatch
+  s->slice_left = 0;
+  if (s->ops.job_done) s->ops.job_done(s->ctx, i, l);
+  rt_wait_next(s, i);
+  return 0;
+}
+
+int ks_start(ks_sched *s) {
+  int first = ks_pick_next(s);
+  if (first >= 0) { ks_dispatch(s, first); s->slice_left = ks_slice_for(s, first); }
+  return first;
+}
+
+void ks_tick(ks_sched *s) {
+  ks_clock_tick(s);
+  ks_slice_tick(s);
+}
+
+/**
+ * @brief  Cobra o tick que terminou do grupo da corrente e vira os períodos de cota.
+ */
+static void cg_tick(ks_sched *s) {
+  int cur = s->current;
+  uint32_t hit = 0, freed;
+  if (cur < 0 && s->nheld > 0) s->stats.cg_idle++;
+  if (cur >= 0 && !ks_rt_is(s->rt, cur)) hit = ks_cg_charge(s->cg, cur, s->now);
+  freed = ks_cg_refill(s->cg, s->now);
+  if (!(hit | freed)) return;
+  cg_sync(s);
+  if (!s->ops.cgroup) return;
+  for (int id = 0; id < s->cg->ngroups; id++) if (hit & (1u << id)) s->ops.cgroup(s->ctx, id, 1);
+  for (int id = 0; id < s->cg->ngroups; id++) if (freed & (1u << id)) s->ops.cgroup(s->ctx, id, 0);
+}
+
+void ks_clock_tick(ks_sched *s) {
+  s->now++;
+  s->stats.ticks++;
+  if (s->cg) cg_tick(s);
+  ks_wheel_advance(&s->wheel, (uint64_t)s->now);
+}
+
+/**
+ * @brief  Despacho na frente do rodízio (prioridade do IRQ1): conta o impulso.
+ */
+static void dispatch_boosted(ks_sched *s, int idx) {
+  int b = s->boosts[idx];
+  ks_dispatch(s, idx);
+  s->boosts[idx] = b + 1;
+  s->slice_left = ks_slice_for(s, idx);
+}
+
+void ks_slice_tick(ks_sched *s) {
+  int cur = s->current;
+  // Quem foi despachado neste mesmo tick (lote de IRQ1 tratado no IRQ0) ainda não rodou
+  if (s->slice_left > 0 && !(cur >= 0 && s->run_start[cur] == s->now)) s->slice_left--;
+  // Job de tempo real que esgotou o orçamento (WCET) sai até a próxima liberação
+  if (cur >= 0 && s->slice_left == 0 && ks_rt_is(s->rt, cur)) {
+    account_run(s, cur);
+    s->rt->t[cur].overruns++;
+    s->rt->st.overruns++;
+    s->current = -1;
+    if (s->ops.throttle) s->ops.throttle(s->ctx, cur);
+    rt_wait_next(s, cur);
+  }
+  // Grupo da corrente esgotou a cota: sai da CPU até a virada do período
+  int capped = (s->current >= 0 && s->held[s->current]);
+  if (capped) s->stats.cg_preempts++;
+  // Job de tempo real pronto com precedência sobre a corrente
+  int top = s->rt ? ks_rt_top(s->rt) : -1;
+  int urgent = (top >= 0 && s->current >= 0 && outranks(s, top, s->current));
+  if (urgent) s->rt->st.preemptions++;
+  // Desbloqueio adiado: a corrente já cumpriu o tempo mínimo garantido
+  int boost = s->boost;
+  if (boost >= 0 && (s->state[boost] != ST_READY || s->held[boost])) boost = s->boost = -1;
+  int due = (boost >= 0 && s->current >= 0 && s->now - s->run_start[s->current] >= s->min_run);
+  if (due && s->slice_left > 0 && !urgent && !capped) s->stats.io_preempts++;
+  // CPU livre (bloqueio, sono) só despacha antes do fim do quantum se idle_dispatch
+  int idle = (s->current < 0 && s->idle_dispatch);
+  if (s->slice_left == 0 || idle || urgent || due || capped) {
+    // O rodízio continua a partir de quem acabou de sair da CPU; se foi um job de tempo
+    // real, a partir da última de melhor esforço que ele interrompeu
+    int prev = s->current;
+    if (s->current >= 0) ks_preempt(s);
+    int nxt = ks_pick_after(s, (prev >= 0 && !ks_rt_is(s->rt, prev)) ? prev : s->rr_last);
+    if (boost >= 0 && !ks_rt_is(s->rt, nxt)) {
+      dispatch_boosted(s, boost);
+    } else if (nxt >= 0) {
+      ks_dispatch(s, nxt);
+      s->slice_left = ks_slice_for(s, nxt);
+    }
+  }
+}
+
+/**
+ * @brief  Aplica a prioridade do IRQ1 à tarefa `idx`, que acabou de ficar READY.
+ */
+static void unblock_preempt(ks_sched *s, int idx) {
+  if (s->held[idx]) return;   // grupo limitado: espera a virada do período
+  int top = s->rt ? ks_rt_top(s->rt) : -1;
+  if (!outranks(s, idx, s->current) || (top >= 0 && top != idx && !outranks(s, idx, top))) return;
+  int cur = s->current;
+  // Tempo real: a regra de prazos manda, sem tempo mínimo nem limite de impulsos
+  if (ks_rt_is(s->rt, idx)) {
+    if (cur >= 0) ks_preempt(s);
+    ks_dispatch(s, idx);
+    s->slice_left = ks_slice_for(s, idx);
+    return;
+  }
+  if (s->boost_cap > 0 && s->boosts[idx] >= s->boost_cap) { s->stats.io_capped++; return; }
+  if (cur >= 0 && s->now - s->run_start[cur] < s->min_run) {
+    if (s->boost < 0) { s->boost = idx; s->stats.io_deferred++; }
+    return;
+  }
+  if (cur >= 0) { ks_preempt(s); s->stats.io_preempts++; }
+  dispatch_boosted(s, idx);
+}
+
+/**
+ * @brief  Tira a tarefa de WAITING para READY (sem decidir preempção).
+ */
+static int io_unblock(ks_sched *s, int idx, int io_type) {
+  if (idx < 0 || idx >= s->ntasks || s->state[idx] != ST_WAITING) return 0;
+  ks_timer_cancel(&s->wheel, &s->timers[idx]);
+  s->stats.unblocks++;
+  ks_set_state(s, idx, ST_READY);
+  if (s->ops.unblock) s->ops.unblock(s->ctx, idx, io_type);
+  return 1;
+}
+
+int ks_io_complete(ks_sched *s, int idx, int io_type) {
+  if (!io_unblock(s, idx, io_type)) return 0;
+  unblock_preempt(s, idx);
+  return 1;
+}
+
+int ks_io_complete_batch(ks_sched *s, const int *idx, const int *io_type, int n) {
+  int woke = 0, best = -1;
+  for (int k = 0; k < n; k++) {
+    if (!io_unblock(s, idx[k], io_type[k])) continue;
+    woke++;
+    int i = idx[k];
+    if (s->held[i]) continue;
+    // Tempo real de prazo mais cedo; entre melhor esforço, a primeira a terminar
+    if (best < 0 || (ks_rt_is(s->rt, i) && (!ks_rt_is(s->rt, best) || ks_rt_earlier(s->rt, i, best))))
+      best = i;
+  }
+  if (best >= 0) unblock_preempt(s, best);
+  return woke;
+}
+
+int ks_spawn(ks_sched *s, int idx) {
+  if (idx < 0 || idx >= s->ntasks || (s->state[idx] != ST_NEW && s->state[idx] != ST_DONE)) return -1;
+  ks_timer_cancel(&s->wheel, &s->timers[idx]);
+  s->burst[idx] = 0;
+  s->cpu[idx] = 0;
+  s->woke[idx] = 0;
+  s->state[idx] = ST_NEW;
+  if (s->cg) { ks_cg_set_live(s->cg, idx, 1); s->held[idx] = (char)ks_cg_held(s->cg, idx); }
+  ks_set_state(s, idx, ST_READY);
+  return 0;
+}
+
+void ks_exit(ks_sched *s, int idx) {
+  if (idx < 0 || idx >= s->ntasks || s->state[idx] == ST_DONE) return;
+  ks_timer_cancel(&s->wheel, &s->timers[idx]);
+  if (s->current == idx) account_run(s, idx);
+  s->burst[idx] = 0;
+  ks_set_state(s, idx, ST_DONE);
+  if (s->current == idx) s->current = -1;
+  if (s->rr_last == idx) s->rr_last = -1;
+  s->stats.exits++;
+}
+
+int ks_alive(const ks_sched *s) {
+  int alive = 0;
+  for (int i = 0; i < s->ntasks; i++) if (s->state[i] != ST_DONE) alive++;
+  return alive;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file    ks_sched.h
+ * @brief   Núcleo de escalonamento do KernelSim (libkernelsim).
+ * @details Contém a lógica de escalonamento Round-Robin com bloqueio/desbloqueio por I/O,
+ *          separada de sinais, fork() e kill(). As ações de despacho são callbacks
+ *          abstratos (ks_ops): o executável `kernel` os implementa com SIGSTOP/SIGCONT
+ *          e FIFO, enquanto benchmarks e simulações rodam tudo no mesmo processo.
+ *
+ *          O tempo do núcleo é medido em ticks (um tick = um IRQ0).
+ *
+ *          Há duas classes: tempo real EDF (ks_rt.h, opcional) e melhor esforço (RR).
+ *          Qualquer tarefa de tempo real pronta tem precedência sobre as de melhor esforço.
+ *          Uma tarefa pode ter várias threads (ks_gang.h); o núcleo escalona a tarefa e
+ *          o grupo decide quais threads ocupam as CPUs simuladas.
+ *          Tarefas de melhor esforço podem pertencer a grupos com cota de CPU e pesos
+ *          (ks_cgroup.h): a tarefa de um grupo limitado continua READY, mas sai da fila
+ *          de prontos até a virada do período.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_SCHED_H
+#define KS_SCHED_H
+
+#include <stdint.h>
+
+#include "ks_timer.h"
+#include "ks_quantum.h"
+#include "ks_rt.h"
+#include "ks_gang.h"
+#include "ks_cgroup.h"
+
+enum { ST_NEW=0, ST_READY, ST_RUNNING, ST_WAITING, ST_DONE, ST_SLEEPING, ST_BLOCKED, ST_MIGRATING };
+
+/**
+ * @struct ks_ops
+ * @brief  Ações executadas pelo núcleo quando o estado de uma tarefa muda.
+ * @details Todos os campos são opcionais (NULL = nenhuma ação). São chamados depois
+ *          que o estado interno já foi atualizado (ks_set_state), inclusive unblock.
+ *          ks_spawn e ks_exit não têm callback: quem os chama já cuida do processo.
+ */
+typedef struct ks_ops {
+  void (*dispatch)(void *ctx, int idx);              /**< Tarefa ganhou a CPU */
+  void (*preempt)(void *ctx, int idx);               /**< Tarefa perdeu a CPU (volta a READY) */
+  void (*block)(void *ctx, int idx, int io_type);    /**< Tarefa bloqueou por I/O */
+  void (*unblock)(void *ctx, int idx, int io_type);  /**< I/O da tarefa concluído */
+  void (*sleep)(void *ctx, int idx, long ticks);     /**< Tarefa dormindo por `ticks` */
+  void (*wake)(void *ctx, int idx);                  /**< Sono terminou (volta a READY) */
+  void (*io_timeout)(void *ctx, int idx);            /**< Espera de I/O estourou o prazo */
+  void (*park)(void *ctx, int idx);                  /**< Tarefa bloqueou num objeto do núcleo */
+  void (*unpark)(void *ctx, int idx);                /**< Tarefa liberada do objeto (READY) */
+  void (*quantum)(void *ctx, int idx, int q);        /**< Quantum ajustado (idx=-1: global) */
+  void (*release)(void *ctx, int idx);               /**< Job de tempo real liberado (READY) */
+  void (*job_done)(void *ctx, int idx, long late);   /**< Job concluído (sai da CPU); atraso */
+  void (*throttle)(void *ctx, int idx);              /**< Job esgotou o WCET (sai da CPU) */
+  void (*cgroup)(void *ctx, int gid, int throttled); /**< Grupo limitado (1) ou liberado (0) */
+} ks_ops;
+
+/**
+ * @struct ks_stats
+ * @brief  Contadores acumulados pelo núcleo.
+ */
+typedef struct ks_stats {
+  long ticks;        /**< IRQ0 processados */
+  long dispatches;   /**< Despachos (trocas de contexto de entrada) */
+  long preemptions;  /**< Preempções */
+  long blocks;       /**< Bloqueios por I/O */
+  long unblocks;     /**< Desbloqueios por término de I/O */
+  long exits;        /**< Tarefas finalizadas */
+  long sleeps;       /**< Chamadas de sleep */
+  long wakeups;      /**< Despertares por temporizador */
+  long io_timeouts;  /**< Esperas de I/O encerradas por prazo */
+  long parks;        /**< Bloqueios em objetos do núcleo (mutex, semáforo, ...) */
+  long ready_lat;    /**< Soma das esperas na fila de prontos (ticks) */
+  long ready_n;      /**< Despachos contabilizados em ready_lat */
+  long wake_lat;     /**< Soma das esperas na fila de quem acabou de acordar (interativas) */
+  long wake_n;       /**< Despachos contabilizados em wake_lat */
+  long wake_lat_max; /**< Maior espera de uma tarefa recém-acordada */
+  long io_preempts;  /**< Preempções causadas por desbloqueio de I/O (na hora ou adiadas) */
+  long io_deferred;  /**< Desbloqueios que esperaram o tempo mínimo da corrente */
+  long io_capped;    /**< Desbloqueios sem prioridade por limite de impulsos da tarefa */
+  long cg_preempts;  /**< Preempções porque o grupo da corrente esgotou a cota */
+  long cg_idle;      /**< Ticks de CPU ociosa com tarefas prontas só em grupos limitados */
+} ks_stats;
+
+/**
+ * @struct ks_sched
+ * @brief  Estado do escalonador.
+ * @details As tarefas prontas de melhor esforço ficam num bitmap indexado por tarefa,
+ *          o que preserva a ordem circular por índice do RR original. Um segundo nível
+ *          (summary, um bit por palavra não vazia) permite achar a próxima pronta em
+ *          O(N/4096). As de tempo real ficam no heap de prazos de `rt`. Uma tarefa
+ *          READY de grupo limitado (`held`) fica fora do bitmap e de `nready`.
+ */
+typedef struct ks_sched {
+  int       ntasks;      /**< Número de tarefas */
+  int       current;     /**< Tarefa em execução, ou -1 */
+  int       rr_last;     /**< Última de melhor esforço despachada, -1 se saiu sozinha */
+  int       slice;       /**< Quantum em ticks */
+  int       slice_left;  /**< Ticks restantes do quantum atual */
+  long      now;         /**< Relógio do núcleo em ticks */
+  int      *state;       /**< Estado lógico de cada tarefa (ST_*) */
+  uint64_t *ready;       /**< Bitmap das tarefas em ST_READY */
+  uint64_t *summary;     /**< Bitmap das palavras não vazias de `ready` */
+  int       nwords;      /**< Palavras do bitmap */
+  int       nready;      /**< Tarefas de melhor esforço em ST_READY (fora as limitadas) */
+  int       nheld;       /**< Tarefas em ST_READY retidas por grupo limitado */
+  char     *held;        /**< 1 se o grupo da tarefa (ou um ancestral) está limitado */
+  ks_wheel  wheel;       /**< Roda de temporizadores (sono, prazos de I/O) */
+  ks_timer *timers;      /**< Temporizador de cada tarefa */
+  int       io_timeout;  /**< Prazo de espera por I/O em ticks (0 = sem prazo) */
+  long     *run_start;   /**< Tick do último despacho de cada tarefa */
+  long     *burst;       /**< CPU consumida na rajada corrente (ticks) */
+  long     *cpu;         /**< CPU total consumida (ticks) */
+  long     *ready_since; /**< Tick em que a tarefa entrou em READY */
+  char     *woke;        /**< 1 se a tarefa entrou em READY vinda de uma espera */
+  ks_qtune *qt;          /**< Ajuste automático do quantum (NULL = quantum fixo) */
+  ks_rt    *rt;          /**< Classe de tempo real (NULL = só melhor esforço) */
+  ks_gang  *gang;        /**< Threads e CPUs simuladas (NULL = uma thread por tarefa) */
+  ks_cgroups *cg;        /**< Grupos com cota e pesos (NULL = todas iguais) */
+  int       min_run;     /**< Ticks garantidos à corrente antes de um desbloqueio preemptá-la */
+  int       boost_cap;   /**< Impulsos seguidos por tarefa (0 = sem limite) */
+  int       boost;       /**< Desbloqueada esperando o min_run da corrente (-1 = nenhuma) */
+  int      *boosts;      /**< Impulsos seguidos de cada tarefa (zera num despacho comum) */
+  int       idle_dispatch; /**< 1 = CPU livre despacha no próximo IRQ0 (0 = espera o fim do quantum) */
+  ks_ops    ops;         /**< Callbacks de despacho */
+  void     *ctx;         /**< Contexto repassado aos callbacks */
+  ks_stats  stats;       /**< Contadores */
+} ks_sched;
+
+/**
+ * @brief  Inicializa o escalonador com todas as tarefas em ST_NEW.
+ * @param  s      Escalonador.
+ * @param  ntasks Número de tarefas (> 0).
+ * @param  slice  Quantum em ticks (>= 1).
+ * @param  ops    Callbacks (pode ser NULL).
+ * @param  ctx    Contexto repassado aos callbacks.
+ * @return 0 em sucesso, -1 em falha de alocação ou parâmetro inválido.
+ */
+int  ks_init(ks_sched *s, int ntasks, int slice, const ks_ops *ops, void *ctx);
+
+/**
+ * @brief  Libera a memória do escalonador.
+ */
+void ks_destroy(ks_sched *s);
+
+/**
+ * @brief  Define o estado lógico de uma tarefa, mantendo o bitmap de prontas.
+ */
+void ks_set_state(ks_sched *s, int idx, int st);
+
+/**
+ * @brief  Escolhe a próxima tarefa pronta: a de tempo real com prazo mais cedo, se
+ *         houver; senão a de melhor esforço em ordem circular a partir de `after`+1.
+ * @param  after Índice de referência (-1 começa do índice 0).
+ * @return Índice da tarefa, ou -1 se nenhuma estiver pronta.
+ */
+int  ks_pick_after(const ks_sched *s, int after);
+
+/**
+ * @brief  Escolhe a próxima tarefa pronta a partir da tarefa corrente.
+ */
+int  ks_pick_next(const ks_sched *s);
+
+/**
+ * @brief  Despacha uma tarefa (RUNNING) sem mexer no quantum.
+ */
+void ks_dispatch(ks_sched *s, int idx);
+
+/**
+ * @brief  Preempção: move a tarefa corrente de RUNNING para READY.
+ */
+void ks_preempt(ks_sched *s);
+
+/**
+ * @brief  Bloqueia a tarefa corrente por I/O (WAITING).
+ */
+void ks_block_running(ks_sched *s, int io_type);
+
+/**
+ * @brief  Bloqueia a tarefa corrente por I/O com prazo (timed-wait).
+ * @param  timeout Ticks até desistir da espera (<= 0 = sem prazo).
+ * @details Se o prazo vencer antes do IRQ1, a tarefa volta a READY e o callback
+ *          `io_timeout` é chamado.
+ */
+void ks_block_running_timeout(ks_sched *s, int io_type, long timeout);
+
+/**
+ * @brief  Syscall de sono: tira a tarefa corrente da CPU por `ticks` ticks (SLEEPING).
+ * @details O despertar entra na fila de prontos sem preemptar a tarefa corrente.
+ */
+void ks_sleep_running(ks_sched *s, long ticks);
+
+/**
+ * @brief  Bloqueia a tarefa corrente num objeto do núcleo (ST_BLOCKED).
+ * @details Quem chama é responsável por guardar a tarefa numa fila de espera e
+ *          liberá-la depois com ks_unpark().
+ */
+void ks_park_running(ks_sched *s);
+
+/**
+ * @brief  Libera uma tarefa ST_BLOCKED para a fila de prontos (sem preempção).
+ * @return 1 se a tarefa estava bloqueada, 0 caso contrário.
+ */
+int  ks_unpark(ks_sched *s, int idx);
+
+/**
+ * @brief  Liga o ajuste automático do quantum (NULL volta ao quantum fixo `slice`).
+ */
+void ks_set_qtune(ks_sched *s, ks_qtune *qt);
+
+/**
+ * @brief  Liga a classe de tempo real. As admissões (ks_rt_admit) devem ser feitas
+ *         antes de as tarefas ficarem prontas.
+ */
+void ks_set_rt(ks_sched *s, ks_rt *rt);
+
+/**
+ * @brief  Liga as tarefas com várias threads; com justiça por thread, o quantum de
+ *         melhor esforço de cada tarefa é multiplicado por ks_gang_weight().
+ */
+void ks_set_gang(ks_sched *s, ks_gang *g);
+
+/**
+ * @brief  Liga os grupos de tarefas: a cada tick a corrente é cobrada do grupo dela, e
+ *         o quantum de melhor esforço é multiplicado por ks_cg_weight(). Tarefas de
+ *         tempo real devem ficar na raiz.
+ */
+void ks_set_cgroups(ks_sched *s, ks_cgroups *cg);
+
+/**
+ * @brief  Política de preempção no desbloqueio de I/O (melhor esforço).
+ * @param  min_run   A corrente roda pelo menos isso (ticks) antes de ser preemptada
+ *                   por um desbloqueio; a desbloqueada espera na frente da fila e é
+ *                   despachada assim que o mínimo for cumprido (0 = na hora).
+ * @param  boost_cap Uma tarefa recebe no máximo isso de impulsos (despacho na frente
+ *                   do rodízio) seguidos; depois espera a vez normal, o que zera a
+ *                   contagem (0 = sem limite).
+ */
+void ks_set_unblock_policy(ks_sched *s, int min_run, int boost_cap);
+
+/**
+ * @brief  Despacho com a CPU livre. Por padrão (0), quando a corrente bloqueia, dorme
+ *         ou termina, a CPU fica ociosa até o fim do quantum dela, como no kernel
+ *         original; ligado (1), o próximo IRQ0 já despacha outra pronta.
+ */
+void ks_set_idle_dispatch(ks_sched *s, int on);
+
+/**
+ * @brief  A tarefa corrente (de tempo real) concluiu o job do período.
+ * @details Sai da CPU até a próxima liberação; se ela já passou, o próximo job é
+ *          liberado na hora (READY). Liberações que passaram inteiras enquanto o job
+ *          atrasado rodava são contadas como puladas.
+ * @param  late Se não for NULL, recebe o atraso do job (<= 0 = no prazo).
+ * @return 0 em sucesso, -1 se a corrente não é de tempo real (nada muda).
+ */
+int  ks_job_done(ks_sched *s, long *late);
+
+/**
+ * @brief  Quantum (ticks) que a tarefa `idx` recebe ao ser despachada; para tarefas
+ *         de tempo real, o orçamento que resta ao job.
+ */
+int  ks_slice_for(const ks_sched *s, int idx);
+
+/**
+ * @brief  Despacha a primeira tarefa pronta e arma o quantum.
+ * @return Índice despachado, ou -1.
+ */
+int  ks_start(ks_sched *s);
+
+/**
+ * @brief  Trata um IRQ0: ks_clock_tick() seguido de ks_slice_tick().
+ */
+void ks_tick(ks_sched *s);
+
+/**
+ * @brief  Primeira metade do IRQ0: avança o relógio, cobra o tick da corrente do grupo
+ *         dela, vira os períodos de cota e dispara temporizadores vencidos.
+ * @details Quem embute o núcleo pode tratar syscalls entre as duas metades, para que
+ *          elas já enxerguem o tick novo.
+ */
+void ks_clock_tick(ks_sched *s);
+
+/**
+ * @brief  Segunda metade do IRQ0: rodízio quando o quantum expira ou a CPU está livre,
+ *         suspensão do job que esgotou o WCET, preempção por prazo mais cedo e saída
+ *         da corrente cujo grupo esgotou a cota.
+ * @details Depois de um job de tempo real, o rodízio segue a partir da tarefa de
+ *          melhor esforço que ele interrompeu (`rr_last`), e não do índice 0; sem isso
+ *          janelas curtas entre jobs iam sempre para a de menor índice.
+ */
+void ks_slice_tick(ks_sched *s);
+
+/**
+ * @brief  Trata um IRQ1: desbloqueia a tarefa com prioridade (preempta a corrente).
+ * @details A prioridade não passa por cima da classe de tempo real: uma tarefa de
+ *          melhor esforço só é despachada na hora se nenhuma de tempo real estiver
+ *          rodando ou pronta; uma de tempo real, se tiver o prazo mais cedo.
+ *          A preempção segue ks_set_unblock_policy().
+ * @return 1 se a tarefa estava em WAITING (despachada ou deixada em READY), 0 caso contrário.
+ */
+int  ks_io_complete(ks_sched *s, int idx, int io_type);
+
+/**
+ * @brief  Trata um lote de IRQ1 coalescidos (ver ks_irq.h).
+ * @details Todas as tarefas vão para READY, mas no máximo uma ganha a prioridade (a de
+ *          tempo real de prazo mais cedo, senão a primeira a terminar), então o lote
+ *          custa no máximo uma preempção.
+ * @return Quantas tarefas estavam em WAITING.
+ */
+int  ks_io_complete_batch(ks_sched *s, const int *idx, const int *io_type, int n);
+
+/**
+ * @brief  Reocupa um slot livre (ST_NEW ou ST_DONE) com uma tarefa nova, já pronta.
+ * @details Zera a contabilidade de CPU do slot. Não deve ser usado em slots da classe
+ *          de tempo real.
+ * @return 0 em sucesso, -1 se o slot estiver ocupado.
+ */
+int  ks_spawn(ks_sched *s, int idx);
+
+/**
+ * @brief  Marca uma tarefa como finalizada (ST_DONE).
+ */
+void ks_exit(ks_sched *s, int idx);
+
+/**
+ * @brief  Retorna quantas tarefas ainda não terminaram.
+ */
+int  ks_alive(const ks_sched *s);
+
+#endif /* KS_SCHED_H */
@@ -0,0 +1,70 @@
+/**
+ * @file    ks_shm.h
+ * @brief   Layout da SHM compartilhada entre Kernel, InterController e APPs.
+ * @details Cada executável mapeia o mesmo segmento e precisa da mesma estrutura: ela
+ *          fica só aqui, dimensionada por MAXN e KS_GANG_MAXTHR, e todos a incluem.
+ *          Só tipos e constantes; nada daqui exige ligar com a libkernelsim.
+ *
+ *          Antes, o InterController e cada APP (app_sleep, app_lock, app_rt, app_pipe,
+ *          app_mt, app_job, app_io) traziam uma cópia própria, com tamanhos literais,
+ *          enquanto o kernel crescia a dele: uma cópia desatualizada desloca os campos
+ *          seguintes (o PIC fica no fim) sem nenhum erro de compilação.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_SHM_H
+#define KS_SHM_H
+
+#include <sys/types.h>
+
+#include "ks_gang.h"
+#include "ks_pic.h"
+
+#define MAXN  6   /**< Tarefas (vagas) por kernel */
+
+/**
+ * @struct shm_data
+ * @brief  Estrutura compartilhada entre Kernel, APPs e InterController.
+ * @details Mantém estado dos processos e dispositivos de I/O em memória compartilhada.
+ */
+struct shm_data {
+  int  nprocs;               /**< Número total de processos */
+  pid_t app_pid[MAXN];       /**< PIDs das aplicações */
+  int  pc[MAXN];             /**< Contadores de programa */
+  int  want_io[MAXN];        /**< Flags de pedido de I/O */
+  int  io_type[MAXN];        /**< Tipo de I/O (0=READ, 1=WRITE) */
+  int  done;                 /**< Flag de término global */
+
+  int  d1_busy;              /**< Estado do dispositivo 1 */
+  pid_t io_inflight_pid;     /**< PID do processo em I/O */
+  pid_t io_done_pid;         /**< PID do processo cujo I/O terminou */
+  int   io_done_type;        /**< Tipo do I/O concluído */
+
+  int  want_sys[MAXN];       /**< Flags de chamada de sistema pendente */
+  int  sys_num[MAXN];        /**< Número da chamada (SYS_*) */
+  int  sys_arg[MAXN][3];     /**< Argumentos da chamada */
+  int  sys_ret[MAXN];        /**< Valor de retorno da chamada */
+
+  int  chan_shmid;           /**< Segmento dos buffers dos canais (ks_chan_buf) */
+  int  chan_in[MAXN];        /**< Canal de entrada da tarefa (atributo ch=, -1 = nenhum) */
+  int  chan_out[MAXN];       /**< Canal de saída da tarefa (-1 = nenhum) */
+
+  int  thr_n[MAXN];                      /**< Threads da tarefa (atributo thr=, 0 = uma só) */
+  int  thr_run[MAXN][KS_GANG_MAXTHR];    /**< 1 = a thread tem CPU (futex em que ela espera) */
+  int  thr_state[MAXN][KS_GANG_MAXTHR];  /**< Estado de cada thread (KS_THR_*, escrito pela APP) */
+  int  thr_pc[MAXN][KS_GANG_MAXTHR];     /**< pc de cada thread */
+
+  int  cpu_freq;             /**< Frequência da CPU (% da máxima, -F; 0 = modelo desligado) */
+  int  jobs[MAXN];           /**< Jobs concluídos pela tarefa (escrito pela APP) */
+  int  job_ms[MAXN];         /**< Soma das durações dos jobs (ms, escrito pela APP) */
+
+  int  io_blk[MAXN];         /**< Bloco do pedido de I/O (-K; APPs que não escrevem usam o 0) */
+
+  ks_pic pic;                /**< Controlador de interrupções (linhas pendentes e máscaras) */
+};
+
+#endif /* KS_SHM_H */
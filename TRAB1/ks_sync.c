@@ -0,0 +1,290 @@
+/**
+ * @file    ks_sync.c
+ * @brief   Implementação dos objetos de sincronização do núcleo (libkernelsim).
+ * @details As filas de espera são listas simplesmente encadeadas por índice de tarefa
+ *          (`next`), já que uma tarefa espera em no máximo um objeto por vez. A variável
+ *          de condição usa "wait morphing": o signal move a tarefa direto para a fila do
+ *          mutex associado, sem acordá-la só para bloquear de novo.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ks_sync.h"
+
+// ============================================================================
+// Filas de espera
+// ============================================================================
+
+static void wq_push(ks_sync *sy, int id, int idx) {
+  ks_syncobj *o = &sy->obj[id];
+  sy->next[idx] = -1;
+  if (o->tail < 0) o->head = idx; else sy->next[o->tail] = idx;
+  o->tail = idx;
+  o->nwait++;
+  if (o->nwait > o->st.max_waiters) o->st.max_waiters = o->nwait;
+  sy->waiting_on[idx] = id;
+  sy->wait_since[idx] = sy->s->now;
+}
+
+static int wq_pop(ks_sync *sy, int id) {
+  ks_syncobj *o = &sy->obj[id];
+  int idx = o->head;
+  if (idx < 0) return -1;
+  o->head = sy->next[idx];
+  if (o->head < 0) o->tail = -1;
+  o->nwait--;
+  sy->next[idx] = -1;
+  sy->waiting_on[idx] = -1;
+  return idx;
+}
+
+static void wq_remove(ks_sync *sy, int id, int idx) {
+  ks_syncobj *o = &sy->obj[id];
+  int prev = -1;
+  for (int i = o->head; i >= 0; prev = i, i = sy->next[i]) {
+    if (i != idx) continue;
+    if (prev < 0) o->head = sy->next[i]; else sy->next[prev] = sy->next[i];
+    if (o->tail == i) o->tail = prev;
+    o->nwait--;
+    break;
+  }
+  sy->next[idx] = -1;
+  sy->waiting_on[idx] = -1;
+}
+
+// ============================================================================
+// Auxiliares
+// ============================================================================
+
+/**
+ * @brief  Retorna o objeto `id` do tipo `kind`, criando-o se ainda estiver livre.
+ */
+static ks_syncobj *get_obj(ks_sync *sy, int id, int kind) {
+  if (id < 0 || id >= sy->nobj) return NULL;
+  ks_syncobj *o = &sy->obj[id];
+  if (o->kind == KS_SYNC_FREE && ks_sync_create(sy, id, kind, 1) != 0) return NULL;
+  return (o->kind == kind) ? o : NULL;
+}
+
+/**
+ * @brief  Libera uma tarefa da fila de `id` (handoff), contabilizando a espera.
+ */
+static void grant(ks_sync *sy, int id, int idx) {
+  ks_syncobj *o = &sy->obj[id];
+  long now = sy->s->now;
+  o->st.wait_total += now - sy->wait_since[idx];
+  o->st.handoffs++;
+  sy->granted_at[idx] = now;
+  sy->granted_obj[idx] = id;
+  ks_unpark(sy->s, idx);
+}
+
+/**
+ * @brief  Dá o mutex `id` (livre) à tarefa `idx`.
+ */
+static void mutex_take(ks_sync *sy, int id, int idx) {
+  ks_syncobj *o = &sy->obj[id];
+  o->owner = idx;
+  o->acquired_at = sy->s->now;
+  o->st.acquires++;
+}
+
+/**
+ * @brief  Solta o mutex `id` e o entrega ao primeiro da fila, se houver.
+ */
+static void mutex_release(ks_sync *sy, int id) {
+  ks_syncobj *o = &sy->obj[id];
+  long hold = sy->s->now - o->acquired_at;
+  o->st.hold_total += hold;
+  if (hold > o->st.hold_max) o->st.hold_max = hold;
+  o->st.releases++;
+
+  int w = wq_pop(sy, id);
+  if (w < 0) { o->owner = -1; return; }
+  mutex_take(sy, id, w);
+  grant(sy, id, w);
+}
+
+// ============================================================================
+// Ciclo de vida
+// ============================================================================
+
+int ks_sync_init(ks_sync *sy, ks_sched *s, int nobj) {
+  if (!sy || !s || nobj <= 0) return -1;
+  memset(sy, 0, sizeof(*sy));
+  sy->s = s;
+  sy->nobj = nobj;
+  int n = s->ntasks;
+  sy->obj         = (ks_syncobj*)calloc((size_t)nobj, sizeof(ks_syncobj));
+  sy->next        = (int*)malloc((size_t)n * sizeof(int));
+  sy->waiting_on  = (int*)malloc((size_t)n * sizeof(int));
+  sy->cond_mutex  = (int*)malloc((size_t)n * sizeof(int));
+  sy->wait_since  = (long*)calloc((size_t)n, sizeof(long));
+  sy->granted_at  = (long*)malloc((size_t)n * sizeof(long));
+  sy->granted_obj = (int*)calloc((size_t)n, sizeof(int));
+  if (!sy->obj || !sy->next || !sy->waiting_on || !sy->cond_mutex ||
+      !sy->wait_since || !sy->granted_at || !sy->granted_obj) {
+    ks_sync_destroy(sy);
+    return -1;
+  }
+  for (int i = 0; i < n; i++) {
+    sy->next[i] = sy->waiting_on[i] = sy->cond_mutex[i] = -1;
+    sy->granted_at[i] = -1;
+  }
+  return 0;
+}
+
+void ks_sync_destroy(ks_sync *sy) {
+  if (!sy) return;
+  free(sy->obj);         sy->obj = NULL;
+  free(sy->next);        sy->next = NULL;
+  free(sy->waiting_on);  sy->waiting_on = NULL;
+  free(sy->cond_mutex);  sy->cond_mutex = NULL;
+  free(sy->wait_since);  sy->wait_since = NULL;
+  free(sy->granted_at);  sy->granted_at = NULL;
+  free(sy->granted_obj); sy->granted_obj = NULL;
+  sy->nobj = 0;
+}
+
+int ks_sync_create(ks_sync *sy, int id, int kind, int value) {
+  if (id < 0 || id >= sy->nobj || kind <= KS_SYNC_FREE || kind > KS_SYNC_COND) return -1;
+  ks_syncobj *o = &sy->obj[id];
+  if (o->kind != KS_SYNC_FREE) return (o->kind == kind) ? 0 : -1;
+  memset(o, 0, sizeof(*o));
+  o->kind = kind;
+  o->owner = -1;
+  o->head = o->tail = -1;
+  o->count = (value < 0) ? 0 : value;
+  return 0;
+}
+
+// ============================================================================
+// Mutex
+// ============================================================================
+
+int ks_mutex_lock(ks_sync *sy, int id) {
+  int cur = sy->s->current;
+  ks_syncobj *o = get_obj(sy, id, KS_SYNC_MUTEX);
+  if (!o || cur < 0 || o->owner == cur) return -1;
+  if (o->owner < 0) { mutex_take(sy, id, cur); return 0; }
+
+  o->st.contended++;
+  wq_push(sy, id, cur);
+  ks_park_running(sy->s);
+  return 1;
+}
+
+int ks_mutex_unlock(ks_sync *sy, int id) {
+  int cur = sy->s->current;
+  ks_syncobj *o = get_obj(sy, id, KS_SYNC_MUTEX);
+  if (!o || cur < 0 || o->owner != cur) return -1;
+  mutex_release(sy, id);
+  return 0;
+}
+
+// ============================================================================
+// Semáforo
+// ============================================================================
+
+int ks_sem_wait(ks_sync *sy, int id) {
+  int cur = sy->s->current;
+  ks_syncobj *o = get_obj(sy, id, KS_SYNC_SEM);
+  if (!o || cur < 0) return -1;
+  if (o->count > 0) { o->count--; o->st.acquires++; return 0; }
+
+  o->st.contended++;
+  wq_push(sy, id, cur);
+  ks_park_running(sy->s);
+  return 1;
+}
+
+int ks_sem_post(ks_sync *sy, int id) {
+  ks_syncobj *o = get_obj(sy, id, KS_SYNC_SEM);
+  if (!o) return -1;
+  int w = wq_pop(sy, id);
+  if (w < 0) { o->count++; return 0; }
+  o->st.acquires++;
+  grant(sy, id, w);
+  return 0;
+}
+
+// ============================================================================
+// Variável de condição
+// ============================================================================
+
+int ks_cond_wait(ks_sync *sy, int cond, int mutex) {
+  int cur = sy->s->current;
+  ks_syncobj *oc = get_obj(sy, cond, KS_SYNC_COND);
+  if (!oc || cur < 0 || mutex < 0 || mutex >= sy->nobj) return -1;
+  ks_syncobj *om = &sy->obj[mutex];
+  if (om->kind != KS_SYNC_MUTEX || om->owner != cur) return -1;
+
+  mutex_release(sy, mutex);
+  sy->cond_mutex[cur] = mutex;
+  wq_push(sy, cond, cur);
+  ks_park_running(sy->s);
+  return 1;
+}
+
+/**
+ * @brief  Acorda um esperador da condição: ele só volta a rodar dono do mutex.
+ * @return 1 se havia esperador, 0 caso contrário.
+ */
+static int cond_wake_one(ks_sync *sy, int cond) {
+  int w = wq_pop(sy, cond);
+  if (w < 0) return 0;
+  int m = sy->cond_mutex[w];
+  sy->cond_mutex[w] = -1;
+  ks_syncobj *om = &sy->obj[m];
+  if (om->owner < 0) {
+    sy->wait_since[w] = sy->s->now;
+    mutex_take(sy, m, w);
+    grant(sy, m, w);
+  } else {
+    om->st.contended++;
+    wq_push(sy, m, w);
+  }
+  return 1;
+}
+
+int ks_cond_signal(ks_sync *sy, int cond) {
+  if (!get_obj(sy, cond, KS_SYNC_COND)) return -1;
+  cond_wake_one(sy, cond);
+  return 0;
+}
+
+int ks_cond_broadcast(ks_sync *sy, int cond) {
+  if (!get_obj(sy, cond, KS_SYNC_COND)) return -1;
+  while (cond_wake_one(sy, cond)) { }
+  return 0;
+}
+
+// ============================================================================
+// Integração com o despacho e término de tarefas
+// ============================================================================
+
+void ks_sync_on_dispatch(ks_sync *sy, int idx) {
+  if (idx < 0 || idx >= sy->s->ntasks || sy->granted_at[idx] < 0) return;
+  ks_lock_stats *st = &sy->obj[sy->granted_obj[idx]].st;
+  long lat = sy->s->now - sy->granted_at[idx];
+  st->handoff_total += lat;
+  if (lat > st->handoff_max) st->handoff_max = lat;
+  st->handoff_samples++;
+  sy->granted_at[idx] = -1;
+}
+
+void ks_sync_task_exit(ks_sync *sy, int idx) {
+  if (idx < 0 || idx >= sy->s->ntasks) return;
+  if (sy->waiting_on[idx] >= 0) wq_remove(sy, sy->waiting_on[idx], idx);
+  sy->cond_mutex[idx] = -1;
+  sy->granted_at[idx] = -1;
+  for (int id = 0; id < sy->nobj; id++) {
+    if (sy->obj[id].kind == KS_SYNC_MUTEX && sy->obj[id].owner == idx) mutex_release(sy, id);
+  }
+}
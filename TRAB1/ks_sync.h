@@ -0,0 +1,117 @@
+/**
+ * @file    ks_sync.h
+ * @brief   Objetos de sincronização do núcleo (mutex, semáforo, variável de condição).
+ * @details Cada objeto tem uma fila de espera FIFO (encadeada por tarefa, O(1) para
+ *          entrar e sair). Operações que bloqueiam tiram a tarefa corrente da CPU com
+ *          ks_park_running(); quem é liberado volta à fila de prontos com ks_unpark().
+ *
+ *          O mutex é entregue diretamente ao primeiro da fila no unlock (handoff), sem
+ *          disputa com quem chegar depois. Para cada objeto são contados: aquisições,
+ *          aquisições com contenção, máximo de tarefas na fila, tempo de posse, tempo
+ *          de espera e latência de handoff (do unlock até o novo dono ganhar a CPU).
+ *          Tempos em ticks do escalonador.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_SYNC_H
+#define KS_SYNC_H
+
+#include "ks_sched.h"
+
+enum { KS_SYNC_FREE=0, KS_SYNC_MUTEX, KS_SYNC_SEM, KS_SYNC_COND };
+
+/**
+ * @struct ks_lock_stats
+ * @brief  Métricas de contenção de um objeto.
+ */
+typedef struct ks_lock_stats {
+  long acquires;         /**< Aquisições (mutex) ou passagens (semáforo) */
+  long contended;        /**< Aquisições que precisaram esperar */
+  int  max_waiters;      /**< Maior tamanho da fila de espera */
+  long hold_total;       /**< Soma dos tempos de posse (mutex) */
+  long hold_max;         /**< Maior tempo de posse (mutex) */
+  long releases;         /**< Liberações contabilizadas em hold_* */
+  long wait_total;       /**< Soma dos tempos de espera na fila */
+  long handoffs;         /**< Entregas diretas a tarefas em espera */
+  long handoff_total;    /**< Soma das latências de handoff medidas */
+  long handoff_max;      /**< Maior latência de handoff */
+  long handoff_samples;  /**< Handoffs cuja latência já foi medida */
+} ks_lock_stats;
+
+/**
+ * @struct ks_syncobj
+ * @brief  Um objeto de sincronização.
+ */
+typedef struct ks_syncobj {
+  int  kind;         /**< KS_SYNC_* */
+  int  owner;        /**< Dono do mutex (-1 = livre) */
+  int  count;        /**< Valor do semáforo */
+  int  head, tail;   /**< Fila de espera FIFO (índices de tarefa, -1 = vazia) */
+  int  nwait;        /**< Tarefas na fila */
+  long acquired_at;  /**< Tick em que o dono atual adquiriu o mutex */
+  ks_lock_stats st;  /**< Métricas */
+} ks_syncobj;
+
+/**
+ * @struct ks_sync
+ * @brief  Tabela de objetos ligada a um escalonador.
+ */
+typedef struct ks_sync {
+  ks_sched   *s;           /**< Escalonador dono das tarefas */
+  int         nobj;        /**< Tamanho da tabela */
+  ks_syncobj *obj;         /**< Objetos */
+  int        *next;        /**< Próxima tarefa na mesma fila (por tarefa) */
+  int        *waiting_on;  /**< Objeto em que a tarefa espera (-1 = nenhum) */
+  int        *cond_mutex;  /**< Mutex a readquirir após acordar de uma condição */
+  long       *wait_since;  /**< Tick em que a tarefa entrou na fila */
+  long       *granted_at;  /**< Tick do handoff pendente de medição (-1 = nenhum) */
+  int        *granted_obj; /**< Objeto do handoff pendente */
+} ks_sync;
+
+/**
+ * @brief  Cria uma tabela com `nobj` objetos livres para as tarefas de `s`.
+ * @return 0 em sucesso, -1 em falha.
+ */
+int  ks_sync_init(ks_sync *sy, ks_sched *s, int nobj);
+
+/**
+ * @brief  Libera a tabela.
+ */
+void ks_sync_destroy(ks_sync *sy);
+
+/**
+ * @brief  Cria explicitamente um objeto (ex.: semáforo com valor inicial).
+ * @return 0 em sucesso, -1 se o id for inválido ou já estiver em uso com outro tipo.
+ */
+int  ks_sync_create(ks_sync *sy, int id, int kind, int value);
+
+/**
+ * @brief  Operações da tarefa corrente. Retornam 0 se concluíram sem bloquear,
+ *         1 se a tarefa foi bloqueada (a operação conclui quando for liberada)
+ *         e -1 em uso inválido (id/tipo errado, unlock sem ser dono, ...).
+ * @details Objetos ainda livres são criados no primeiro uso; semáforos criados assim
+ *          começam com valor 1.
+ */
+int  ks_mutex_lock(ks_sync *sy, int id);
+int  ks_mutex_unlock(ks_sync *sy, int id);
+int  ks_sem_wait(ks_sync *sy, int id);
+int  ks_sem_post(ks_sync *sy, int id);
+int  ks_cond_wait(ks_sync *sy, int cond, int mutex);
+int  ks_cond_signal(ks_sync *sy, int cond);
+int  ks_cond_broadcast(ks_sync *sy, int cond);
+
+/**
+ * @brief  Deve ser chamado a cada despacho, para medir a latência de handoff.
+ */
+void ks_sync_on_dispatch(ks_sync *sy, int idx);
+
+/**
+ * @brief  Limpa o rastro de uma tarefa que terminou: sai de filas e solta mutexes.
+ */
+void ks_sync_task_exit(ks_sync *sy, int idx);
+
+#endif /* KS_SYNC_H */
@@ -0,0 +1,132 @@
+/**
+ * @file    ks_timer.c
+ * @brief   Implementação da roda de temporizadores hierárquica da libkernelsim.
+ * @details `now` é o próximo tick a processar. Um temporizador a `d` ticks de `now`
+ *          fica no menor nível que comporta `d`, na posição dada pelos bits do prazo
+ *          daquele nível. Quando o nível 0 completa uma volta, a posição corrente do
+ *          nível 1 é redistribuída (cascata), e assim por diante.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stddef.h>
+
+#include "ks_timer.h"
+
+/** Maior distância representável (exclusive) a partir de `now`. */
+#define KS_WHEEL_SPAN ((uint64_t)1 << (KS_WHEEL_BITS * KS_WHEEL_LEVELS))
+
+static inline void list_init(ks_timer *h) { h->next = h->prev = h; }
+
+static inline void list_add_tail(ks_timer *h, ks_timer *t) {
+  t->prev = h->prev; t->next = h;
+  h->prev->next = t; h->prev = t;
+}
+
+static inline void list_unlink(ks_timer *t) {
+  t->prev->next = t->next;
+  t->next->prev = t->prev;
+  t->next = t->prev = NULL;
+}
+
+void ks_wheel_init(ks_wheel *w, uint64_t now) {
+  w->now = now;
+  w->armed = w->fired = w->cascaded = 0;
+  for (int l = 0; l < KS_WHEEL_LEVELS; l++)
+    for (int i = 0; i < KS_WHEEL_SIZE; i++) list_init(&w->slot[l][i]);
+}
+
+void ks_timer_init(ks_timer *t, ks_timer_fn fn, void *arg) {
+  t->next = t->prev = NULL;
+  t->expires = 0;
+  t->fn = fn;
+  t->arg = arg;
+}
+
+/**
+ * @brief  Coloca o temporizador na posição correspondente ao seu prazo.
+ */
+static void wheel_place(ks_wheel *w, ks_timer *t) {
+  uint64_t exp = t->expires;
+  if (exp < w->now) exp = w->now;                       // vencido: próximo tick
+  uint64_t delta = exp - w->now;
+  if (delta >= KS_WHEEL_SPAN) exp = w->now + KS_WHEEL_SPAN - 1;  // fica no topo e volta a cascatear
+
+  int level = 0;
+  delta = exp - w->now;
+  while (level < KS_WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (KS_WHEEL_BITS * (level + 1))))
+    level++;
+  int idx = (int)((exp >> (KS_WHEEL_BITS * level)) & KS_WHEEL_MASK);
+  list_add_tail(&w->slot[level][idx], t);
+}
+
+void ks_timer_arm(ks_wheel *w, ks_timer *t, uint64_t expires) {
+  if (ks_timer_pending(t)) list_unlink(t);
+  else w->armed++;
+  t->expires = expires;
+  wheel_place(w, t);
+}
+
+int ks_timer_cancel(ks_wheel *w, ks_timer *t) {
+  if (!ks_timer_pending(t)) return 0;
+  list_unlink(t);
+  w->armed--;
+  return 1;
+}
+
+/**
+ * @brief  Redistribui a posição `idx` do nível `level` nos níveis inferiores.
+ * @return O próprio `idx` (0 indica que o nível seguinte também deu a volta).
+ */
+static int cascade(ks_wheel *w, int level, int idx) {
+  ks_timer *h = &w->slot[level][idx];
+  ks_timer tmp; list_init(&tmp);
+  if (h->next != h) {
+    tmp.next = h->next; tmp.prev = h->prev;
+    tmp.next->prev = &tmp; tmp.prev->next = &tmp;
+    list_init(h);
+  }
+  while (tmp.next != &tmp) {
+    ks_timer *t = tmp.next;
+    list_unlink(t);
+    wheel_place(w, t);
+    w->cascaded++;
+  }
+  return idx;
+}
+
+int ks_wheel_advance(ks_wheel *w, uint64_t now) {
+  int fired = 0;
+  while (w->now <= now) {
+    int idx = (int)(w->now & KS_WHEEL_MASK);
+    if (idx == 0) {
+      for (int l = 1; l < KS_WHEEL_LEVELS; l++) {
+        int li = (int)((w->now >> (KS_WHEEL_BITS * l)) & KS_WHEEL_MASK);
+        if (cascade(w, l, li) != 0) break;
+      }
+    }
+
+    // Isola a lista antes dos callbacks: eles podem rearmar na mesma posição
+    ks_timer *h = &w->slot[0][idx];
+    ks_timer run; list_init(&run);
+    if (h->next != h) {
+      run.next = h->next; run.prev = h->prev;
+      run.next->prev = &run; run.prev->next = &run;
+      list_init(h);
+    }
+    w->now++;
+
+    while (run.next != &run) {
+      ks_timer *t = run.next;
+      list_unlink(t);
+      w->armed--;
+      w->fired++;
+      fired++;
+      if (t->fn) t->fn(t->arg, t);
+    }
+  }
+  return fired;
+}
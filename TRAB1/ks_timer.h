@@ -0,0 +1,90 @@
+/**
+ * @file    ks_timer.h
+ * @brief   Roda de temporizadores hierárquica da libkernelsim.
+ * @details Quatro níveis de 64 posições (6 bits cada) cobrem 2^24 ticks; prazos maiores
+ *          ficam no último nível e são recolocados a cada volta. Armar e cancelar são
+ *          O(1) (listas duplamente encadeadas intrusivas); expirar custa O(1) amortizado
+ *          por tick mais o custo dos callbacks disparados, independente de quantos
+ *          temporizadores estão armados.
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#ifndef KS_TIMER_H
+#define KS_TIMER_H
+
+#include <stdint.h>
+
+#define KS_WHEEL_BITS   6
+#define KS_WHEEL_SIZE   (1 << KS_WHEEL_BITS)
+#define KS_WHEEL_MASK   (KS_WHEEL_SIZE - 1)
+#define KS_WHEEL_LEVELS 4
+
+struct ks_timer;
+
+/**
+ * @brief  Callback disparado quando o temporizador expira (pode rearmá-lo).
+ */
+typedef void (*ks_timer_fn)(void *arg, struct ks_timer *t);
+
+/**
+ * @struct ks_timer
+ * @brief  Temporizador intrusivo; a memória pertence a quem o arma.
+ */
+typedef struct ks_timer {
+  struct ks_timer *next;  /**< Próximo na posição da roda */
+  struct ks_timer *prev;  /**< Anterior (NULL = desarmado) */
+  uint64_t expires;       /**< Tick absoluto de expiração */
+  ks_timer_fn fn;         /**< Callback */
+  void *arg;              /**< Argumento do callback */
+} ks_timer;
+
+/**
+ * @struct ks_wheel
+ * @brief  Roda hierárquica. Cada posição é uma lista circular com sentinela.
+ */
+typedef struct ks_wheel {
+  uint64_t now;                                       /**< Próximo tick a processar */
+  ks_timer slot[KS_WHEEL_LEVELS][KS_WHEEL_SIZE];      /**< Sentinelas das posições */
+  long armed;                                         /**< Temporizadores armados */
+  long fired;                                         /**< Total de expirações */
+  long cascaded;                                      /**< Recolocações entre níveis */
+} ks_wheel;
+
+/**
+ * @brief  Inicializa a roda com o relógio em `now`.
+ */
+void ks_wheel_init(ks_wheel *w, uint64_t now);
+
+/**
+ * @brief  Prepara um temporizador desarmado.
+ */
+void ks_timer_init(ks_timer *t, ks_timer_fn fn, void *arg);
+
+/**
+ * @brief  Arma (ou rearma) o temporizador para o tick absoluto `expires`. O(1).
+ * @details Prazos já vencidos disparam no próximo tick processado.
+ */
+void ks_timer_arm(ks_wheel *w, ks_timer *t, uint64_t expires);
+
+/**
+ * @brief  Cancela o temporizador, se armado. O(1).
+ * @return 1 se estava armado, 0 caso contrário.
+ */
+int  ks_timer_cancel(ks_wheel *w, ks_timer *t);
+
+/**
+ * @brief  Indica se o temporizador está armado.
+ */
+static inline int ks_timer_pending(const ks_timer *t) { return t->prev != 0; }
+
+/**
+ * @brief  Processa todos os ticks até `now` (inclusive), disparando os vencidos.
+ * @return Número de temporizadores disparados.
+ */
+int  ks_wheel_advance(ks_wheel *w, uint64_t now);
+
+#endif /* KS_TIMER_H */
@@ -0,0 +1,1201 @@
+/**
+ * @file    test_ks.c
+ * @brief   Testes de invariantes da libkernelsim, executados no próprio processo.
+ * @details Cada módulo tem uma função de teste que monta um cenário pequeno e
+ *          determinístico e confere as propriedades que o resto do simulador assume.
+ *          Uma verificação que falha imprime a linha e a condição; o programa sai com
+ *          código 1 se alguma falhou e 0 se todas passaram.
+ *          - núcleo: rodízio RR, bloqueio/desbloqueio por I/O com prioridade, ordem
+ *            estado -> callback, fim/recriação de tarefas e CPU livre ociosa até o fim
+ *            do quantum (a menos que idle_dispatch esteja ligado);
+ *          - temporizadores: prazos espalhados pelos 4 níveis disparam uma vez, no tick
+ *            exato e em ordem; cancelados não disparam; rearme no callback; sono e
+ *            prazo de I/O do núcleo;
+ *          - sincronização: mutex entregue na ordem de chegada à fila (handoff), erros
+ *            de uso, semáforo sem perda de post e condição que devolve o mutex;
+ *          - quantum automático: percentil só das rajadas voluntárias (qmax quando só há
+ *            censuradas), teto das CPU-bound enquanto há interativas e, na carga mista,
+ *            espera menor que a do quantum fixo=qmax com menos despachos que o fixo=1;
+ *          - tempo real: admissão pela soma das densidades, nunca uma pronta de prazo
+ *            mais cedo fora da CPU, nenhuma perda com utilização admitida e atraso
+ *            contado para o job que estourou o WCET;
+ *          - cluster: dois nós com sockets em /tmp; ACK leva a COMMIT (a tarefa sai da
+ *            origem e entra no destino), NACK sem vaga, prazo esgotado leva a ABORT e
+ *            libera a reserva, ACK tardio respondido com ABORT, uma migração por vez;
+ *          - coalescência de IRQ1: lote tratado quando a janela vence ou quando enche,
+ *            contas de atraso por motivo, fila cheia tratada na hora e, no desbloqueio,
+ *            no máximo uma preempção por lote, tempo mínimo da corrente respeitado e
+ *            limite de impulsos seguidos;
+ *          - canais: só o dono envia ou devolve um buffer (-1 para os demais, e para o
+ *            remetente depois do envio), entrega em ordem, contrapressão com buffer
+ *            passado direto ao remetente em espera e limpeza no fim da tarefa, mesmo
+ *            no meio da fila de reserva;
+ *          - gangue: nunca mais threads que CPUs, rodízio que divide as CPUs por igual,
+ *            thread em futex pulada, CPU-ticks fechando com o total e justiça por grupo
+ *            (metade por thread) ou por thread (igual a uma tarefa comum);
+ *          - energia: contas de ticks e de energia fecham, governadores de frequência
+ *            (ondemand só decide no fim da janela), C-state pelo ocioso previsto e
+ *            limitado pelo próximo temporizador e por cmax, latência de saída paga;
+ *          - grupos: limitação no tick em que a cota esgota (não no último do período),
+ *            liberação exata na virada, cobrança dos ancestrais, multiplicador pelos
+ *            pesos e, no escalonador, uso por período nunca acima da cota;
+ *          - cache de blocos: ordem de descarte do LRU, bloco sujo nunca descartado
+ *            (write-through sem vaga), lote com os sujos mais antigos e reescrita
+ *            durante o lote, ajuste de `p` nos acertos fantasmas do ARC, T2 que
+ *            sobrevive a uma varredura e limites das listas numa carga aleatória;
+ *          - PIC: reconhecimento em ordem de prioridade (também depois de trocá-la),
+ *            linha mascarada pendente e não entregável até ser desmascarada,
+ *            levantamento repetido fundido e latência levantamento -> reconhecimento.
+ *
+ *          Uso:
+ *          ./test_ks
+ *
+ * @note    Trabalho 1 - INF1316 (Sistemas Operacionais)
+ * @authors
+ *          Miguel Mendes (2111705)
+ *          Igor Lemos (2011287)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ks_sched.h"
+#include "ks_timer.h"
+#include "ks_sync.h"
+#include "ks_quantum.h"
+#include "ks_cluster.h"
+#include "ks_irq.h"
+#include "ks_chan.h"
+#include "ks_gang.h"
+#include "ks_power.h"
+#include "ks_cgroup.h"
+#include "ks_bcache.h"
+#include "ks_pic.h"
+
+// ============================================================================
+// Verificações
+// ============================================================================
+
+static int failures = 0;   /**< Verificações que falharam no total */
+
+/**
+ * @brief  Confere `cond`; se falhar, imprime onde e continua o teste.
+ */
+#define CHECK(cond) do { \
+    if (!(cond)) { failures++; printf("[TEST] FALHA %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+  } while (0)
+
+/**
+ * @brief  Roda um teste e imprime o resultado dele.
+ */
+static void run(const char *name, void (*fn)(void)) {
+  int before = failures;
+  fn();
+  // Alinha pelo número de caracteres, não de bytes (nomes com acento em UTF-8)
+  int len = 0;
+  for (const char *c = name; *c; c++) len += ((*c & 0xC0) != 0x80);
+  printf("[TEST] %s%*s %s\n", name, len < 28 ? 28 - len : 0, "", failures == before ? "ok" : "FALHOU");
+}
+
+// ============================================================================
+// Callbacks que registram os eventos
+// ============================================================================
+
+#define MAXEV 256
+
+/**
+ * @brief  Eventos vistos pelos callbacks, com o estado da tarefa no momento.
+ */
+static struct {
+  char kind[MAXEV];   /**< 'd' despacho, 'p' preempção, 'b' bloqueio, 'u' desbloqueio */
+  int  idx[MAXEV];
+  int  state[MAXEV];  /**< s->state[idx] quando o callback rodou */
+  int  n;
+} ev;
+
+static ks_sched *ev_sched;   /**< Escalonador observado pelos callbacks */
+
+static void ev_push(char kind, int idx) {
+  if (ev.n >= MAXEV) return;
+  ev.kind[ev.n] = kind;
+  ev.idx[ev.n] = idx;
+  ev.state[ev.n] = ev_sched ? ev_sched->state[idx] : -1;
+  ev.n++;
+}
+
+static void rec_dispatch(void *ctx, int idx)       { (void)ctx; ev_push('d', idx); }
+static void rec_preempt(void *ctx, int idx)        { (void)ctx; ev_push('p', idx); }
+static void rec_block(void *ctx, int idx, int t)   { (void)ctx; (void)t; ev_push('b', idx); }
+static void rec_unblock(void *ctx, int idx, int t) { (void)ctx; (void)t; ev_push('u', idx); }
+
+static const ks_ops rec_ops = {
+  .dispatch = rec_dispatch,
+  .preempt  = rec_preempt,
+  .block    = rec_block,
+  .unblock  = rec_unblock,
+};
+
+/**
+ * @brief  Último evento do tipo `kind`, ou -1.
+ */
+static int ev_last(char kind) {
+  for (int k = ev.n - 1; k >= 0; k--) if (ev.kind[k] == kind) return k;
+  return -1;
+}
+
+/**
+ * @brief  Cria um escalonador observado com `n` tarefas prontas e a primeira na CPU.
+ */
+static void setup(ks_sched *s, int n, int slice) {
+  memset(&ev, 0, sizeof(ev));
+  ev_sched = s;
+  if (ks_init(s, n, slice, &rec_ops, NULL) != 0) { perror("ks_init"); exit(1); }
+  for (int i = 0; i < n; i++) ks_set_state(s, i, ST_READY);
+  ks_start(s);
+}
+
+/**
+ * @brief  Avança ticks até `idx` estar na CPU (no máximo 64).
+ */
+static int run_until(ks_sched *s, int idx) {
+  for (int k = 0; k < 64 && s->current != idx; k++) ks_tick(s);
+  return s->current == idx;
+}
+
+/**
+ * @brief  Confere nready contra os estados (sem grupos limitados nem tempo real).
+ */
+static int count_ready(const ks_sched *s) {
+  int n = 0;
+  for (int i = 0; i < s->ntasks; i++) n += (s->state[i] == ST_READY);
+  return n;
+}
+
+// ============================================================================
+// Núcleo
+// ============================================================================
+
+static void test_sched(void) {
+  ks_sched s;
+  setup(&s, 4, 1);
+
+  // Rodízio por índice com quantum de 1 tick
+  CHECK(s.current == 0);
+  for (int k = 1; k <= 8; k++) {
+    ks_tick(&s);
+    CHECK(s.current == k % 4);
+    CHECK(s.nready == 3 && count_ready(&s) == 3);
+  }
+
+  // Bloqueio por I/O: a CPU fica livre e o tick seguinte despacha a próxima; o término
+  // devolve a tarefa com prioridade
+  int blocked = s.current;
+  ks_block_running(&s, 0);
+  CHECK(s.state[blocked] == ST_WAITING && s.current == -1);
+  ks_tick(&s);
+  CHECK(s.current == (blocked + 1) % 4);
+  CHECK(s.nready == 2 && count_ready(&s) == 2);
+  CHECK(ks_io_complete(&s, blocked, 0) == 1);
+  CHECK(s.current == blocked);
+  CHECK(ks_io_complete(&s, blocked, 0) == 0);   // já não está em WAITING
+
+  // Callbacks rodam depois da mudança de estado
+  int u = ev_last('u'), b = ev_last('b'), d = ev_last('d');
+  CHECK(u >= 0 && ev.state[u] == ST_READY);
+  CHECK(b >= 0 && ev.state[b] == ST_WAITING);
+  CHECK(d >= 0 && ev.idx[d] == blocked && ev.state[d] == ST_RUNNING);
+  for (int k = 0; k < ev.n; k++) if (ev.kind[k] == 'p') CHECK(ev.state[k] == ST_READY);
+
+  // Fim e recriação
+  ks_exit(&s, 3);
+  CHECK(s.state[3] == ST_DONE && ks_alive(&s) == 3);
+  CHECK(ks_spawn(&s, 3) == 0 && s.state[3] == ST_READY && s.cpu[3] == 0);
+  CHECK(ks_spawn(&s, 3) == -1);
+  CHECK(ks_alive(&s) == 4);
+  ks_destroy(&s);
+
+  // CPU livre: por padrão fica ociosa até o fim do quantum de quem saiu; com
+  // idle_dispatch o tick seguinte já despacha
+  setup(&s, 3, 4);
+  ks_block_running(&s, 0);
+  for (int k = 0; k < 3; k++) { ks_tick(&s); CHECK(s.current == -1); }
+  ks_tick(&s);
+  CHECK(s.current == 1);
+  ks_set_idle_dispatch(&s, 1);
+  ks_block_running(&s, 0);
+  ks_tick(&s);
+  CHECK(s.current == 2);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Temporizadores
+// ============================================================================
+
+#define NTIMERS 512
+
+static uint64_t tm_tick;                 /**< Tick sendo processado */
+static long     tm_fired[NTIMERS];       /**< Disparos de cada temporizador */
+static uint64_t tm_last;                 /**< Prazo do último disparo (ordem) */
+static int      tm_late;                 /**< Disparos fora do tick do prazo */
+static int      tm_order;                /**< Disparos fora de ordem */
+static ks_wheel *tm_wheel;
+
+static void tm_fire(void *arg, ks_timer *t) {
+  int k = (int)(long)arg;
+  tm_fired[k]++;
+  if (t->expires != tm_tick) tm_late++;
+  if (t->expires < tm_last) tm_order++;
+  tm_last = t->expires;
+  // O último rearma a si mesmo a cada 7 ticks, 10 vezes
+  if (k == NTIMERS - 1 && tm_fired[k] < 10) ks_timer_arm(tm_wheel, t, tm_tick + 7);
+}
+
+static void test_timer(void) {
+  static ks_wheel w;
+  static ks_timer t[NTIMERS];
+  ks_wheel_init(&w, 0);
+  tm_wheel = &w;
+  memset(tm_fired, 0, sizeof(tm_fired));
+  tm_last = 0; tm_late = tm_order = 0;
+
+  // Prazos em todos os níveis (64, 64^2, 64^3 e além), com repetições
+  uint64_t max = 0;
+  unsigned seed = 12345;
+  for (int k = 0; k < NTIMERS; k++) {
+    seed = seed * 1103515245u + 12345u;
+    uint64_t span = (k % 4 == 0) ? 64 : (k % 4 == 1) ? 4096 : (k % 4 == 2) ? 262144 : 600000;
+    uint64_t exp = 1 + (seed >> 8) % span;
+    ks_timer_init(&t[k], tm_fire, (void*)(long)k);
+    ks_timer_arm(&w, &t[k], exp);
+    if (exp > max) max = exp;
+  }
+  // Um em cada 8 é cancelado; um é rearmado para mais cedo
+  for (int k = 0; k < NTIMERS; k += 8) CHECK(ks_timer_cancel(&w, &t[k]) == 1);
+  CHECK(ks_timer_cancel(&w, &t[0]) == 0);
+  ks_timer_arm(&w, &t[1], 5);
+  CHECK(w.armed == NTIMERS - NTIMERS / 8);
+
+  for (tm_tick = 1; tm_tick <= max + 100; tm_tick++) ks_wheel_advance(&w, tm_tick);
+
+  for (int k = 0; k < NTIMERS - 1; k++) {
+    CHECK(tm_fired[k] == (k % 8 == 0 ? 0 : 1));
+    CHECK(!ks_timer_pending(&t[k]));
+  }
+  CHECK(tm_fired[NTIMERS - 1] == 10);
+  CHECK(tm_late == 0);
+  CHECK(tm_order == 0);
+  CHECK(w.armed == 0);
+
+  // Sono e prazo de I/O no núcleo: a tarefa volta exatamente no tick do prazo
+  ks_sched s;
+  setup(&s, 3, 4);
+  int a = s.current;
+  ks_sleep_running(&s, 3);
+  CHECK(s.state[a] == ST_SLEEPING);
+  ks_tick(&s); ks_tick(&s);
+  CHECK(s.state[a] == ST_SLEEPING);
+  ks_tick(&s);
+  CHECK(s.state[a] == ST_READY || s.state[a] == ST_RUNNING);
+  CHECK(s.stats.wakeups == 1);
+  while (s.current == a || s.current < 0) ks_tick(&s);
+  int b = s.current;
+  ks_block_running_timeout(&s, 0, 2);
+  ks_tick(&s);
+  CHECK(s.state[b] == ST_WAITING);
+  ks_tick(&s);
+  CHECK(s.state[b] != ST_WAITING && s.stats.io_timeouts == 1);
+  CHECK(ks_io_complete(&s, b, 0) == 0);   // término depois do prazo não desbloqueia de novo
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Sincronização
+// ============================================================================
+
+static void test_sync(void) {
+  ks_sched s;
+  ks_sync sy;
+  setup(&s, 4, 1);
+  if (ks_sync_init(&sy, &s, 4) != 0) { perror("ks_sync_init"); exit(1); }
+
+  // Mutex: a fila é servida na ordem de chegada, não na de índice
+  CHECK(run_until(&s, 0) && ks_mutex_lock(&sy, 0) == 0);
+  CHECK(ks_mutex_lock(&sy, 0) == -1);             // dono não readquire
+  int order[3] = {3, 1, 2};
+  for (int k = 0; k < 3; k++) {
+    CHECK(run_until(&s, order[k]));
+    CHECK(ks_mutex_unlock(&sy, 0) == -1);         // só o dono solta
+    CHECK(ks_mutex_lock(&sy, 0) == 1);
+    CHECK(s.state[order[k]] == ST_BLOCKED && s.current == -1);
+  }
+  CHECK(sy.obj[0].nwait == 3 && sy.obj[0].st.max_waiters == 3);
+  CHECK(run_until(&s, 0) && ks_mutex_unlock(&sy, 0) == 0);
+  CHECK(sy.obj[0].owner == 3 && s.state[3] == ST_READY);
+  CHECK(ks_mutex_lock(&sy, 0) == 1);             // o antigo dono entra no fim da fila
+  int expect[4] = {3, 1, 2, 0};
+  for (int k = 0; k < 3; k++) {
+    CHECK(sy.obj[0].owner == expect[k]);
+    CHECK(run_until(&s, expect[k]) && ks_mutex_unlock(&sy, 0) == 0);
+  }
+  CHECK(sy.obj[0].owner == 0 && sy.obj[0].nwait == 0);
+  CHECK(sy.obj[0].st.handoffs == 4 && sy.obj[0].st.contended == 4);
+  CHECK(run_until(&s, 0) && ks_mutex_unlock(&sy, 0) == 0 && sy.obj[0].owner == -1);
+
+  // Semáforo: posts acordam em ordem e só acumulam sem esperador
+  CHECK(ks_sync_create(&sy, 1, KS_SYNC_SEM, 0) == 0);
+  CHECK(ks_sync_create(&sy, 1, KS_SYNC_MUTEX, 0) == -1);
+  CHECK(ks_mutex_lock(&sy, 1) == -1);
+  CHECK(run_until(&s, 2) && ks_sem_wait(&sy, 1) == 1);
+  CHECK(run_until(&s, 1) && ks_sem_wait(&sy, 1) == 1);
+  CHECK(ks_sem_post(&sy, 1) == 0 && s.state[2] == ST_READY && s.state[1] == ST_BLOCKED);
+  CHECK(ks_sem_post(&sy, 1) == 0 && s.state[1] == ST_READY && sy.obj[1].count == 0);
+  CHECK(ks_sem_post(&sy, 1) == 0 && sy.obj[1].count == 1);
+  CHECK(run_until(&s, 3) && ks_sem_wait(&sy, 1) == 0 && sy.obj[1].count == 0);
+
+  // Condição: quem espera solta o mutex e só volta à CPU como dono dele
+  CHECK(run_until(&s, 1) && ks_mutex_lock(&sy, 2) == 0);
+  CHECK(ks_cond_wait(&sy, 3, 0) == -1);          // não é dono do mutex 0
+  CHECK(ks_cond_wait(&sy, 3, 2) == 1 && sy.obj[2].owner == -1);
+  CHECK(run_until(&s, 2) && ks_mutex_lock(&sy, 2) == 0 && ks_cond_wait(&sy, 3, 2) == 1);
+  CHECK(run_until(&s, 0) && ks_mutex_lock(&sy, 2) == 0);
+  CHECK(ks_cond_signal(&sy, 3) == 0);
+  CHECK(s.state[1] == ST_BLOCKED && sy.obj[2].nwait == 1);   // espera o mutex agora
+  CHECK(ks_cond_broadcast(&sy, 3) == 0 && sy.obj[3].nwait == 0 && sy.obj[2].nwait == 2);
+  CHECK(ks_mutex_unlock(&sy, 2) == 0 && sy.obj[2].owner == 1 && s.state[1] == ST_READY);
+
+  // Término do dono entrega o mutex ao próximo da fila
+  ks_sync_task_exit(&sy, 1);
+  ks_exit(&s, 1);
+  CHECK(sy.obj[2].owner == 2 && s.state[2] == ST_READY);
+
+  ks_sync_destroy(&sy);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Quantum automático
+// ============================================================================
+
+/**
+ * @brief  Carga mista (pares CPU-bound, ímpares com rajadas de 1-2 ticks e sono de 3).
+ * @param  disp Despachos por tick.
+ * @param  wait Espera média das interativas ao acordar (ticks).
+ */
+static void quantum_mix(int mode, int q0, double *disp, double *wait) {
+  enum { N = 8, TICKS = 20000 };
+  ks_sched s;
+  ks_qtune qt;
+  setup(&s, N, q0);
+  if (mode != KS_Q_FIXED) {
+    if (ks_qtune_init(&qt, N, mode, 1, 8, 90, q0) != 0) { perror("ks_qtune_init"); exit(1); }
+    ks_set_qtune(&s, &qt);
+  }
+  int left[N] = {0};
+  for (int i = 1; i < N; i += 2) left[i] = 1 + (i & 2) / 2;
+  for (long k = 0; k < TICKS; k++) {
+    ks_clock_tick(&s);
+    int c = s.current;
+    if (c >= 0 && (c & 1) && --left[c] <= 0) {
+      left[c] = 1 + (int)((k + c) & 1);
+      ks_sleep_running(&s, 3);
+    }
+    ks_slice_tick(&s);
+  }
+  *disp = (double)s.stats.dispatches / TICKS;
+  *wait = s.stats.wake_n ? (double)s.stats.wake_lat / s.stats.wake_n : 0.0;
+  if (mode != KS_Q_FIXED) ks_qtune_destroy(&qt);
+  ks_destroy(&s);
+}
+
+static void test_quantum(void) {
+  ks_qtune qt;
+
+  // Global: só censuradas -> qmax; rajadas voluntárias decidem e censuradas não as movem
+  CHECK(ks_qtune_init(&qt, 4, KS_Q_GLOBAL, 1, 16, 90, 4) == 0);
+  for (int k = 0; k < 10; k++) ks_qtune_sample(&qt, k % 4, 4, 1);
+  CHECK(ks_qtune_quantum(&qt, 0) == 16);
+  for (int k = 0; k < 200; k++) ks_qtune_sample(&qt, k % 4, (k % 10 == 0) ? 9 : 3, 0);
+  CHECK(ks_qtune_quantum(&qt, 0) == 3);   // 90% cabem em 3
+  for (int k = 0; k < 40; k++) ks_qtune_sample(&qt, k % 4, 16, 1);
+  CHECK(ks_qtune_quantum(&qt, 0) == 3);
+  CHECK(qt.censored == 50 && qt.samples == 250);
+  ks_qtune_destroy(&qt);
+
+  // Tarefa: as CPU-bound dividem a espera-alvo só enquanto há interativas
+  CHECK(ks_qtune_init(&qt, 4, KS_Q_TASK, 1, 16, 90, 4) == 0);
+  for (int k = 0; k < 40; k++) {
+    ks_qtune_sample(&qt, 0, 2, 0);
+    ks_qtune_sample(&qt, 1, 16, 1);
+    ks_qtune_sample(&qt, 2, 16, 1);
+  }
+  CHECK(qt.n_inter == 1 && qt.n_cpu == 2);
+  CHECK(ks_qtune_quantum(&qt, 0) <= 3);
+  CHECK(qt.task_q[1] == 16 && ks_qtune_quantum(&qt, 1) == 8 && ks_qtune_quantum(&qt, 2) == 8);
+  ks_qtune_sample(&qt, 0, 16, 1);
+  CHECK(qt.n_inter == 0 && qt.n_cpu == 3 && ks_qtune_quantum(&qt, 1) == 16);
+  ks_qtune_destroy(&qt);
+
+  // Carga mista no escalonador
+  double d1, w1, d8, w8, dg, wg, dt, wt;
+  quantum_mix(KS_Q_FIXED, 1, &d1, &w1);
+  quantum_mix(KS_Q_FIXED, 8, &d8, &w8);
+  quantum_mix(KS_Q_GLOBAL, 1, &dg, &wg);
+  quantum_mix(KS_Q_TASK, 1, &dt, &wt);
+  CHECK(dg < d1 && wg < w8);
+  CHECK(dt < d1 && wt < w8);
+}
+
+// ============================================================================
+// Tempo real
+// ============================================================================
+
+/**
+ * @brief  Roda `ticks` ticks; tarefas de tempo real concluem o job ao usar `use[i]` ticks.
+ * @return Ticks em que uma pronta de tempo real tinha precedência sobre a corrente.
+ */
+static int rt_run(ks_sched *s, ks_rt *rt, const long *use, long ticks, long *ran) {
+  int bad = 0;
+  for (long k = 0; k < ticks; k++) {
+    ks_clock_tick(s);
+    int c = s->current;
+    if (c >= 0 && ks_rt_is(rt, c) && ++ran[c] >= use[c]) { ran[c] = 0; ks_job_done(s, NULL); }
+    ks_slice_tick(s);
+    c = s->current;
+    int top = ks_rt_top(rt);
+    if (top >= 0 && (c < 0 || !ks_rt_is(rt, c) || ks_rt_earlier(rt, top, c))) bad++;
+  }
+  return bad;
+}
+
+static void test_rt(void) {
+  ks_sched s;
+  ks_rt rt;
+  long use[5] = {1, 2, 3, 0, 0}, ran[5] = {0};
+  memset(&ev, 0, sizeof(ev));
+  ev_sched = &s;
+  if (ks_init(&s, 5, 2, &rec_ops, NULL) != 0 || ks_rt_init(&rt, 5, 100) != 0) { perror("init"); exit(1); }
+  ks_set_rt(&s, &rt);
+
+  // Admissão: 1/4 + 2/6 + 3/6 passa de 100%; com D = T cabe
+  CHECK(ks_rt_admit(&rt, 0, 4, 1, 0) == 0);
+  CHECK(ks_rt_admit(&rt, 1, 6, 2, 0) == 0);
+  CHECK(ks_rt_admit(&rt, 2, 12, 3, 6) == 1 && rt.st.rejected == 1);
+  CHECK(ks_rt_admit(&rt, 2, 12, 4, 3) == -1);    // WCET maior que o prazo
+  CHECK(ks_rt_admit(&rt, 2, 12, 3, 0) == 0);
+  CHECK(ks_rt_admit(&rt, 0, 4, 1, 0) == -1);     // já admitida
+  CHECK(rt.nrt == 3);
+  for (int i = 0; i < 5; i++) ks_set_state(&s, i, ST_READY);
+  ks_start(&s);
+
+  // 1200 ticks = 100 hiperperíodos: EDF sem perdas e o resto da CPU para o RR
+  CHECK(rt_run(&s, &rt, use, 1200, ran) == 0);
+  CHECK(rt.st.misses == 0 && rt.st.overruns == 0);
+  CHECK(rt.t[0].jobs >= 299 && rt.t[1].jobs >= 199 && rt.t[2].jobs >= 99);
+  CHECK(s.cpu[3] + s.cpu[4] >= 1200 / 6 - 2);
+  long d = s.cpu[3] - s.cpu[4];
+  CHECK(d >= -2 && d <= 2);
+
+  // A tarefa 0 passa a precisar de 3 ticks com C = 1: estoura, espera a liberação
+  // seguinte e conclui atrasada; as outras continuam no prazo
+  long miss0 = rt.st.misses;
+  use[0] = 3;
+  CHECK(rt_run(&s, &rt, use, 120, ran) == 0);
+  CHECK(rt.t[0].overruns > 0 && rt.t[0].misses > 0 && rt.st.skipped > 0);
+  CHECK(rt.t[1].misses == 0 && rt.t[2].misses == 0);
+  CHECK(rt.st.misses > miss0 && rt.st.misses == rt.t[0].misses);
+  CHECK(rt.st.late_hist[0] == 0);
+
+  ks_rt_destroy(&rt);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Cluster
+// ============================================================================
+
+static void test_cluster(void) {
+  char prefix[48];
+  snprintf(prefix, sizeof(prefix), "/tmp/ks_test%d", (int)getpid());
+  ks_cluster a, b;
+  if (ks_cluster_open(&a, prefix, 0, 2, KS_CL_PUSH, 1) != 0 ||
+      ks_cluster_open(&b, prefix, 1, 2, KS_CL_PUSH, 1) != 0) { perror("ks_cluster_open"); exit(1); }
+  ks_task_image img;
+  memset(&img, 0, sizeof(img));
+  strcpy(img.path, "./app_cpu");
+  img.pc = 7;
+  img.cpu = 12;
+  ks_clmsg m, req;
+  const long long late = (long long)(KS_CL_TIMEOUT_MS + 1000) * 1000000LL;
+
+  // ACK -> COMMIT: a origem descarta a sua cópia e o destino cria a tarefa na vaga
+  CHECK(ks_cluster_migrate(&a, 1, 3, &img) == 0);
+  CHECK(ks_cluster_migrate(&a, 1, 4, &img) == -1);   // já há uma pendente
+  CHECK(ks_cluster_poll(&b, &req) && req.type == KS_MSG_MIGRATE && req.idx == 3);
+  CHECK(req.img.pc == 7 && req.img.cpu == 12 && strcmp(req.img.path, "./app_cpu") == 0);
+  CHECK(ks_cluster_reply(&b, &req, 2) == 0);
+  CHECK(!ks_cluster_poll(&b, &m));                   // reservado, mas não roda sem COMMIT
+  CHECK(ks_cluster_poll(&a, &m) && m.type == KS_MSG_ACK && m.idx == 3);
+  CHECK(a.st.mig_out == 1 && a.pend_idx == -1);
+  CHECK(ks_cluster_poll(&b, &m) && m.type == KS_MSG_COMMIT && m.idx == 2);
+  CHECK(b.st.mig_in == 1 && b.in_seq[0] == 0);
+
+  // NACK sem vaga: a tarefa continua na origem
+  CHECK(ks_cluster_migrate(&a, 1, 5, &img) == 0);
+  CHECK(ks_cluster_poll(&b, &req) && req.type == KS_MSG_MIGRATE);
+  CHECK(ks_cluster_reply(&b, &req, -1) == 0 && b.st.refused == 1 && b.in_seq[0] == 0);
+  CHECK(ks_cluster_poll(&a, &m) && m.type == KS_MSG_NACK && m.idx == 5);
+  CHECK(a.st.nacks == 1 && a.pend_idx == -1 && a.st.mig_out == 1);
+
+  // Prazo esgotado: a origem retoma a tarefa e manda ABORT; o ACK que chega depois é
+  // respondido com ABORT de novo, e o destino libera a reserva sem criar a tarefa
+  CHECK(ks_cluster_migrate(&a, 1, 6, &img) == 0);
+  CHECK(ks_cluster_poll(&b, &req) && req.type == KS_MSG_MIGRATE);
+  a.pend_ns -= late;
+  CHECK(ks_cluster_poll(&a, &m) && m.type == KS_MSG_NACK && m.idx == 6);
+  CHECK(a.st.timeouts == 1 && a.pend_idx == -1);
+  CHECK(ks_cluster_reply(&b, &req, 1) == 0);         // ACK tardio
+  CHECK(ks_cluster_poll(&b, &m) && m.type == KS_MSG_ABORT && m.idx == 1);
+  CHECK(b.st.aborted == 1 && b.in_seq[0] == 0 && b.st.mig_in == 1);
+  CHECK(!ks_cluster_poll(&a, &m) && a.st.late_acks == 1 && a.st.mig_out == 1);
+  CHECK(!ks_cluster_poll(&b, &m));                   // ABORT repetido: reserva já fechada
+
+  // Origem que some com a reserva aberta: o destino a libera sozinho
+  CHECK(ks_cluster_migrate(&a, 1, 7, &img) == 0);
+  CHECK(ks_cluster_poll(&b, &req) && ks_cluster_reply(&b, &req, 0) == 0);
+  b.peer_ns[0] -= (long long)(KS_CL_STALE_MS + 1000) * 1000000LL;
+  CHECK(ks_cluster_poll(&b, &m) && m.type == KS_MSG_ABORT && m.idx == 0);
+  CHECK(b.st.aborted == 2 && b.in_seq[0] == 0 && b.st.mig_in == 1);
+
+  ks_cluster_close(&a);
+  ks_cluster_close(&b);
+}
+
+// ============================================================================
+// Coalescência de IRQ1
+// ============================================================================
+
+/**
+ * @brief  Bloqueia por I/O as tarefas 0..k-1, uma de cada vez; a CPU fica com a k.
+ */
+static int block_first(ks_sched *s, int k) {
+  for (int i = 0; i < k; i++) {
+    if (!run_until(s, i)) return 0;
+    ks_block_running(s, 0);
+  }
+  return run_until(s, k);
+}
+
+static void test_irq(void) {
+  ks_irqq q;
+  int idx[8], type[8];
+
+  // Janela de 3 ticks contada do primeiro pendente, lote de 3
+  CHECK(ks_irq_init(&q, 4, 3, 3) == 0);
+  CHECK(!ks_irq_due(&q, 0));
+  CHECK(ks_irq_push(&q, 0, 1, 10) == 0);
+  CHECK(ks_irq_push(&q, 1, 0, 11) == 0);
+  CHECK(!ks_irq_due(&q, 12));
+  CHECK(ks_irq_due(&q, 13));
+  CHECK(ks_irq_drain(&q, idx, type, 8, 13) == 2);
+  CHECK(idx[0] == 0 && type[0] == 1 && idx[1] == 1 && type[1] == 0);
+  CHECK(q.st.by_window == 1 && q.st.by_batch == 0);
+  CHECK(q.st.delay_total == 5 && q.st.delay_max == 3);
+
+  // Lote cheio antes de a janela vencer
+  CHECK(ks_irq_push(&q, 2, 0, 20) == 0 && ks_irq_push(&q, 3, 0, 20) == 0);
+  CHECK(!ks_irq_due(&q, 21));
+  CHECK(ks_irq_push(&q, 0, 0, 21) == 0 && ks_irq_due(&q, 21));
+  CHECK(ks_irq_drain(&q, idx, type, 8, 21) == 3);
+  CHECK(idx[0] == 2 && idx[1] == 3 && idx[2] == 0);
+  CHECK(q.st.by_window == 1 && q.st.by_batch == 1);
+  CHECK(q.st.delay_total == 7 && q.st.delay_max == 3);
+  CHECK(q.st.flushes == 2 && q.st.max_batch == 3 && q.st.irqs == 5);
+  ks_irq_destroy(&q);
+
+  // Sem janela cada término é tratado na hora e não conta como lote por motivo
+  CHECK(ks_irq_init(&q, 2, 0, 0) == 0);
+  CHECK(ks_irq_push(&q, 1, 0, 5) == 0 && ks_irq_due(&q, 5));
+  CHECK(ks_irq_drain(&q, idx, type, 8, 5) == 1);
+  CHECK(q.st.by_window == 0 && q.st.by_batch == 0 && q.st.delay_max == 0);
+  ks_irq_destroy(&q);
+
+  // Fila cheia: o término não entra e o chamador o trata na hora, como o kernel faz
+  ks_sched s;
+  setup(&s, 3, 4);
+  CHECK(ks_irq_init(&q, 1, 5, 0) == 0);
+  CHECK(block_first(&s, 2));
+  CHECK(ks_irq_push(&q, 0, 0, s.now) == 0);
+  CHECK(ks_irq_push(&q, 1, 0, s.now) == -1);
+  CHECK(q.st.overflows == 1 && q.st.irqs == 1 && q.n == 1);
+  CHECK(ks_io_complete(&s, 1, 0) == 1 && s.current == 1);
+  CHECK(s.state[0] == ST_WAITING);
+  CHECK(ks_irq_drain(&q, idx, type, 8, s.now + 5) == 1 && idx[0] == 0);
+  CHECK(ks_io_complete_batch(&s, idx, type, 1) == 1 && s.state[0] != ST_WAITING);
+  ks_irq_destroy(&q);
+  ks_destroy(&s);
+
+  // Lote de três términos: uma preempção só, para a primeira a terminar
+  setup(&s, 5, 4);
+  CHECK(block_first(&s, 3));
+  long p = s.stats.preemptions;
+  idx[0] = 2; idx[1] = 0; idx[2] = 1;
+  type[0] = type[1] = type[2] = 0;
+  CHECK(ks_io_complete_batch(&s, idx, type, 3) == 3);
+  CHECK(s.current == 2 && s.stats.preemptions == p + 1 && s.stats.io_preempts == 1);
+  CHECK(s.state[0] == ST_READY && s.state[1] == ST_READY && s.state[3] == ST_READY);
+  ks_destroy(&s);
+
+  // Tempo mínimo de 2 ticks: o lote chega com a corrente recém-despachada, que não é
+  // preemptada antes disso; depois só a primeira do lote é adiantada
+  setup(&s, 5, 4);
+  ks_set_unblock_policy(&s, 2, 1);
+  CHECK(block_first(&s, 2));
+  p = s.stats.preemptions;
+  idx[0] = 1; idx[1] = 0;
+  CHECK(ks_io_complete_batch(&s, idx, type, 2) == 2);
+  CHECK(s.current == 2 && s.boost == 1 && s.stats.io_deferred == 1);
+  ks_tick(&s);
+  CHECK(s.current == 2 && s.stats.preemptions == p);
+  ks_tick(&s);
+  CHECK(s.current == 1 && s.stats.preemptions == p + 1 && s.stats.io_preempts == 1);
+  CHECK(s.boosts[1] == 1 && s.boost == -1);
+
+  // Limite de um impulso: a 1 volta do I/O sem tomar a CPU de ninguém
+  ks_block_running(&s, 0);
+  for (int k = 0; k < 8 && s.current < 0; k++) ks_tick(&s);
+  int x = s.current;
+  CHECK(x >= 0 && x != 1);
+  ks_tick(&s); ks_tick(&s);
+  CHECK(s.current == x);
+  p = s.stats.preemptions;
+  CHECK(ks_io_complete(&s, 1, 0) == 1);
+  CHECK(s.current == x && s.stats.preemptions == p && s.stats.io_capped == 1);
+  CHECK(s.state[1] == ST_READY && s.boost == -1);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Canais
+// ============================================================================
+
+static void test_chan(void) {
+  static ks_chan_buf seg[2 * KS_CHAN_SLOTS];
+  ks_sched s;
+  ks_chan c;
+  setup(&s, 3, 1);
+  if (ks_chan_init(&c, &s, 2, seg) != 0) { perror("ks_chan_init"); exit(1); }
+
+  // Posse: só quem reservou envia; depois do envio nem ele mexe no buffer
+  CHECK(run_until(&s, 0));
+  int a = ks_chan_alloc(&c, 0);
+  CHECK(a >= 0 && c.ch[0].owner[a] == 0);
+  CHECK(ks_chan_alloc(&c, 2) == -1);
+  CHECK(ks_chan_send(&c, 0, a, KS_CHAN_PAYLOAD + 1) == -1);
+  CHECK(run_until(&s, 1));
+  CHECK(ks_chan_send(&c, 0, a, 4) == -1 && ks_chan_free(&c, 0, a) == -1);
+  CHECK(ks_chan_send(&c, 0, KS_CHAN_SLOTS, 4) == -1);
+  CHECK(run_until(&s, 0));
+  strcpy(ks_chan_slot(seg, 0, a)->data, "m1");
+  CHECK(ks_chan_send(&c, 0, a, 3) == 0 && c.ch[0].owner[a] == KS_CHAN_QUEUED);
+  CHECK(ks_chan_send(&c, 0, a, 3) == -1 && ks_chan_free(&c, 0, a) == -1);
+  CHECK(ks_chan_send(&c, 1, a, 3) == -1);       // buffer de outro canal
+
+  // Entrega em ordem, no lugar
+  for (int k = 2; k <= 3; k++) {
+    int b = ks_chan_alloc(&c, 0);
+    snprintf(ks_chan_slot(seg, 0, b)->data, KS_CHAN_PAYLOAD, "m%d", k);
+    CHECK(ks_chan_send(&c, 0, b, 3) == 0);
+  }
+  CHECK(run_until(&s, 1));
+  for (int k = 1; k <= 3; k++) {
+    int r = ks_chan_recv(&c, 0);
+    char want[4];
+    snprintf(want, sizeof(want), "m%d", k);
+    CHECK(r >= 0 && strcmp(ks_chan_slot(seg, 0, r)->data, want) == 0);
+    CHECK(ks_chan_slot(seg, 0, r)->seq == k);
+    CHECK(run_until(&s, 2) && ks_chan_free(&c, 0, r) == -1);
+    CHECK(run_until(&s, 1) && ks_chan_free(&c, 0, r) == 0);
+    CHECK(ks_chan_free(&c, 0, r) == -1);         // devolvido duas vezes
+  }
+  CHECK(c.ch[0].nfree == KS_CHAN_SLOTS && c.ch[0].st.received == 3);
+
+  // Contrapressão: sem buffer livre o remetente espera e recebe o próximo devolvido
+  CHECK(run_until(&s, 0));
+  for (int k = 0; k < KS_CHAN_SLOTS; k++) CHECK(ks_chan_send(&c, 0, ks_chan_alloc(&c, 0), 1) == 0);
+  CHECK(ks_chan_alloc(&c, 0) == KS_CHAN_BLOCKED && s.state[0] == ST_BLOCKED);
+  CHECK(run_until(&s, 1));
+  int r = ks_chan_recv(&c, 0);
+  CHECK(ks_chan_free(&c, 0, r) == 0);
+  CHECK(s.state[0] == ST_READY && c.result[0] == r && c.ch[0].owner[r] == 0 && c.ch[0].nfree == 0);
+
+  // Receptor em espera recebe o descritor direto no envio
+  CHECK(run_until(&s, 2) && ks_chan_recv(&c, 1) == KS_CHAN_BLOCKED);
+  CHECK(run_until(&s, 1));
+  int b = ks_chan_alloc(&c, 1);
+  CHECK(ks_chan_send(&c, 1, b, 1) == 0);
+  CHECK(s.state[2] == ST_READY && c.result[2] == b && c.ch[1].owner[b] == 2 && c.ch[1].st.handoffs == 1);
+
+  // Fim de um remetente no meio da fila de reserva: os de trás continuam nela
+  ks_chan c2;
+  ks_sched s2;
+  setup(&s2, 4, 1);
+  if (ks_chan_init(&c2, &s2, 1, NULL) != 0) { perror("ks_chan_init"); exit(1); }
+  CHECK(run_until(&s2, 0));
+  int held[KS_CHAN_SLOTS];
+  for (int k = 0; k < KS_CHAN_SLOTS; k++) held[k] = ks_chan_alloc(&c2, 0);
+  for (int w = 1; w <= 3; w++) CHECK(run_until(&s2, w) && ks_chan_alloc(&c2, 0) == KS_CHAN_BLOCKED);
+  ks_chan_task_exit(&c2, 2);
+  ks_exit(&s2, 2);
+  CHECK(c2.ch[0].aq_head == 1 && c2.ch[0].aq_tail == 3 && c2.next[1] == 3);
+  CHECK(run_until(&s2, 0));
+  CHECK(ks_chan_free(&c2, 0, held[0]) == 0 && c2.result[1] == held[0]);
+  CHECK(ks_chan_free(&c2, 0, held[1]) == 0 && c2.result[3] == held[1]);
+  CHECK(s2.state[3] == ST_READY && c2.ch[0].owner[held[1]] == 3 && c2.ch[0].nfree == 0);
+  ks_chan_destroy(&c2);
+  ks_destroy(&s2);
+  ev_sched = &s;
+
+  // Fim da tarefa devolve o que ela tinha em mãos
+  CHECK(ks_chan_holds(&c, 2));
+  ks_chan_task_exit(&c, 2);
+  ks_exit(&s, 2);
+  CHECK(!ks_chan_holds(&c, 2) && c.ch[1].nfree == KS_CHAN_SLOTS);
+
+  ks_chan_destroy(&c);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Gangue
+// ============================================================================
+
+/**
+ * @brief  Tarefa 0 com 4 threads e 3 comuns em 2 CPUs.
+ * @return CPU por thread do grupo dividida pela CPU média de uma tarefa comum.
+ */
+static double gang_ratio(int fair) {
+  ks_sched s;
+  ks_gang g;
+  setup(&s, 4, 1);
+  if (ks_gang_init(&g, 4, 2, fair) != 0) { perror("ks_gang_init"); exit(1); }
+  ks_gang_set_threads(&g, 0, 4);
+  ks_set_gang(&s, &g);
+  int state[KS_GANG_MAXTHR] = {0}, run[KS_GANG_MAXTHR];
+  for (long k = 0; k < 12000; k++) {
+    if (s.current == 0) ks_gang_pick(&g, 0, s.now, state, run);
+    ks_gang_account(&g, s.current, state);
+    ks_tick(&s);
+  }
+  double single = (double)(g.grp[1].cpu_ticks + g.grp[2].cpu_ticks + g.grp[3].cpu_ticks) / 3.0;
+  double r = g.grp[0].cpu_ticks / 4.0 / single;
+  CHECK(g.st.busy + g.st.idle + g.st.parked == g.st.ticks * g.ncpu);
+  ks_gang_destroy(&g);
+  ks_destroy(&s);
+  return r;
+}
+
+static void test_gang(void) {
+  ks_gang g;
+  int state[KS_GANG_MAXTHR] = {0}, run[KS_GANG_MAXTHR];
+  CHECK(ks_gang_init(&g, 2, KS_GANG_MAXCPU + 1, KS_GANG_FAIR_GROUP) == -1);
+  CHECK(ks_gang_init(&g, 2, 2, KS_GANG_FAIR_THREAD) == 0);
+  CHECK(ks_gang_set_threads(&g, 0, KS_GANG_MAXTHR + 1) == -1);
+  CHECK(ks_gang_set_threads(&g, 0, 5) == 0);
+
+  // 5 threads em 2 CPUs: em 5 ticks cada uma roda exatamente 2
+  long got[5] = {0};
+  for (long now = 1; now <= 5; now++) {
+    CHECK(ks_gang_pick(&g, 0, now, state, run) == 2);
+    int again[KS_GANG_MAXTHR];
+    ks_gang_pick(&g, 0, now, state, again);       // mesmo tick: mesma escolha
+    for (int t = 0; t < 5; t++) { CHECK(again[t] == run[t]); got[t] += run[t]; }
+    ks_gang_account(&g, 0, state);
+  }
+  for (int t = 0; t < 5; t++) CHECK(got[t] == 2 && g.grp[0].thr_ticks[t] == 2);
+  CHECK(g.st.rotations == 5 && g.grp[0].cosched == 0);
+  CHECK(ks_gang_weight(&g, 0) == 3 && ks_gang_weight(&g, 1) == 1);
+
+  // Thread em futex não ganha CPU; a que termina depois da escolha conta como perdida
+  state[1] = KS_THR_FUTEX;
+  for (long now = 6; now <= 13; now++) {
+    ks_gang_pick(&g, 0, now, state, run);
+    CHECK(run[1] == 0);
+    ks_gang_account(&g, 0, state);
+  }
+  CHECK(g.grp[0].thr_ticks[1] == 2 && g.st.futex_skips == 8);
+  for (int t = 0; t < 5; t++) if (t != 1) CHECK(g.grp[0].thr_ticks[t] == 6);
+  ks_gang_pick(&g, 0, 14, state, run);
+  int victim = run[0] ? 0 : run[2] ? 2 : 3;
+  state[victim] = KS_THR_DONE;
+  long parked = g.st.parked;
+  ks_gang_account(&g, 0, state);
+  CHECK(g.st.parked == parked + 1 && g.grp[0].live == 4);   // a em futex segue viva
+  ks_gang_account(&g, -1, state);
+  CHECK(g.st.busy + g.st.idle + g.st.parked == g.st.ticks * g.ncpu);
+  ks_gang_destroy(&g);
+
+  // Justiça no escalonador
+  double rg = gang_ratio(KS_GANG_FAIR_GROUP), rt = gang_ratio(KS_GANG_FAIR_THREAD);
+  CHECK(rg > 0.45 && rg < 0.55);
+  CHECK(rt > 0.90 && rt < 1.10);
+}
+
+// ============================================================================
+// Energia
+// ============================================================================
+
+/**
+ * @brief  Carga leve (1 tick ocupado a cada 4) por 400 ticks com o governador `gov`.
+ */
+static double power_light(int gov) {
+  ks_power p;
+  if (ks_power_init(&p, 1, gov, 3) != 0) { perror("ks_power_init"); exit(1); }
+  for (long now = 0; now < 400; now++) {
+    int busy = (now % 4 == 0);
+    if (busy) ks_power_idle_exit(&p, now); else ks_power_idle_enter(&p, now, -1);
+    ks_power_tick(&p, busy ? 0 : -1, 0);
+  }
+  CHECK(p.st.busy_ticks == 100 && p.st.idle_ticks == 300);
+  CHECK(p.st.e_active == p.task_mj[0]);
+  double e = ks_power_energy(&p);
+  ks_power_destroy(&p);
+  return e;
+}
+
+static void test_power(void) {
+  ks_power p;
+  CHECK(ks_power_init(&p, 2, KS_GOV_SCHEDUTIL + 1, 0) == -1);
+  CHECK(ks_power_init(&p, 2, KS_GOV_ONDEMAND, KS_PW_CSTATES) == -1);
+
+  // Ondemand: o nível só muda no fim de cada janela; ocupada >= 80% vai ao máximo
+  CHECK(ks_power_init(&p, 2, KS_GOV_ONDEMAND, 3) == 0);
+  CHECK(ks_power_freq(&p) == 100);
+  double e = 0;
+  for (int w = 0; w < 4; w++) {
+    int lvl = p.level;
+    for (int k = 0; k < KS_PW_OD_WINDOW; k++) {
+      int busy = (w == 1 || w == 3) || (w == 2 && k > 0);
+      e += busy ? ks_pstates[p.level].power_mw : ks_cstates[0].power_mw;
+      int ch = ks_power_tick(&p, busy ? k % 2 : -1, 0);
+      CHECK(ch == 0 || k == KS_PW_OD_WINDOW - 1);
+      if (k < KS_PW_OD_WINDOW - 1) CHECK(p.level == lvl);
+    }
+    if (w == 0) CHECK(p.level == 0);                   // carga 0
+    if (w == 1) CHECK(p.level == KS_PW_LEVELS - 1);    // carga 100%
+    if (w == 2) CHECK(ks_power_freq(&p) == 80);        // carga 2/3
+  }
+  CHECK(p.st.transitions == 4);
+  CHECK(p.st.busy_ticks + p.st.idle_ticks == 4 * KS_PW_OD_WINDOW);
+  long lv = 0;
+  for (int l = 0; l < KS_PW_LEVELS; l++) lv += p.st.level_ticks[l];
+  CHECK(lv == p.st.busy_ticks && p.st.cstate_ticks[0] == p.st.idle_ticks);
+  CHECK(ks_power_energy(&p) == e && p.task_mj[0] + p.task_mj[1] == p.st.e_active);
+  ks_power_destroy(&p);
+
+  // Schedutil: fila cheia sobe ao máximo; CPU ociosa desce ao mínimo
+  CHECK(ks_power_init(&p, 1, KS_GOV_SCHEDUTIL, 0) == 0);
+  for (int k = 0; k < 20; k++) ks_power_tick(&p, -1, 0);
+  CHECK(p.level == 0);
+  for (int k = 0; k < 20; k++) ks_power_tick(&p, 0, 2);
+  CHECK(p.level == KS_PW_LEVELS - 1);
+  ks_power_destroy(&p);
+
+  // C-state: ocioso previsto escolhe o estado; temporizador próximo e cmax limitam
+  CHECK(ks_power_init(&p, 1, KS_GOV_PERFORMANCE, 3) == 0);
+  long now = 0;
+  CHECK(ks_power_idle_enter(&p, now, -1) == 1);        // sem histórico
+  CHECK(ks_power_idle_enter(&p, now, -1) == 1);        // já ociosa: nada muda
+  for (int k = 0; k < 4; k++) {
+    now += 10;
+    ks_power_idle_exit(&p, now);
+    ks_power_idle_enter(&p, now, -1);
+  }
+  CHECK(p.cstate == 3);
+  long mis = p.st.mispredicts;
+  CHECK(ks_power_idle_exit(&p, now + 1) == ks_cstates[3].exit_ms);
+  CHECK(p.st.mispredicts == mis + 1 && ks_power_idle_exit(&p, now + 1) == 0);
+  CHECK(ks_power_idle_enter(&p, now + 1, 1) == 1);    // temporizador em 1 tick
+  ks_power_destroy(&p);
+  CHECK(ks_power_init(&p, 1, KS_GOV_PERFORMANCE, 1) == 0);
+  p.idle_ema = 100;
+  CHECK(ks_power_idle_enter(&p, 0, -1) == 1);
+  ks_power_destroy(&p);
+
+  // Carga leve: powersave < ondemand < performance em energia
+  double ep = power_light(KS_GOV_PERFORMANCE), es = power_light(KS_GOV_POWERSAVE);
+  double eo = power_light(KS_GOV_ONDEMAND);
+  CHECK(es < eo && eo < ep);
+}
+
+// ============================================================================
+// Grupos com cota
+// ============================================================================
+
+static int cg_bad_throttle, cg_bad_refill, cg_events;
+
+/**
+ * @brief  Callback de grupo: limitação fora da virada, liberação só na virada (período 5).
+ */
+static void cg_event(void *ctx, int gid, int throttled) {
+  (void)ctx; (void)gid;
+  cg_events++;
+  if (throttled && ev_sched->now % 5 == 0) cg_bad_throttle++;
+  if (!throttled && ev_sched->now % 5 != 0) cg_bad_refill++;
+}
+
+static void test_cgroup(void) {
+  ks_cgroups c;
+  CHECK(ks_cg_init(&c, 4) == 0);
+  int a = ks_cg_add(&c, "a", 0, 300, 3, 10);
+  CHECK(a == 1);
+  CHECK(ks_cg_add(&c, "a", 0, 100, 0, 0) == -1);   // nome repetido
+  CHECK(ks_cg_add(&c, "x", 0, 100, 11, 10) == -1); // cota maior que o período
+  CHECK(ks_cg_add(&c, "x", 7, 100, 0, 0) == -1);   // pai inexistente
+  int b = ks_cg_add(&c, "b", a, 100, 0, 0);
+  int d = ks_cg_add(&c, "d", 0, 100, 0, 0);
+  ks_cg_assign(&c, 0, a);
+  ks_cg_assign(&c, 1, b);
+  ks_cg_assign(&c, 2, d);
+  ks_cg_assign(&c, 3, d);
+
+  // O filho sem cota é cobrado no pai e fica retido com ele
+  CHECK(ks_cg_charge(&c, 1, 1) == 0 && ks_cg_charge(&c, 0, 2) == 0);
+  CHECK(ks_cg_charge(&c, 1, 3) == (1u << a));
+  CHECK(ks_cg_held(&c, 0) && ks_cg_held(&c, 1) && !ks_cg_held(&c, 2));
+  CHECK(c.g[a].used == 3 && c.g[b].usage == 2 && c.g[0].usage == 3);
+  CHECK(ks_cg_refill(&c, 9) == 0 && ks_cg_held(&c, 0));
+  CHECK(ks_cg_refill(&c, 10) == (1u << a));
+  CHECK(!ks_cg_held(&c, 1) && c.g[a].used == 0 && c.g[a].throttled_ticks == 7);
+  CHECK(c.g[a].periods == 1 && c.g[a].nr_throttled == 1);
+
+  // Cota esgotada no último tick do período não limita: o período vira no mesmo tick
+  ks_cg_charge(&c, 0, 18);
+  ks_cg_charge(&c, 0, 19);
+  CHECK(ks_cg_charge(&c, 0, 20) == 0 && !c.g[a].throttled);
+  CHECK(ks_cg_refill(&c, 20) == 0 && c.g[a].used == 0 && c.g[a].periods == 2);
+
+  // Pesos: a (300, com b ativo dentro) contra d (100, duas tarefas)
+  CHECK(ks_cg_weight(&c, 2) == 1 && ks_cg_weight(&c, 3) == 1);
+  CHECK(ks_cg_weight(&c, 0) == 3 && ks_cg_weight(&c, 1) == 3);
+  ks_cg_set_live(&c, 3, 0);
+  CHECK(ks_cg_weight(&c, 2) == 1 && ks_cg_weight(&c, 0) == 2);
+  ks_cg_destroy(&c);
+
+  // No escalonador: tarefa 0 limitada a 1 tick a cada 5 (abaixo do 1/3 do RR) contra
+  // duas sem limite
+  static const ks_ops cg_ops = { .cgroup = cg_event };
+  ks_sched s;
+  ev_sched = &s;
+  cg_bad_throttle = cg_bad_refill = cg_events = 0;
+  if (ks_init(&s, 3, 1, &cg_ops, NULL) != 0 || ks_cg_init(&c, 3) != 0) { perror("init"); exit(1); }
+  int lim = ks_cg_add(&c, "lim", 0, 100, 1, 5);
+  ks_cg_assign(&c, 0, lim);
+  ks_set_cgroups(&s, &c);
+  for (int i = 0; i < 3; i++) ks_set_state(&s, i, ST_READY);
+  ks_start(&s);
+  long last = 0;
+  int over = 0, held_ran = 0;
+  for (long k = 0; k < 1000; k++) {
+    ks_tick(&s);
+    if (s.current >= 0 && ks_cg_held(&c, s.current)) held_ran++;
+    if (s.now % 5 == 0) {
+      if (c.g[lim].usage - last > 1) over++;
+      last = c.g[lim].usage;
+    }
+  }
+  CHECK(over == 0 && held_ran == 0);
+  CHECK(cg_bad_throttle == 0 && cg_bad_refill == 0 && cg_events > 0);
+  CHECK(c.g[lim].nr_throttled > 0 && c.g[lim].usage >= 1000 / 5 - 2);
+  CHECK(s.stats.cg_idle == 0);   // havia outras prontas: a CPU não ficou parada
+  ks_cg_destroy(&c);
+  ks_destroy(&s);
+}
+
+// ============================================================================
+// Cache de blocos
+// ============================================================================
+
+/**
+ * @brief  READ completo: acerto, ou falta seguida do bloco chegando do dispositivo.
+ */
+static int bc_access(ks_bcache *b, int blk) {
+  if (ks_bc_read(b, blk)) return 1;
+  ks_bc_fill(b, blk, 0);
+  return 0;
+}
+
+/**
+ * @brief  Entrada (residente ou fantasma) do bloco, ou NULL.
+ */
+static const ks_bcbuf *bc_entry(const ks_bcache *b, int blk) {
+  for (int e = 0; e < b->nbuf; e++) if (b->buf[e].list >= 0 && b->buf[e].blk == blk) return &b->buf[e];
+  return NULL;
+}
+
+/**
+ * @brief  Limites das listas do ARC e contagem de sujos.
+ */
+static int bc_sane(const ks_bcache *b) {
+  int t1 = b->l[KS_BC_T1].n, t2 = b->l[KS_BC_T2].n, b1 = b->l[KS_BC_B1].n, b2 = b->l[KS_BC_B2].n;
+  int dirty = 0, fl = 0;
+  for (int e = 0; e < b->nbuf; e++) {
+    if (b->buf[e].list < 0) continue;
+    dirty += b->buf[e].dirty && !b->buf[e].flushing;
+    fl += b->buf[e].flushing;
+  }
+  return t1 + t2 <= b->cap && t1 + b1 <= b->cap && t1 + t2 + b1 + b2 <= 2 * b->cap &&
+         b->p >= 0 && b->p <= b->cap && dirty == b->ndirty && fl == b->nflushing;
+}
+
+static void test_bcache(void) {
+  ks_bcache b;
+  CHECK(ks_bc_init(&b, KS_BC_MAXCAP + 1, KS_BC_LRU) == -1);
+
+  // LRU: o acerto renova; sai o usado há mais tempo
+  CHECK(ks_bc_init(&b, 4, KS_BC_LRU) == 0);
+  for (int k = 1; k <= 4; k++) CHECK(bc_access(&b, k) == 0);
+  CHECK(bc_access(&b, 1) == 1);
+  bc_access(&b, 5);
+  CHECK(b.st.evictions == 1 && !bc_entry(&b, 2) && bc_entry(&b, 1));
+  ks_bc_destroy(&b);
+
+  // Sujos: nunca descartados; lote pelos mais antigos; reescrita no lote volta a sujar
+  CHECK(ks_bc_init(&b, 2, KS_BC_LRU) == 0);
+  CHECK(ks_bc_write(&b, 1, 1) == 1 && ks_bc_write(&b, 2, 2) == 1);
+  CHECK(ks_bc_write(&b, 1, 3) == 1 && b.st.write_absorbed == 1 && b.ndirty == 2);
+  CHECK(ks_bc_read(&b, 3) == 0 && ks_bc_fill(&b, 3, 4) == -1);
+  CHECK(ks_bc_write(&b, 3, 4) == 0 && b.st.write_through == 1);
+  CHECK(ks_bc_flush_begin(&b, 5, 1) == 1 && bc_entry(&b, 1)->flushing && !bc_entry(&b, 2)->flushing);
+  CHECK(ks_bc_flush_begin(&b, 5, 1) == 0);          // um lote por vez
+  CHECK(ks_bc_write(&b, 1, 6) == 1);
+  CHECK(ks_bc_flush_end(&b, 8) == 1 && b.st.flush_lat == 3 && b.st.dirty_age == 7);
+  CHECK(bc_entry(&b, 1)->dirty && bc_entry(&b, 1)->dirty_since == 6 && b.ndirty == 2);
+  CHECK(ks_bc_flush_end(&b, 8) == 0);
+  CHECK(ks_bc_flush_begin(&b, 9, 8) == 2 && b.ndirty == 0 && ks_bc_flush_end(&b, 10) == 2);
+  CHECK(b.st.flushed == 3 && bc_access(&b, 3) == 0 && b.st.evictions == 1);
+  CHECK(bc_sane(&b));
+  ks_bc_destroy(&b);
+
+  // ARC: acerto em B1 aumenta p, acerto em B2 diminui
+  CHECK(ks_bc_init(&b, 4, KS_BC_ARC) == 0);
+  for (int r = 0; r < 2; r++) { bc_access(&b, 1); bc_access(&b, 2); }
+  bc_access(&b, 3);
+  bc_access(&b, 4);
+  CHECK(b.l[KS_BC_T2].n == 2 && b.l[KS_BC_T1].n == 2 && b.p == 0);
+  bc_access(&b, 5);
+  CHECK(bc_entry(&b, 3) && bc_entry(&b, 3)->list == KS_BC_B1);
+  CHECK(bc_access(&b, 3) == 0);
+  CHECK(b.st.ghost_hits == 1 && b.p == 1 && bc_entry(&b, 3)->list == KS_BC_T2);
+  bc_access(&b, 6);
+  CHECK(bc_entry(&b, 1) && bc_entry(&b, 1)->list == KS_BC_B2);
+  CHECK(bc_access(&b, 1) == 0);
+  CHECK(b.st.ghost_hits == 2 && b.p == 0 && bc_entry(&b, 1)->list == KS_BC_T2);
+  CHECK(bc_sane(&b));
+  ks_bc_destroy(&b);
+
+  // Varredura: o ARC preserva os quentes (T2); o LRU os perde
+  for (int pol = KS_BC_LRU; pol <= KS_BC_ARC; pol++) {
+    CHECK(ks_bc_init(&b, 8, pol) == 0);
+    for (int r = 0; r < 3; r++) for (int k = 1; k <= 4; k++) bc_access(&b, k);
+    for (int k = 100; k < 140; k++) bc_access(&b, k);
+    int hot = 0;
+    for (int k = 1; k <= 4; k++) hot += ks_bc_read(&b, k);
+    CHECK(hot == (pol == KS_BC_ARC ? 4 : 0));
+    ks_bc_destroy(&b);
+  }
+
+  // Carga aleatória com escritas e lotes: limites das listas sempre valem
+  CHECK(ks_bc_init(&b, 16, KS_BC_ARC) == 0);
+  unsigned seed = 7;
+  int bad = 0;
+  for (long now = 1; now <= 20000; now++) {
+    seed = seed * 1103515245u + 12345u;
+    int blk = (int)((seed >> 8) % ((seed >> 20) & 1 ? 12 : 64));
+    if ((seed >> 4) % 4 == 0) ks_bc_write(&b, blk, now); else bc_access(&b, blk);
+    if (now % 16 == 0) ks_bc_flush_begin(&b, now, 4);
+    if (now % 16 == 3) ks_bc_flush_end(&b, now);
+    bad += !bc_sane(&b);
+  }
+  CHECK(bad == 0);
+  CHECK(b.st.ghost_hits > 0 && b.st.read_hits > 0);
+  ks_bc_destroy(&b);
+}
+
+// ============================================================================
+// PIC
+// ============================================================================
+
+static void test_pic(void) {
+  ks_pic p;
+  CHECK(ks_pic_init(&p, 0) == -1 && ks_pic_init(&p, KS_PIC_LINES + 1) == -1);
+  CHECK(ks_pic_init(&p, 3) == 0);
+  CHECK(ks_pic_ack(&p, 0) == -1 && !ks_pic_deliverable(&p));
+  CHECK(ks_pic_raise(&p, 3, 0) == -1 && ks_pic_set_prio(&p, 0, -1) == -1);
+
+  // Prioridade padrão = número da linha
+  CHECK(ks_pic_raise(&p, 2, 100) == 1 && ks_pic_raise(&p, 0, 100) == 1);
+  CHECK(ks_pic_raise(&p, 1, 100) == 1);
+  CHECK(ks_pic_ack(&p, 100) == 0 && ks_pic_ack(&p, 100) == 1 && ks_pic_ack(&p, 100) == 2);
+  CHECK(ks_pic_ack(&p, 100) == -1);
+
+  // Disco acima do relógio; empate entre 0 e 2 fica com a linha menor
+  CHECK(ks_pic_set_prio(&p, KS_IRQ_DISK, 0) == 0 && ks_pic_set_prio(&p, 2, 1) == 0);
+  CHECK(ks_pic_set_prio(&p, KS_IRQ_TIMER, 1) == 0);
+  for (int l = 0; l < 3; l++) CHECK(ks_pic_raise(&p, l, 200) == 1);
+  CHECK(ks_pic_ack(&p, 200) == KS_IRQ_DISK);
+  CHECK(ks_pic_ack(&p, 200) == KS_IRQ_TIMER);
+  CHECK(ks_pic_ack(&p, 200) == 2);
+
+  // Levantamento repetido enquanto pendente funde-se e não pede nova campainha
+  CHECK(ks_pic_raise(&p, KS_IRQ_TIMER, 300) == 1);
+  CHECK(ks_pic_raise(&p, KS_IRQ_TIMER, 350) == 0);
+  CHECK(p.line[KS_IRQ_TIMER].merged == 1 && p.line[KS_IRQ_TIMER].raised == 3);
+  // A latência conta do primeiro levantamento, não do fundido
+  CHECK(ks_pic_ack(&p, 400) == KS_IRQ_TIMER);
+  CHECK(p.line[KS_IRQ_TIMER].delivered == 3);
+  CHECK(p.line[KS_IRQ_TIMER].lat_total_ns == 100 && p.line[KS_IRQ_TIMER].lat_max_ns == 100);
+
+  // Linha mascarada: fica pendente, mas não é entregável nem reconhecida
+  CHECK(ks_pic_mask(&p, KS_IRQ_DISK, 1) == 0);
+  CHECK(ks_pic_raise(&p, KS_IRQ_DISK, 500) == 1);
+  CHECK(ks_pic_pending(&p, KS_IRQ_DISK) && !ks_pic_deliverable(&p));
+  CHECK(ks_pic_ack(&p, 600) == -1);
+  // Com outra linha pendente, a mascarada é pulada mesmo tendo prioridade maior
+  CHECK(ks_pic_raise(&p, 2, 600) == 1 && ks_pic_deliverable(&p));
+  CHECK(ks_pic_ack(&p, 650) == 2 && !ks_pic_deliverable(&p));
+  CHECK(ks_pic_raise(&p, KS_IRQ_DISK, 700) == 0 && p.line[KS_IRQ_DISK].merged == 1);
+  CHECK(ks_pic_mask(&p, KS_IRQ_DISK, 0) == 0 && ks_pic_deliverable(&p));
+  CHECK(ks_pic_ack(&p, 900) == KS_IRQ_DISK && !ks_pic_pending(&p, KS_IRQ_DISK));
+  CHECK(p.line[KS_IRQ_DISK].delivered == 3 && p.line[KS_IRQ_DISK].lat_max_ns == 400);
+  CHECK(p.line[KS_IRQ_DISK].lat_total_ns == 400);
+
+  // Reconhecimento com relógio atrás do levantamento não gera latência negativa
+  CHECK(ks_pic_raise(&p, 2, 1000) == 1 && ks_pic_ack(&p, 990) == 2);
+  CHECK(p.line[2].lat_total_ns == 50 && p.line[2].lat_max_ns == 50);
+  CHECK(p.irr == 0);
+}
+
+// ============================================================================
+// Principal
+// ============================================================================
+
+int main(void) {
+  run("núcleo (RR, I/O, estados)", test_sched);
+  run("temporizadores", test_timer);
+  run("sincronização", test_sync);
+  run("quantum automático", test_quantum);
+  run("tempo real (EDF)", test_rt);
+  run("cluster (migração)", test_cluster);
+  run("coalescência de IRQ1", test_irq);
+  run("canais", test_chan);
+  run("gangue", test_gang);
+  run("energia", test_power);
+  run("grupos com cota", test_cgroup);
+  run("cache de blocos", test_bcache);
+  run("PIC", test_pic);
+  printf("[TEST] %s (%d falha(s))\n", failures ? "FALHOU" : "OK", failures);
+  return failures ? 1 : 0;
+}